@@ -0,0 +1,115 @@
+#include "di/cli/parser.h"
+#include "di/container/vector/vector.h"
+#include "di/random/prelude.h"
+#include "dius/main.h"
+#include "dius/print.h"
+#include "dius/steady_clock.h"
+#include "key_bind.h"
+#include "ttx/key_event.h"
+#include "ttx/stats.h"
+
+namespace ttx::key_bind_bench {
+struct Args {
+    u32 iterations { 1'000'000 };
+    u32 extra_binds { 0 };
+    bool help { false };
+
+    constexpr static auto get_cli_parser() {
+        return di::cli_parser<Args>("ttx_key_bind_bench"_tsv, "Measure key bind dispatch latency"_sv)
+            .option<&Args::iterations>('i', "iterations"_tsv, "Number of key events dispatched per measurement"_sv)
+            .option<&Args::extra_binds>('e', "extra-binds"_tsv,
+                                        "Add this many synthetic binds, to simulate a large custom keymap"_sv)
+            .help();
+    }
+};
+
+// The dispatch used before key binds were indexed, kept as the point of comparison.
+static auto linear_lookup(di::Span<KeyBind const> binds, InputMode mode, KeyEvent const& event) -> KeyBind const* {
+    if (mode != InputMode::Insert && (event.type() == KeyEventType::Release ||
+                                      (event.key() > Key::ModifiersBegin && event.key() < Key::ModifiersEnd))) {
+        return nullptr;
+    }
+
+    auto modifiers = event.modifiers() & ~(Modifiers::LockModifiers);
+    for (auto const& bind : binds) {
+        auto key_matches = bind.key == Key::None || (event.type() != KeyEventType::Release && event.key() == bind.key &&
+                                                     modifiers == bind.modifiers);
+        if (mode == bind.mode && key_matches) {
+            return &bind;
+        }
+    }
+    return nullptr;
+}
+
+struct Dispatch {
+    InputMode mode;
+    KeyEvent event;
+};
+
+// Mostly typing in insert mode, with both press and release events (as reported by the kitty key protocol), and
+// occasional commands in normal mode.
+static auto make_events(usize count) -> di::Vector<Dispatch> {
+    auto rng = di::MinstdRand(1);
+    auto result = di::Vector<Dispatch> {};
+    for (auto _ : di::range(count)) {
+        auto key = Key(di::to_underlying(Key::A) + rng() % 26);
+        if (rng() % 16 == 0) {
+            result.push_back({ InputMode::Normal, KeyEvent::key_down(key) });
+            continue;
+        }
+        auto type = rng() % 2 == 0 ? KeyEventType::Press : KeyEventType::Release;
+        result.push_back({ InputMode::Insert, KeyEvent(type, key) });
+    }
+    return result;
+}
+
+template<typename Lookup>
+static auto measure(di::Span<Dispatch const> events, u32 iterations, Lookup&& lookup) -> u64 {
+    auto matched = 0_usize;
+    auto start = dius::SteadyClock::now();
+    for (auto i : di::range(iterations)) {
+        auto const& dispatch = events[i % events.size()];
+        matched += lookup(dispatch.mode, dispatch.event) != nullptr;
+    }
+    auto elapsed = elapsed_ns(start);
+
+    // Prevent the loop from being optimized out.
+    if (matched > iterations) {
+        dius::eprintln("unreachable"_sv);
+    }
+    return iterations ? elapsed * 100 / iterations : 0;
+}
+
+static auto main(Args& args) -> di::Result<> {
+    // Synthetic binds go before the defaults, so that a linear scan must skip over them.
+    auto binds = di::Vector<KeyBind> {};
+    for (auto i : di::range(args.extra_binds)) {
+        binds.push_back({
+            .key = Key(di::to_underlying(Key::A) + i % 26),
+            .modifiers = Modifiers::Hyper,
+            .mode = InputMode(i % 4),
+        });
+    }
+    auto default_binds = make_key_binds(InputConfig {}, false);
+    binds.append_container(default_binds | di::as_rvalue);
+    auto table = KeyBindTable(di::move(binds));
+    auto events = make_events(4096);
+
+    auto linear_ns = measure(events.span(), args.iterations, [&](InputMode mode, KeyEvent const& event) {
+        return linear_lookup(table.binds(), mode, event);
+    });
+    auto table_ns = measure(events.span(), args.iterations, [&](InputMode mode, KeyEvent const& event) {
+        return table.lookup(mode, event);
+    });
+
+    auto format = [](u64 value) {
+        return di::format("{}.{}{}"_sv, value / 100, (value / 10) % 10, value % 10);
+    };
+    dius::println("{} binds, {} dispatches"_sv, table.binds().size(), args.iterations);
+    dius::println("linear scan: {} ns/event"_sv, format(linear_ns));
+    dius::println("table:       {} ns/event"_sv, format(table_ns));
+    return {};
+}
+}
+
+DIUS_MAIN(ttx::key_bind_bench::Args, ttx::key_bind_bench)
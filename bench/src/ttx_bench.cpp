@@ -0,0 +1,373 @@
+#include "di/cli/parser.h"
+#include "di/container/string/string_view.h"
+#include "di/container/vector/vector.h"
+#include "di/io/vector_writer.h"
+#include "di/io/writer_print.h"
+#include "di/random/prelude.h"
+#include "di/vocab/error/string_error.h"
+#include "dius/main.h"
+#include "dius/print.h"
+#include "dius/steady_clock.h"
+#include "dius/sync_file.h"
+#include "ttx/escape_sequence_parser.h"
+#include "ttx/pane.h"
+#include "ttx/renderer.h"
+#include "ttx/replay.h"
+#include "ttx/size.h"
+#include "ttx/stats.h"
+#include "ttx/utf8_stream_decoder.h"
+
+namespace ttx::bench {
+struct Args {
+    di::Vector<di::PathView> captures;
+    di::Optional<di::PathView> baseline;
+    di::Optional<di::PathView> save_baseline;
+    u32 threshold { 10 };
+    u32 iterations { 3 };
+    u32 rows { 50 };
+    u32 cols { 200 };
+    u32 bytes_per_frame { 65536 };
+    bool help { false };
+
+    constexpr static auto get_cli_parser() {
+        return di::cli_parser<Args>("ttx_bench"_tsv, "Measure ttx throughput on recorded and synthetic workloads"_sv)
+            .option<&Args::baseline>('b', "baseline"_tsv, "Fail if results regress compared to this baseline file"_sv)
+            .option<&Args::save_baseline>('s', "save-baseline"_tsv, "Write the results to a baseline file"_sv)
+            .option<&Args::threshold>('t', "threshold"_tsv, "Allowed regression, in percent (default 10)"_sv)
+            .option<&Args::iterations>('i', "iterations"_tsv, "Number of runs per workload, the fastest is kept"_sv)
+            .option<&Args::rows>('r', "rows"_tsv, "Terminal height used when replaying"_sv)
+            .option<&Args::cols>('c', "cols"_tsv, "Terminal width used when replaying"_sv)
+            .option<&Args::bytes_per_frame>('f', "bytes-per-frame"_tsv,
+                                            "Bytes of output processed between each rendered frame"_sv)
+            .argument<&Args::captures>("CAPTURE_FILES"_sv,
+                                       "Additional workloads, recorded with --capture-command-output-path"_sv)
+            .help();
+    }
+};
+
+struct Workload {
+    di::String name;
+    di::Vector<byte> data;
+};
+
+struct Result {
+    di::String name;
+    usize bytes { 0 };
+    u64 parse_ns { 0 };
+    usize frames { 0 };
+    u64 frame_ns { 0 };
+
+    /// @brief Parse cost in hundredths of a nanosecond per byte.
+    auto parse_ns_per_byte_x100() const -> u64 { return bytes ? parse_ns * 100 / bytes : 0; }
+
+    /// @brief Average cost of Pane::draw() plus Renderer::finish(), in nanoseconds.
+    auto frame_average_ns() const -> u64 { return frames ? frame_ns / frames : 0; }
+
+    auto mb_per_second() const -> u64 { return parse_ns ? bytes * 1000 / parse_ns : 0; }
+};
+
+// ---- Synthetic workloads ----
+//
+// These approximate the output of common programs. They are generated deterministically so that results
+// are comparable between runs. Real recordings can be passed on the command line as well.
+
+static auto finish_workload(di::StringView name, di::VectorWriter<>&& writer) -> Workload {
+    return { name.to_owned(), di::move(writer).vector() };
+}
+
+static auto compiler_spew() -> Workload {
+    auto writer = di::VectorWriter<> {};
+    auto rng = di::MinstdRand(1);
+    for (auto i : di::range(40000)) {
+        auto line = di::UniformIntDistribution(1, 2000)(rng);
+        auto col = di::UniformIntDistribution(1, 120)(rng);
+        di::writer_print<di::String::Encoding>(
+            writer,
+            "\033[1msrc/module_{}.cpp:{}:{}: \033[35mwarning: \033[0m\033[1munused variable 'value_{}' "
+            "[\033[35m-Wunused-variable\033[0m\033[1m]\033[0m\r\n"
+            "  {} |     auto value_{} = compute(input, {});\r\n"
+            "      |          \033[32m^\033[0m\r\n"_sv,
+            i % 97, line, col, i, line, i, col);
+    }
+    return finish_workload("compiler-spew"_sv, di::move(writer));
+}
+
+static auto vim_scrolling() -> Workload {
+    auto writer = di::VectorWriter<> {};
+    auto rng = di::MinstdRand(2);
+
+    // Enter the alternate screen and set a scroll region above the status line.
+    di::writer_print<di::String::Encoding>(writer, "\033[?1049h\033[1;49r"_sv);
+    for (auto i : di::range(60000)) {
+        // Scroll the buffer by one line, and then draw the newly exposed line and update the status line.
+        auto indent = di::UniformIntDistribution(0, 12)(rng);
+        di::writer_print<di::String::Encoding>(writer, "\033[49;1H\n\033[33m{: >4} \033[m"_sv, i);
+        for (auto _ : di::range(indent)) {
+            di::writer_print<di::String::Encoding>(writer, " "_sv);
+        }
+        di::writer_print<di::String::Encoding>(
+            writer, "\033[38;5;75mif\033[m (\033[38;5;180mline_{}\033[m) {{ \033[38;5;114mreturn\033[m {}; }}\033[K"_sv,
+            i, i * 7);
+        di::writer_print<di::String::Encoding>(writer, "\033[50;1H\033[7m main.cpp  {},1  {}% \033[m\033[K"_sv, i,
+                                               i % 100);
+    }
+    di::writer_print<di::String::Encoding>(writer, "\033[r\033[?1049l"_sv);
+    return finish_workload("vim-scrolling"_sv, di::move(writer));
+}
+
+static auto htop() -> Workload {
+    auto writer = di::VectorWriter<> {};
+    auto rng = di::MinstdRand(3);
+
+    di::writer_print<di::String::Encoding>(writer, "\033[?1049h\033[?25l"_sv);
+    for (auto _ : di::range(600)) {
+        // CPU meters.
+        for (auto cpu : di::range(8)) {
+            auto usage = di::UniformIntDistribution(0, 40)(rng);
+            di::writer_print<di::String::Encoding>(writer, "\033[{};1H\033[36m{: >3}\033[m\033[1m[\033[32m"_sv, cpu + 1,
+                                                   cpu);
+            for (auto i : di::range(40)) {
+                di::writer_print<di::String::Encoding>(writer, "{}"_sv, i < usage ? "|"_sv : " "_sv);
+            }
+            di::writer_print<di::String::Encoding>(writer, "\033[m\033[1m]\033[m"_sv);
+        }
+
+        // Process table.
+        di::writer_print<di::String::Encoding>(writer, "\033[10;1H\033[30;42m    PID USER      CPU% MEM% Command"
+                                                       "\033[K\033[m"_sv);
+        for (auto row : di::range(11, 50)) {
+            auto pid = di::UniformIntDistribution(1, 99999)(rng);
+            auto cpu = di::UniformIntDistribution(0, 100)(rng);
+            di::writer_print<di::String::Encoding>(writer,
+                                                   "\033[{};1H{: >7} \033[33muser\033[m      {: >3}  {: >3} "
+                                                   "\033[1m/usr/bin/process-{}\033[m --flag\033[K"_sv,
+                                                   row, pid, cpu, pid % 100, pid);
+        }
+    }
+    di::writer_print<di::String::Encoding>(writer, "\033[?25h\033[?1049l"_sv);
+    return finish_workload("htop"_sv, di::move(writer));
+}
+
+static auto unicode_text() -> Workload {
+    constexpr auto samples = di::Array {
+        u8"漢字かなカナ한국어 "_sv, u8"😀🎉👍🏽🚀 "_sv,          u8"👨‍👩‍👧‍👦 "_sv,
+        u8"Ελληνικά "_sv,           u8"résumé naïve "_sv, u8"中文输入法 "_sv,
+    };
+
+    auto writer = di::VectorWriter<> {};
+    auto rng = di::MinstdRand(4);
+    for (auto _ : di::range(60000)) {
+        for (auto _ : di::range(6)) {
+            auto index = di::UniformIntDistribution(0_usize, samples.size() - 1)(rng);
+            di::writer_print<di::String::Encoding>(writer, "{}"_sv, samples[index]);
+        }
+        di::writer_print<di::String::Encoding>(writer, "\r\n"_sv);
+    }
+    return finish_workload("unicode-text"_sv, di::move(writer));
+}
+
+static auto sgr_ls() -> Workload {
+    constexpr auto styles = di::Array {
+        "01;34"_sv, "01;32"_sv, "01;36"_sv, "00"_sv, "40;33;01"_sv, "01;35"_sv, "38;5;208"_sv, "01;31"_sv,
+    };
+
+    auto writer = di::VectorWriter<> {};
+    auto rng = di::MinstdRand(5);
+    for (auto i : di::range(50000)) {
+        for (auto column : di::range(6)) {
+            auto style = di::UniformIntDistribution(0_usize, styles.size() - 1)(rng);
+            di::writer_print<di::String::Encoding>(writer, "\033[0m\033[{}mentry_{}_{}\033[0m  "_sv, styles[style], i,
+                                                   column);
+        }
+        di::writer_print<di::String::Encoding>(writer, "\r\n"_sv);
+    }
+    return finish_workload("sgr-ls"_sv, di::move(writer));
+}
+
+static auto large_cat() -> Workload {
+    auto writer = di::VectorWriter<> {};
+    auto rng = di::MinstdRand(6);
+    for (auto i : di::range(200000)) {
+        auto length = di::UniformIntDistribution(0, 120)(rng);
+        di::writer_print<di::String::Encoding>(writer, "{: >6}: "_sv, i);
+        for (auto j : di::range(length)) {
+            di::writer_print<di::String::Encoding>(writer, "{}"_sv, c32('a' + (i + j) % 26));
+        }
+        di::writer_print<di::String::Encoding>(writer, "\n"_sv);
+    }
+    return finish_workload("large-cat"_sv, di::move(writer));
+}
+
+static auto load_capture(di::PathView path) -> di::Result<Workload> {
+    auto reader = TRY(ReplayReader::open(path));
+
+    auto data = di::Vector<byte> {};
+    auto buffer = di::Vector<byte> {};
+    buffer.resize(16384);
+    while (auto chunk = reader.read(buffer.span())) {
+        data.append_container(buffer | di::take(chunk->size));
+    }
+
+    return Workload { di::format("capture:{}"_sv, path), di::move(data) };
+}
+
+// ---- Measurement ----
+
+/// @brief Measure decode -> parse -> Terminal::on_parser_results(), the same path the reader thread uses.
+static auto measure_parse(Workload const& workload, Size const& size) -> u64 {
+    auto pane = Pane::create_mock();
+    auto renderer = Renderer {};
+
+    // Draw once so that the pane is resized to the requested size.
+    pane->resize(size);
+    renderer.start(size, {});
+    (void) pane->draw(renderer);
+
+    auto parser = EscapeSequenceParser {};
+    auto utf8_decoder = Utf8StreamDecoder {};
+    auto start = dius::SteadyClock::now();
+    for (auto offset = 0_usize; offset < workload.data.size(); offset += 16384) {
+        auto chunk = workload.data.subspan(offset, di::min(16384_usize, workload.data.size() - offset)).value();
+        pane->process_output(chunk, parser, utf8_decoder);
+    }
+    return elapsed_ns(start);
+}
+
+/// @brief Measure the per-frame cost of Pane::draw() plus Renderer::finish().
+///
+/// Output is processed in chunks of \p bytes_per_frame, and a frame is rendered after each chunk.
+/// Only the rendering is timed.
+static auto measure_frames(Workload const& workload, Size const& size, usize bytes_per_frame)
+    -> di::Result<di::Tuple<usize, u64>> {
+    auto output = TRY(dius::open_sync("/dev/null"_pv, dius::OpenMode::WriteClobber));
+    auto pane = Pane::create_mock();
+    auto renderer = Renderer {};
+    pane->resize(size);
+
+    auto parser = EscapeSequenceParser {};
+    auto utf8_decoder = Utf8StreamDecoder {};
+    auto frames = 0_usize;
+    auto total_ns = 0_u64;
+    for (auto offset = 0_usize; offset < workload.data.size(); offset += bytes_per_frame) {
+        auto chunk = workload.data.subspan(offset, di::min(bytes_per_frame, workload.data.size() - offset)).value();
+        pane->process_output(chunk, parser, utf8_decoder);
+        pane->mark_dirty();
+
+        auto start = dius::SteadyClock::now();
+        renderer.start(size, {});
+        auto [cursor, bg] = pane->draw(renderer);
+        TRY(renderer.finish(output, cursor, {}, bg));
+        total_ns += elapsed_ns(start);
+        frames++;
+    }
+    return di::Tuple { frames, total_ns };
+}
+
+static auto run_workload(Args const& args, Workload const& workload) -> di::Result<Result> {
+    auto size = Size(args.rows, args.cols);
+    auto result = Result { workload.name.clone(), workload.data.size(), di::NumericLimits<u64>::max, 0, 0 };
+    for (auto _ : di::range(di::max(args.iterations, 1_u32))) {
+        result.parse_ns = di::min(result.parse_ns, measure_parse(workload, size));
+
+        auto [frames, frame_ns] = TRY(measure_frames(workload, size, di::max(args.bytes_per_frame, 1_u32)));
+        if (result.frames == 0 || frame_ns < result.frame_ns) {
+            result.frames = frames;
+            result.frame_ns = frame_ns;
+        }
+    }
+    return result;
+}
+
+static auto format_hundredths(u64 value) -> di::String {
+    return di::format("{}.{}{}"_sv, value / 100, (value / 10) % 10, value % 10);
+}
+
+// ---- Baselines ----
+//
+// The baseline file has one line per workload: "<name> <parse ns/byte x100> <frame ns>".
+
+static auto save_baseline(di::PathView path, di::Span<Result const> results) -> di::Result<> {
+    auto file = TRY(dius::open_sync(path, dius::OpenMode::WriteClobber));
+    for (auto const& result : results) {
+        di::writer_print<di::String::Encoding>(file, "{} {} {}\n"_sv, result.name, result.parse_ns_per_byte_x100(),
+                                               result.frame_average_ns());
+    }
+    return {};
+}
+
+static auto check_baseline(di::PathView path, di::Span<Result const> results, u32 threshold) -> di::Result<> {
+    auto contents = TRY(dius::read_to_string(path));
+
+    auto exceeds = [&](u64 current, u64 baseline) {
+        return current * 100 > baseline * (100 + threshold);
+    };
+
+    auto regressions = 0_usize;
+    for (auto line : contents | di::split(U'\n')) {
+        auto fields = line | di::split(U' ') | di::to<di::Vector>();
+        if (fields.size() != 3) {
+            continue;
+        }
+
+        auto name = fields[0] | di::to<di::String>();
+        auto result = di::find(results, name, &Result::name);
+        if (result == results.end()) {
+            continue;
+        }
+
+        auto parse = TRY(di::parse<u64>(fields[1]));
+        auto frame = TRY(di::parse<u64>(fields[2]));
+        if (exceeds(result->parse_ns_per_byte_x100(), parse)) {
+            dius::eprintln("REGRESSION: {}: parse {} ns/byte (baseline {} ns/byte)"_sv, name,
+                           format_hundredths(result->parse_ns_per_byte_x100()), format_hundredths(parse));
+            regressions++;
+        }
+        if (exceeds(result->frame_average_ns(), frame)) {
+            dius::eprintln("REGRESSION: {}: frame {} ns (baseline {} ns)"_sv, name, result->frame_average_ns(), frame);
+            regressions++;
+        }
+    }
+
+    if (regressions > 0) {
+        return di::Unexpected(
+            di::format_error("{} measurement(s) regressed by more than {}% compared to the baseline"_sv, regressions,
+                             threshold));
+    }
+    return {};
+}
+
+static auto main(Args& args) -> di::Result<> {
+    auto workloads = di::Vector<Workload> {};
+    workloads.push_back(compiler_spew());
+    workloads.push_back(vim_scrolling());
+    workloads.push_back(htop());
+    workloads.push_back(unicode_text());
+    workloads.push_back(sgr_ls());
+    workloads.push_back(large_cat());
+    for (auto path : args.captures) {
+        workloads.push_back(TRY(load_capture(path).transform_error([&](di::Error error) {
+            return di::format_error("Failed to read capture file '{}': {}"_sv, path, error);
+        })));
+    }
+
+    auto results = di::Vector<Result> {};
+    constexpr auto row_format = "{: <24} {: >10} {: >10} {: >12} {: >8} {: >12}"_sv;
+    dius::println(row_format, "workload"_sv, "bytes"_sv, "MB/s"_sv, "ns/byte"_sv, "frames"_sv, "ns/frame"_sv);
+    for (auto const& workload : workloads) {
+        auto result = TRY(run_workload(args, workload));
+        dius::println(row_format, result.name, result.bytes, result.mb_per_second(),
+                      format_hundredths(result.parse_ns_per_byte_x100()), result.frames, result.frame_average_ns());
+        results.push_back(di::move(result));
+    }
+
+    if (args.save_baseline) {
+        TRY(save_baseline(*args.save_baseline, results.span()));
+    }
+    if (args.baseline) {
+        TRY(check_baseline(*args.baseline, results.span(), args.threshold));
+    }
+    return {};
+}
+}
+
+DIUS_MAIN(ttx::bench::Args, ttx::bench)
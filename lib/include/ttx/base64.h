@@ -0,0 +1,27 @@
+#pragma once
+
+#include "di/container/vector/vector.h"
+#include "di/types/prelude.h"
+#include "di/vocab/optional/prelude.h"
+#include "di/vocab/span/prelude.h"
+
+namespace ttx {
+/// @brief The number of bytes needed to base64 encode \p size bytes, including padding.
+constexpr auto base64_encoded_size(usize size) -> usize {
+    return (size + 2) / 3 * 4;
+}
+
+/// @brief Append the padded base64 encoding of \p input to \p output.
+///
+/// The output is sized up front and the input is encoded 3 bytes at a time using a table which maps
+/// 12 bits of input to 2 characters of output, so large payloads (like OSC 52 selections) are encoded
+/// without any per character overhead. Because the output buffer is provided by the caller, the encoding
+/// can be done in chunks (as long as each chunk other than the last is a multiple of 3 bytes).
+void base64_encode(di::Span<byte const> input, di::Vector<byte>& output);
+
+/// @brief Decode base64 encoded \p input.
+///
+/// Padding is optional, but if present must be at the end of the input. Any character outside of the
+/// base64 alphabet makes the input invalid, in which case nothing is returned.
+auto base64_decode(di::Span<byte const> input) -> di::Optional<di::Vector<byte>>;
+}
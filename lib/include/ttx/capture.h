@@ -0,0 +1,90 @@
+#pragma once
+
+#include "di/container/path/path.h"
+#include "di/container/string/string_view.h"
+#include "di/container/vector/vector.h"
+#include "di/vocab/error/result.h"
+#include "di/vocab/span/prelude.h"
+#include "dius/steady_clock.h"
+#include "dius/sync_file.h"
+#include "ttx/size.h"
+
+namespace ttx {
+/// @brief The capture container format
+///
+/// A capture starts with an 8 byte magic string, followed by a sequence of records. Each record
+/// has a 16 byte header: the record type (u32), the payload size (u32), and the offset in
+/// microseconds since the capture started (u64). All integers are little endian.
+///
+/// Output records hold the raw bytes read from the application. Resize records hold the new
+/// terminal size. Keyframe records hold the terminal state without its scroll back, as produced by
+/// Terminal::state_as_escape_sequences(false). Keyframes are written periodically, so that a reader
+/// can start playback at a keyframe instead of processing the capture from the beginning.
+///
+/// When the capture is finished, an index record listing the position of every keyframe is
+/// written, followed by a 16 byte footer: the file position of the index record (u64) and a
+/// second magic string. Captures which were not finished cleanly have no index, but can still
+/// be read sequentially.
+namespace capture {
+    constexpr auto header_magic = "TTXCAP01"_sv;
+    constexpr auto footer_magic = "TTXIDX01"_sv;
+    constexpr auto record_header_size = 16_usize;
+    constexpr auto footer_size = 16_usize;
+
+    enum class RecordType : u32 {
+        Output = 1,
+        Resize = 2,
+        Keyframe = 3,
+        Index = 4,
+    };
+
+    struct RecordHeader {
+        RecordType type { RecordType::Output };
+        u32 size { 0 };
+        u64 offset_us { 0 };
+    };
+
+    struct Keyframe {
+        u64 offset_us { 0 };
+        u64 file_position { 0 };
+
+        auto operator==(Keyframe const&) const -> bool = default;
+    };
+
+    void append_u32(di::Vector<byte>& output, u32 value);
+    void append_u64(di::Vector<byte>& output, u64 value);
+    auto read_u32(di::Span<byte const> input) -> u32;
+    auto read_u64(di::Span<byte const> input) -> u64;
+}
+
+/// @brief Writes a pane's output in the capture container format
+class CaptureWriter {
+public:
+    /// @brief The amount of output written between keyframes.
+    constexpr static auto keyframe_interval = 8_usize * 1024 * 1024;
+
+    static auto create(di::PathView path, Size const& size) -> di::Result<CaptureWriter>;
+
+    explicit CaptureWriter(dius::SyncFile file) : m_file(di::move(file)), m_start(dius::SteadyClock::now()) {}
+
+    auto write_output(di::Span<byte const> data) -> di::Result<>;
+    auto write_resize(Size const& size) -> di::Result<>;
+
+    /// @brief Check if enough output has been written since the last keyframe to write another.
+    auto wants_keyframe() const -> bool { return m_output_since_keyframe >= keyframe_interval; }
+    auto write_keyframe(di::StringView state) -> di::Result<>;
+
+    /// @brief Write the keyframe index and footer. No further records can be written afterwards.
+    auto finish() -> di::Result<>;
+
+private:
+    auto offset_us() const -> u64;
+    auto write_record(capture::RecordType type, di::Span<byte const> payload, u64 offset_us) -> di::Result<>;
+
+    dius::SyncFile m_file;
+    dius::SteadyClock::TimePoint m_start;
+    u64 m_position { 0 };
+    usize m_output_since_keyframe { 0 };
+    di::Vector<capture::Keyframe> m_keyframes;
+};
+}
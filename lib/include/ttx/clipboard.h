@@ -57,7 +57,8 @@ public:
         di::Vector<byte> data;
     };
 
-    explicit Clipboard(ClipboardMode mode, Feature features);
+    /// @brief Create a clipboard, which ignores writes larger than \p max_size bytes (0 means no limit)
+    explicit Clipboard(ClipboardMode mode, Feature features, usize max_size = 0);
 
     [[nodiscard]] auto set_clipboard(terminal::SelectionType type, di::Vector<byte> data,
                                      dius::SteadyClock::TimePoint reception = dius::SteadyClock::now()) -> bool;
@@ -68,8 +69,27 @@ public:
     [[nodiscard]] auto get_replies(dius::SteadyClock::TimePoint reception = dius::SteadyClock::now())
         -> di::Vector<Reply>;
 
+    /// @brief The time at which the oldest pending request times out, if there are any pending requests
+    ///
+    /// Requests only time out when the clipboard is used, so the caller should call get_replies() at this time.
+    [[nodiscard]] auto next_expiration() -> di::Optional<dius::SteadyClock::TimePoint>;
+
+    /// @brief The data currently stored for selection \p type
+    [[nodiscard]] auto data(terminal::SelectionType type) const -> di::Span<byte const> {
+        return m_state[usize(type)].data.span();
+    }
+
     [[nodiscard]] auto mode() const { return m_mode; }
     void set_mode(ClipboardMode mode) { m_mode = mode; }
+    void set_features(Feature features) { m_features = features; }
+    void set_max_size(usize max_size) { m_max_size = max_size; }
+
+    /// @brief Check if \p size bytes is too large to be stored in the clipboard
+    ///
+    /// Writes which are too large are ignored by set_clipboard(), and are not forwarded to the
+    /// outer terminal. This bounds the memory used by each selection, as well as how long writing
+    /// the selection to the outer terminal can delay frames.
+    [[nodiscard]] auto exceeds_max_size(usize size) const -> bool { return m_max_size != 0 && size > m_max_size; }
 
 private:
     void expire(dius::SteadyClock::TimePoint reception);
@@ -106,6 +126,7 @@ private:
 
     ClipboardMode m_mode { ClipboardMode::System };
     Feature m_features { Feature::None };
+    usize m_max_size { 0 };
     di::Array<SelectionState, usize(terminal::SelectionType::Max)> m_state;
     di::Vector<Reply> m_replies;
 };
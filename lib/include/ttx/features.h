@@ -1,5 +1,7 @@
 #pragma once
 
+#include "di/container/path/path.h"
+#include "di/container/vector/vector.h"
 #include "di/reflect/prelude.h"
 #include "di/util/bitwise_enum.h"
 #include "dius/sync_file.h"
@@ -67,7 +69,37 @@ struct FeatureResult {
     Feature features { Feature::None };
     terminal::Palette palette {};
     terminal::ThemeMode theme_mode { terminal::ThemeMode::Dark };
+    bool restore_mode_2027 { false }; ///< Detection enabled DEC mode 2027, which should be disabled again
 };
 
-auto detect_features(dius::SyncFile& terminal) -> di::Result<FeatureResult>;
+/// @brief The queries written to the terminal to detect its features.
+///
+/// The final query is for the primary device attributes, which all terminals reply to. So once
+/// that reply is received, the terminal has replied to every query it supports.
+auto feature_detection_query() -> di::String;
+
+/// @brief Detect features from the terminal's \p replies to feature_detection_query().
+///
+/// Returns nothing if the replies are incomplete.
+auto features_from_replies(di::Span<byte const> replies) -> di::Optional<FeatureResult>;
+
+/// @brief Query \p terminal to detect its features.
+///
+/// When \p replies is non-null, the bytes read from the terminal are appended to it.
+auto detect_features(dius::SyncFile& terminal, di::Vector<byte>* replies = nullptr) -> di::Result<FeatureResult>;
+
+/// @brief Get the path used to cache the outer terminal's features in \p directory.
+///
+/// The outer terminal is identified by its TERM, TERM_PROGRAM, and TERM_PROGRAM_VERSION environment
+/// variables. Changes to the feature detection query also result in a different path.
+auto feature_cache_path(di::PathView directory) -> di::Path;
+
+/// @brief Load the features cached at \p path, if present.
+///
+/// The cache stores the terminal's replies rather than the detected features, so that the result
+/// always matches what detect_features() would produce.
+auto load_cached_features(di::PathView path) -> di::Optional<FeatureResult>;
+
+/// @brief Cache the terminal's \p replies to the feature detection query at \p path.
+auto store_cached_features(di::PathView path, di::Span<byte const> replies) -> di::Result<>;
 }
@@ -111,6 +111,19 @@ public:
                  di::FunctionRef<di::Result<di::Box<Pane>>(u64, di::Optional<di::Path>, Size const&)> make_pane)
         -> di::Result<LayoutGroup>;
 
+    // Like from_json_v1(), but without creating any panes. Each pane is a placeholder which only records its
+    // id and working directory, until make_panes() is called. Placeholders are serialized as they were restored.
+    static auto placeholder_from_json_v1(json::v1::PaneLayoutNode const& json) -> di::Result<LayoutGroup>;
+
+    // Create the panes for all placeholders, sized as if laid out at the given size. Placeholders whose pane
+    // failed to be created are left in place, and the first error is returned.
+    auto make_panes(Size const& size,
+                    di::FunctionRef<di::Result<di::Box<Pane>>(u64, di::Optional<di::Path>, Size const&)> make_pane)
+        -> di::Result<>;
+
+    // Returns the largest pane id in the group, including placeholders.
+    auto max_pane_id() const -> u64;
+
     // NOTE: this method returns the correct size for the new pane, and a lvalue reference where
     // the caller should store its newly created Pane. We need this akward API so that we can
     // create a Pane with a sane initial size.
@@ -120,6 +133,9 @@ public:
     // NOTE: after removing a pane, calling layout() is necessary as any previous LayoutNode's may become invalid.
     auto remove_pane(Pane* pane) -> di::Box<Pane>;
 
+    // Removes a single placeholder, giving its space to its siblings. Returns false if there were none left.
+    auto remove_placeholder() -> bool;
+
     // NOTE: after resizing a pane, caling layout() is necessary for the change to take effect. This functions
     // returns true if any change occurred.
     auto resize(LayoutNode& root, Pane* pane, ResizeDirection direction, i32 amount_in_cells) -> bool;
@@ -135,10 +151,12 @@ private:
     friend struct ToJsonV1;
     friend struct FromJsonV1;
     friend struct MakePane;
+    friend struct MaxPaneId;
 
     void redistribute_space(di::Variant<di::Box<LayoutGroup>, di::Box<LayoutPane>>* new_child,
                             i64 original_size_available, i64 new_size_available);
     void validate_layout();
+    auto remove_child(Pane* pane) -> di::Optional<di::Box<Pane>>;
 
     di::Vector<di::Variant<di::Box<LayoutGroup>, di::Box<LayoutPane>>> m_children;
     i64 m_relative_size { max_layout_precision };
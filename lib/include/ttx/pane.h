@@ -1,6 +1,6 @@
 #pragma once
 
-#include "di/container/queue/queue.h"
+#include "di/container/ring/ring.h"
 #include "di/container/string/string_view.h"
 #include "di/container/tree/tree_map.h"
 #include "di/container/vector/vector.h"
@@ -10,22 +10,29 @@
 #include "di/vocab/error/result.h"
 #include "di/vocab/pointer/box.h"
 #include "dius/condition_variable.h"
+#include "dius/steady_clock.h"
 #include "dius/sync_file.h"
 #include "dius/system/process.h"
 #include "dius/thread.h"
+#include "ttx/capture.h"
 #include "ttx/direction.h"
 #include "ttx/key_event.h"
 #include "ttx/mouse.h"
 #include "ttx/mouse_click_tracker.h"
+#include "ttx/pane_snapshot.h"
 #include "ttx/paste_event.h"
 #include "ttx/renderer.h"
+#include "ttx/replay.h"
 #include "ttx/size.h"
+#include "ttx/stats.h"
 #include "ttx/terminal.h"
 #include "ttx/terminal/escapes/osc_52.h"
 #include "ttx/terminal/escapes/osc_7.h"
 #include "ttx/terminal/escapes/osc_8671.h"
 #include "ttx/terminal/navigation_direction.h"
 #include "ttx/terminal/palette.h"
+#include "ttx/trace.h"
+#include "ttx/utf8_stream_decoder.h"
 
 namespace ttx {
 class Pane;
@@ -63,6 +70,7 @@ struct CreatePaneArgs {
                  capture_command_output_path.clone(),
                  replay_path.clone(),
                  save_state_path.clone(),
+                 restore_contents_directory.clone(),
                  pipe_input.clone(),
                  cwd.clone(),
                  terminfo_dir.clone(),
@@ -70,9 +78,14 @@ struct CreatePaneArgs {
                  global_palette,
                  local_palette,
                  theme_mode,
+                 max_bytes_per_frame,
+                 max_clipboard_bytes,
+                 replay_mode,
+                 replay_start,
                  pipe_output,
                  pipe_extra_output,
                  mock,
+                 tracer,
                  {} };
     }
 
@@ -86,6 +99,7 @@ struct CreatePaneArgs {
     di::Optional<di::Path> capture_command_output_path {};
     di::Optional<di::Path> replay_path {};
     di::Optional<di::Path> save_state_path {};
+    di::Optional<di::Path> restore_contents_directory {}; ///< Restore the contents from a PaneSnapshot in this directory
     di::Optional<di::String> pipe_input {};
     di::Optional<di::Path> cwd {};
     di::Optional<di::Path> terminfo_dir {};
@@ -93,17 +107,23 @@ struct CreatePaneArgs {
     terminal::Palette global_palette {};
     terminal::Palette local_palette {};
     terminal::ThemeMode theme_mode { terminal::ThemeMode::Dark };
+    u32 max_bytes_per_frame { 0 }; ///< Pause reading once this many bytes are read in a frame (0 means no limit)
+    u32 max_clipboard_bytes { 0 }; ///< Drop clipboard writes larger than this before decoding them (0 means no limit)
+    ReplayMode replay_mode { ReplayMode::Instant };
+    dius::SteadyClock::Duration replay_start {}; ///< Start replaying from the last keyframe before this offset
     bool pipe_output { false };
     bool pipe_extra_output { false }; ///< Create a pipe on fd 3 and read from it
     bool mock { false };
+    Tracer* tracer { nullptr }; ///< When set, spans for processing output are recorded
     PaneHooks hooks {};
 };
 
 class Pane {
 public:
-    static auto create_from_replay(u64 id, di::Optional<di::Path> cwd, di::PathView replay_path,
-                                   di::Optional<di::Path> save_state_path, Size const& size, PaneHooks hooks)
-        -> di::Result<di::Box<Pane>>;
+    /// @brief The window used when limiting the number of bytes read per frame.
+    constexpr static auto frame_duration = di::Milliseconds(25);
+
+    static auto create_from_replay(u64 id, CreatePaneArgs args, Size const& size) -> di::Result<di::Box<Pane>>;
     static auto create(u64 id, CreatePaneArgs args, Size const& size) -> di::Result<di::Box<Pane>>;
 
     // For testing, create a mock pane. This doesn't actually create a psuedo terminal or a subprocess.
@@ -121,12 +141,71 @@ public:
     ~Pane();
 
     auto id() const { return m_id; }
-    auto draw(Renderer& renderer) -> di::Tuple<RenderedCursor, terminal::Color>;
 
-    auto event(KeyEvent const& event) -> bool;
+    /// @brief Draw the pane's contents into the renderer.
+    ///
+    /// If the pane hasn't been updated since the last draw and \p force is false, the
+    /// renderer is left untouched and the cursor and background from the previous draw
+    /// are returned. This relies on the renderer's desired screen retaining the pane's
+    /// contents between frames.
+    auto draw(Renderer& renderer, bool force = false) -> di::Tuple<RenderedCursor, terminal::Color>;
+
+    /// @brief Mark the pane as needing to be redrawn.
+    ///
+    /// The did_update() hook is only invoked when the pane transitions from clean to dirty,
+    /// so any number of updates between two frames result in a single render request.
+    void mark_dirty();
+
+    /// @brief Query if the pane has been updated since it was last drawn.
+    auto dirty() const -> bool { return m_dirty.load(di::MemoryOrder::Acquire); }
+
+    /// @brief Process output from the application, as if it were read from the psuedo terminal.
+    ///
+    /// This is used by the reader thread, when replaying captured output, and for benchmarking.
+    /// The \p parser and \p utf8_decoder hold state which carries across calls. This does not
+    /// mark the pane dirty.
+    void process_output(di::Span<byte const> data, EscapeSequenceParser& parser, Utf8StreamDecoder& utf8_decoder);
+
+    /// @brief Get the pane's hot path statistics.
+    auto stats() const -> PaneStats const& { return m_stats; }
+
+    /// @brief Notify the pane that the frame containing its latest draw was written to the outer terminal.
+    void did_present_frame(dius::SteadyClock::TimePoint now) { m_stats.input_latency.did_present_frame(now); }
+
+    /// @brief Query if the pane's contents are still being restored from a snapshot.
+    ///
+    /// The pane's contents shouldn't be saved until this returns false, as they are incomplete.
+    auto restoring_contents() const -> bool { return m_restoring_contents.load(di::MemoryOrder::Acquire); }
+
+    /// @brief Serialize the pane's contents to update its snapshot. See PaneSnapshot::update().
+    ///
+    /// Returns nothing if the pane hasn't changed since \p snapshot was last saved. \p did_lock is called once the
+    /// terminal is locked. The pane is not destroyed while its terminal is locked, so the caller can then release
+    /// whatever kept the pane alive until now (like the layout lock) before the potentially slow serialization.
+    auto update_snapshot(PaneSnapshot& snapshot, di::FunctionRef<void()> did_lock)
+        -> di::Optional<PaneSnapshot::Update>;
+
+    /// @brief Estimate the number of bytes used by the pane's scroll back buffer.
+    auto scroll_back_memory_usage() -> usize;
+
+    /// @brief Send a key event to the application.
+    ///
+    /// When \p received is set, the key event's latency is tracked in the pane's statistics.
+    auto event(KeyEvent const& event, di::Optional<dius::SteadyClock::TimePoint> received = {}) -> bool;
     auto event(MouseEvent const& event) -> bool;
     auto event(FocusEvent const& event) -> bool;
-    auto event(PasteEvent const& event) -> bool;
+
+    /// @brief Send a paste to the application.
+    ///
+    /// Pastes are written to the pty in bounded chunks by the output thread, so large pastes don't need to
+    /// be copied, and can be cancelled with cancel_paste() while they are being written.
+    auto event(PasteEvent&& event) -> bool;
+
+    /// @brief Stop writing any pastes which haven't been fully written yet.
+    ///
+    /// If part of a bracketed paste was already written, the end of the paste is still sent, so the
+    /// application sees a well-formed (but truncated) paste. Returns true if any paste was cancelled.
+    auto cancel_paste() -> bool;
 
     /// @brief Query if it is valid to try to scroll the pane.
     ///
@@ -165,13 +244,33 @@ public:
 
     void update_local_palette(di::FunctionRef<void(terminal::Palette&)> update);
 
+    /// @brief Update the palette and theme mode inherited from the outer terminal
+    ///
+    /// The pane is only redrawn when the value actually changes, so these can be called for every pane.
     void set_global_palette(terminal::Palette const& palette);
     void set_theme_mode(terminal::ThemeMode theme_mode);
 
+    /// @brief Update the per-frame read budget, which takes effect from the next read
+    void set_max_bytes_per_frame(u32 max_bytes_per_frame) {
+        m_max_bytes_per_frame.store(max_bytes_per_frame, di::MemoryOrder::Relaxed);
+    }
+
+    /// @brief Update the largest clipboard write accepted from the inner application
+    void set_max_clipboard_bytes(u32 max_clipboard_bytes);
+
 private:
+    /// @brief Process output returned by \p read until it returns nothing or the pane is done.
+    ///
+    /// This is the main loop of the reader thread, which is shared by live panes and streaming replays.
+    void read_output(di::FunctionRef<di::Optional<di::Span<byte const>>()> read, TraceBuffer* trace);
+
+    /// @brief Process the pane's snapshot in \p directory, before any output from the application.
+    void restore_contents(di::PathView directory);
+
     void handle_terminal_event(TerminalEvent&& event);
     void write_pty_string(di::StringView data);
     void write_pty_string(di::TransparentStringView data);
+    void write_pty_bytes(di::Span<byte const> data);
     void update_selection_after_scrolling();
 
     void update_cwd(terminal::OSC7&& path_with_hostname);
@@ -180,12 +279,20 @@ private:
 
     u64 m_id { 0 };
     di::Atomic<bool> m_done { false };
-    di::Atomic<bool> m_capture { true };
+    di::Atomic<bool> m_dirty { true };
+    di::Atomic<bool> m_snapshot_dirty { true }; ///< Set when the pane was updated since its snapshot was saved
+    di::Atomic<bool> m_restoring_contents { false };
+    di::Optional<di::Tuple<RenderedCursor, terminal::Color>> m_last_draw;
     di::Optional<MousePosition> m_last_mouse_position;
     di::Optional<terminal::AbsolutePosition> m_pending_selection_start;
     MouseClickTracker m_mouse_click_tracker { 3 };
     dius::SyncFile m_pty_controller;
     di::Function<void()> m_restore_termios;
+    di::Atomic<u32> m_max_bytes_per_frame { 0 };
+    Tracer* m_tracer { nullptr };
+    TraceBuffer* m_trace { nullptr }; ///< Released when the pane is destroyed
+    PaneStats m_stats;
+    di::Synchronized<di::Optional<CaptureWriter>> m_capture;
     di::Synchronized<Terminal> m_terminal;
     di::Optional<Size> m_desired_visible_size;
     dius::system::ProcessHandle m_process;
@@ -196,7 +303,25 @@ private:
     di::Synchronized<di::Optional<di::Path>> m_cwd;
     di::Synchronized<di::Optional<di::String>> m_window_title;
     PaneHooks m_hooks;
-    di::Synchronized<di::Queue<di::Vector<byte>>> m_output_queue;
+    constexpr static auto paste_chunk_size = 64_usize * 1024;
+
+    struct PendingPaste {
+        di::String text;
+        usize offset { 0 };
+        bool bracketed { false };
+        bool started { false };      ///< Set once the first chunk has been written
+        di::Vector<byte> trailing {}; ///< Bytes queued after this paste, which are written once it's finished
+    };
+
+    // Bytes waiting to be written to the pty are written first, followed by each paste (and its trailing bytes).
+    struct OutputQueue {
+        di::Vector<byte> bytes;
+        di::Ring<PendingPaste> pastes;
+
+        auto empty() const -> bool { return bytes.empty() && pastes.empty(); }
+    };
+
+    di::Synchronized<OutputQueue> m_output_queue;
     dius::ConditionVariable m_output_condition;
 
     // These are declared last, for when dius::Thread calls join() in the destructor.
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "di/container/path/path.h"
+#include "di/container/string/string.h"
+#include "di/vocab/optional/prelude.h"
+#include "di/vocab/error/result.h"
+#include "ttx/terminal.h"
+
+namespace ttx {
+/// @brief Persists a pane's contents so they can be restored after a restart
+///
+/// A snapshot is stored as two files in the snapshot directory, named after the pane id. The
+/// history file (`<id>.history`) holds the pane's scroll back and only ever has new rows
+/// appended to it. The screen file (`<id>.screen`) holds the rows on the screen, the cursor,
+/// and the commands tracked by shell integration, and is rewritten on every save. Both hold
+/// escape sequences, so processing the history followed by the screen reproduces the pane's
+/// primary screen. The alternate screen and terminal modes belong to the application, which
+/// isn't restored, and so are not saved.
+///
+/// Because scroll back rows never change once written, saving only costs time proportional to
+/// the output produced since the last save. Rows which have since been dropped from the scroll
+/// back still occupy space in the history file, so it is rewritten once they make up more than
+/// half of it.
+class PaneSnapshot {
+public:
+    struct Update {
+        di::String history;              ///< Scroll back rows to append to (or replace) the history file.
+        bool replace_history { false };  ///< When set, the history file is truncated first.
+        di::Optional<di::String> screen; ///< The new contents of the screen file, if they changed.
+    };
+
+    static auto history_path(di::PathView directory, u64 pane_id) -> di::Path;
+    static auto screen_path(di::PathView directory, u64 pane_id) -> di::Path;
+
+    /// @brief Serialize the parts of \p terminal which need to be written to update the snapshot.
+    ///
+    /// This must be called with the terminal locked. The returned update is assumed to be written
+    /// successfully; otherwise call reset() so that the next update replaces the history.
+    auto update(Terminal const& terminal) -> Update;
+
+    /// @brief Write \p update to the snapshot files for \p pane_id.
+    static auto write(di::PathView directory, u64 pane_id, Update const& update) -> di::Result<>;
+
+    /// @brief Discard the snapshot for \p pane_id, after the pane was closed.
+    ///
+    /// The files are truncated rather than removed, since pane ids are reused across restarts.
+    static void clear(di::PathView directory, u64 pane_id);
+
+    /// @brief Forget what was saved, so that the next update rewrites everything.
+    void reset() { *this = {}; }
+
+    /// @brief Query if an update was saved since the snapshot was created or reset.
+    auto saved() const -> bool { return m_saved; }
+
+private:
+    bool m_saved { false };
+    u64 m_history_row_start { 0 }; ///< The absolute row of the first row in the history file.
+    u64 m_history_row_end { 0 };   ///< The absolute row after the last row in the history file.
+    di::String m_screen;           ///< The last contents of the screen file.
+};
+}
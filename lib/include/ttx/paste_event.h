@@ -10,6 +10,7 @@ public:
     constexpr explicit PasteEvent(di::String text) : m_text(di::move(text)) {}
 
     auto text() const -> di::StringView { return m_text; }
+    auto take_text() && -> di::String { return di::move(m_text); }
 
     auto operator==(PasteEvent const&) const -> bool = default;
 
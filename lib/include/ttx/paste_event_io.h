@@ -13,6 +13,7 @@ enum class BracketedPasteMode {
     Enabled,
 };
 
+constexpr auto bracketed_paste_begin = "\033[200~"_sv;
 constexpr auto bracketed_paste_end = "\033[201~"_sv;
 
 constexpr auto tag_invoke(di::Tag<di::reflect>, di::InPlaceType<BracketedPasteMode>) {
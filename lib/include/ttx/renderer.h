@@ -40,6 +40,11 @@ public:
 
     void flush_palette_color_state();
 
+    /// @brief Forget what's on the outer terminal's screen, so that the next frame redraws everything.
+    ///
+    /// Like a size change, this also clears the desired screen.
+    void invalidate() { m_size_changed = true; }
+
     void put_text(di::StringView text, u32 row, u32 col, terminal::GraphicsRendition const& rendition = {},
                   di::Optional<terminal::Hyperlink const&> hyperlink = {});
     void put_text(c32 text, u32 row, u32 col, terminal::GraphicsRendition const& rendition = {},
@@ -54,6 +59,19 @@ public:
 
     void set_bound(u32 row, u32 col, u32 width, u32 height);
 
+    /// @brief Prepare this renderer to be used as a tile of \p parent.
+    ///
+    /// A tile owns its own desired screen, which means multiple tiles can be drawn into
+    /// concurrently. The tile inherits the parent's features and palettes, and is bounded
+    /// to \p size. Once drawn, the tile must be copied into the parent using compose_tile().
+    void start_tile(Renderer const& parent, Size const& size, u32 dim_factor);
+
+    /// @brief Copy the cells drawn into \p tile into the desired screen at (\p row, \p col).
+    ///
+    /// Only cells which were drawn since the tile was last composed are copied, so tiles
+    /// retain the same damage tracking behavior as drawing directly into the renderer.
+    void compose_tile(Renderer& tile, u32 row, u32 col);
+
     [[nodiscard]] auto set_local_palette(terminal::Palette const& palette) -> di::ScopeExit<di::Function<void()>> {
         m_local_palette = palette;
         return di::ScopeExit(di::make_function<void()>([this] {
@@ -78,6 +96,7 @@ public:
         }));
     }
     void reset_dim_factor() { m_dim_factor = 0; }
+    auto dim_factor() const -> u32 { return m_dim_factor; }
 
     auto resolve_color(terminal::PaletteIndex index) const -> terminal::Color;
     auto resolve_color(terminal::Color color) const -> terminal::Color;
@@ -87,6 +106,9 @@ public:
     auto resolve_cursor_text_color() const -> terminal::Color;
     auto dimmed(terminal::Color color) const -> terminal::Color;
 
+    /// @brief The number of bytes written by the most recent call to finish().
+    auto last_frame_bytes() const -> usize { return m_last_frame_bytes; }
+
 private:
     auto size() const -> Size { return m_current_screen.size(); }
 
@@ -108,6 +130,7 @@ private:
     u32 m_bound_width { 0 };
     u32 m_bound_height { 0 };
     u32 m_dim_factor { 0 };
+    usize m_last_frame_bytes { 0 };
     bool m_size_changed { true };
 };
 }
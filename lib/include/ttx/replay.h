@@ -0,0 +1,88 @@
+#pragma once
+
+#include "di/container/path/path.h"
+#include "di/container/vector/vector.h"
+#include "di/reflect/prelude.h"
+#include "di/vocab/error/result.h"
+#include "di/vocab/optional/optional.h"
+#include "dius/steady_clock.h"
+#include "dius/sync_file.h"
+#include "ttx/capture.h"
+
+namespace ttx {
+/// @brief How captured output is played back when replaying
+enum class ReplayMode {
+    Instant,  ///< Process the entire capture while creating the pane
+    MaxSpeed, ///< Stream the capture on the pane's reader thread as fast as possible
+    Timed,    ///< Stream the capture on the pane's reader thread, using the recorded timing
+};
+
+constexpr auto tag_invoke(di::Tag<di::reflect>, di::InPlaceType<ReplayMode>) {
+    using enum ReplayMode;
+    return di::make_enumerators<"ReplayMode", "This mode controls how captured output is played back">(
+        di::enumerator<"instant", Instant, "Process the entire capture before displaying it">,
+        di::enumerator<"max-speed", MaxSpeed, "Stream the capture as fast as possible">,
+        di::enumerator<"timed", Timed, "Stream the capture using its recorded timing">);
+}
+
+/// @brief A chunk of captured output
+struct ReplayChunk {
+    usize size { 0 };
+
+    /// Time since the start of the capture this chunk was read, if known.
+    di::Optional<dius::SteadyClock::Duration> offset;
+};
+
+/// @brief Reader for output captured with --capture-command-output-path
+///
+/// This supports the capture container format (see ttx/capture.h), as well as raw output from an
+/// application. For raw captures, a timing file may be present alongside the capture (the capture
+/// path with ".timing" appended). The timing file has one line per chunk, consisting of the offset
+/// in microseconds since the capture started and the size of the chunk in bytes.
+///
+/// Resize records and keyframes are converted to the equivalent escape sequences, so that the
+/// output of the reader can always be processed directly by a terminal.
+class ReplayReader {
+public:
+    static auto open(di::PathView path) -> di::Result<ReplayReader>;
+
+    static auto timing_path(di::PathView path) -> di::Path;
+
+    explicit ReplayReader(dius::SyncFile file, bool container, di::Vector<di::Tuple<u64, usize>> timing = {},
+                          di::Vector<capture::Keyframe> keyframes = {});
+
+    auto has_timing() const -> bool { return m_container || !m_timing.empty(); }
+
+    /// @brief The keyframes listed in the capture's index, which is empty for raw captures.
+    auto keyframes() const -> di::Span<capture::Keyframe const> { return m_keyframes.span(); }
+
+    /// @brief Continue reading from the last keyframe at or before \p offset.
+    ///
+    /// The keyframe's terminal state is returned by the next read, followed by the output after it.
+    ///
+    /// @return false if there is no such keyframe, in which case the read position is unchanged.
+    auto seek(dius::SteadyClock::Duration offset) -> bool;
+
+    /// @brief Read the next chunk of captured output into \p buffer.
+    ///
+    /// @return The chunk, or an empty optional once the capture is exhausted.
+    auto read(di::Span<byte> buffer) -> di::Optional<ReplayChunk>;
+
+private:
+    auto read_raw(di::Span<byte> buffer) -> di::Optional<ReplayChunk>;
+    auto read_container(di::Span<byte> buffer) -> di::Optional<ReplayChunk>;
+    auto read_exactly_at(u64 position, di::Span<byte> buffer) -> bool;
+
+    dius::SyncFile m_file;
+    bool m_container { false };
+    u64 m_position { 0 };
+    di::Vector<di::Tuple<u64, usize>> m_timing;
+    usize m_timing_index { 0 };
+    di::Vector<capture::Keyframe> m_keyframes;
+    bool m_emit_keyframe { false };
+    di::Vector<byte> m_pending;
+    usize m_pending_offset { 0 };
+    usize m_chunk_remaining { 0 };
+    di::Optional<dius::SteadyClock::Duration> m_chunk_offset;
+};
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "di/container/array/array.h"
+#include "di/sync/atomic.h"
+#include "di/sync/memory_order.h"
+#include "dius/steady_clock.h"
+
+namespace ttx {
+/// @brief Compute the number of nanoseconds elapsed since \p start.
+auto elapsed_ns(dius::SteadyClock::TimePoint start, dius::SteadyClock::TimePoint end = dius::SteadyClock::now())
+    -> u64;
+
+/// @brief A counter which is cheap to update from hot paths.
+///
+/// Updates use relaxed atomics, so reading a counter from another thread is safe but
+/// may observe a slightly stale value.
+class StatCounter {
+public:
+    void add(u64 amount) { m_value.fetch_add(amount, di::MemoryOrder::Relaxed); }
+    auto value() const -> u64 { return m_value.load(di::MemoryOrder::Relaxed); }
+
+private:
+    di::Atomic<u64> m_value { 0 };
+};
+
+/// @brief A histogram with power of 2 sized buckets.
+///
+/// Recording a value is a constant time operation, at the cost of percentiles only
+/// being accurate to within a factor of 2.
+class StatHistogram {
+public:
+    constexpr static auto bucket_count = 65_usize;
+
+    void record(u64 value);
+
+    auto count() const -> u64 { return m_count.value(); }
+    auto sum() const -> u64 { return m_sum.value(); }
+    auto average() const -> u64 { return count() ? sum() / count() : 0; }
+
+    /// @brief Approximate the value at \p percent (0-100)
+    ///
+    /// The returned value is the upper bound of the bucket containing the percentile.
+    auto percentile(u32 percent) const -> u64;
+
+private:
+    di::Array<StatCounter, bucket_count> m_buckets;
+    StatCounter m_count;
+    StatCounter m_sum;
+};
+
+/// @brief Tracks the end-to-end latency of key presses sent to a pane
+///
+/// A key press is followed through 4 stages: being read by the input thread, being
+/// written to the pseudo terminal, the application's response (typically its echo)
+/// being processed, and the frame containing the response being written to the outer
+/// terminal. Only the oldest key press at each stage is tracked, so a burst of key
+/// presses is measured from its first key. Any output processed after the key is
+/// written is considered the response, which is exact for interactive use but not
+/// when the application is also producing output on its own.
+class InputLatency {
+public:
+    /// @brief A key press read at \p received was queued to be written to the application.
+    void did_write_input(dius::SteadyClock::TimePoint received,
+                         dius::SteadyClock::TimePoint written = dius::SteadyClock::now());
+
+    /// @brief Output from the application was processed.
+    void did_process_output(dius::SteadyClock::TimePoint now = dius::SteadyClock::now());
+
+    /// @brief The pane is about to be drawn, which will include all processed output.
+    void will_draw();
+
+    /// @brief Check if a drawn response is waiting for its frame to be written.
+    auto awaiting_frame() const -> bool { return m_awaiting_frame.load(di::MemoryOrder::Relaxed) != 0; }
+
+    /// @brief The frame containing the pane's latest draw was written to the outer terminal.
+    void did_present_frame(dius::SteadyClock::TimePoint now = dius::SteadyClock::now());
+
+    auto input_to_write_ns() const -> StatHistogram const& { return m_input_to_write_ns; }
+    auto input_to_output_ns() const -> StatHistogram const& { return m_input_to_output_ns; }
+    auto input_to_frame_ns() const -> StatHistogram const& { return m_input_to_frame_ns; }
+
+private:
+    // Each stage stores the time the key press was read, in nanoseconds since the clock's
+    // epoch, or 0 if there is no key press in that stage. Each stage only has a single
+    // thread which sets it, so a plain load and store is used instead of compare exchange.
+    di::Atomic<u64> m_awaiting_output { 0 };
+    di::Atomic<u64> m_awaiting_draw { 0 };
+    di::Atomic<u64> m_awaiting_frame { 0 };
+    StatHistogram m_input_to_write_ns;
+    StatHistogram m_input_to_output_ns;
+    StatHistogram m_input_to_frame_ns;
+};
+
+/// @brief Statistics for a single pane
+///
+/// These are primarily updated by the pane's reader thread, while the lock wait
+/// time also includes waits by the render thread while drawing the pane.
+struct PaneStats {
+    StatCounter bytes_read;
+    StatCounter parse_ns;
+    StatHistogram terminal_lock_wait_ns;
+    InputLatency input_latency;
+};
+}
@@ -67,8 +67,10 @@ public:
                       terminal::Palette const& local_palette, terminal::ThemeMode theme_mode);
 
     // Return a string which when replayed will result in the terminal
-    // having state identical to the current state.
-    auto state_as_escape_sequences() const -> di::String;
+    // having state identical to the current state. When include_scroll_back
+    // is false, only the visible rows are written, which is much cheaper for
+    // terminals with a lot of scroll back.
+    auto state_as_escape_sequences(bool include_scroll_back = true) const -> di::String;
 
     void on_parser_results(di::Span<ParserResult> results);
 
@@ -77,6 +79,9 @@ public:
         return const_cast<ScreenState&>(const_cast<Terminal const&>(*this).active_screen());
     }
 
+    // The primary screen is the only one with scroll back, so this is used when persisting pane contents.
+    auto primary_screen() const -> ScreenState const& { return m_primary_screen; }
+
     auto cursor_row() const -> u32 { return active_screen().screen.cursor().row; }
     auto cursor_col() const -> u32 { return active_screen().screen.cursor().col; }
     auto cursor_hidden() const -> bool { return m_cursor_hidden; }
@@ -88,6 +93,7 @@ public:
     // TODO: scroll back
     auto total_rows() const -> u32 { return row_count(); }
     auto visual_scroll_offset() const -> u64 { return active_screen().screen.visual_scroll_offset(); }
+    auto scroll_back_memory_usage() const -> usize { return m_primary_screen.screen.scroll_back_memory_usage(); }
 
     auto row_count() const -> u32 { return active_screen().screen.max_height(); }
     auto col_count() const -> u32 { return active_screen().screen.max_width(); }
@@ -118,6 +124,9 @@ public:
 
     void set_allow_force_terminal_size(bool b = true) { m_allow_force_terminal_size = b; }
 
+    /// @brief Drop OSC 52 clipboard writes larger than \p max_size bytes without decoding them (0 means no limit)
+    void set_max_clipboard_size(usize max_size) { m_max_clipboard_size = max_size; }
+
     void hide_cursor() { m_cursor_hidden = true; }
 
     auto seamless_navigation_protocol_active() const -> bool {
@@ -135,6 +144,7 @@ public:
     auto global_palette() const -> terminal::Palette const& { return m_global_palette; }
     void set_global_palette(terminal::Palette const& palette);
 
+    auto theme_mode() const -> terminal::ThemeMode { return m_theme_mode; }
     void set_theme_mode(terminal::ThemeMode mode);
     void send_theme_change();
 
@@ -150,6 +160,12 @@ private:
     void on_parser_result(Escape&& escape);
     void on_parser_result(ControlCharacter&& control);
 
+    /// @brief Handle a run of line feeds at the bottom of the scroll region with a single scroll
+    ///
+    /// Returns the number of parser results consumed, which is 0 if \p results doesn't start with
+    /// a line feed that would scroll the screen.
+    auto batch_line_feeds(di::Span<ParserResult> results) -> usize;
+
     void resize(Size const& size);
 
     void put_char(c32 c);
@@ -253,6 +269,7 @@ private:
     bool m_allow_80_132_col_mode { false };
     bool m_force_terminal_size { false };
     bool m_allow_force_terminal_size { false };
+    usize m_max_clipboard_size { 0 };
 
     terminal::ThemeMode m_theme_mode { terminal::ThemeMode::Dark };
     bool m_send_theme_changes { false };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "di/container/string/prelude.h"
+#include "di/container/vector/vector.h"
 #include "di/reflect/prelude.h"
 #include "ttx/escape_sequence_parser.h"
 #include "ttx/terminal/escapes/terminfo_string.h"
@@ -33,6 +34,12 @@ struct Terminfo {
 
     auto serialize() const -> di::String;
 
+    /// @brief Compile into the binary format used by ncurses, as if by running `tic -x`
+    ///
+    /// The format is described in term(5). Capabilities not known to ncurses are stored
+    /// as extended capabilities.
+    auto compile() const -> di::Vector<byte>;
+
     auto operator==(Terminfo const&) const -> bool = default;
     auto operator<=>(Terminfo const&) const = default;
 
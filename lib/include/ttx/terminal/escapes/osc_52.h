@@ -52,16 +52,24 @@ struct OSC52 {
     di::StaticVector<SelectionType, di::Constexpr<usize(SelectionType::Max)>> selections {};
     di::Base64<> data;
     bool query { false };
+    usize oversized { 0 }; ///< When non-zero, the approximate size of a write which was dropped for being too large
 
-    static auto parse(di::StringView data) -> di::Optional<OSC52>;
+    /// @brief Parse an OSC 52 sequence, dropping the data of writes larger than \p max_size bytes (0 means no limit)
+    ///
+    /// The size is estimated from the base64 length, so that oversized writes are never decoded.
+    static auto parse(di::StringView data, usize max_size = 0) -> di::Optional<OSC52>;
 
     auto serialize() const -> di::String;
 
+    /// @brief Serialize just the selection types (the first parameter), as used by serialize()
+    auto serialize_selections() const -> di::String;
+
     auto operator==(OSC52 const& other) const -> bool = default;
 
     constexpr friend auto tag_invoke(di::Tag<di::reflect>, di::InPlaceType<OSC52>) {
         return di::make_fields<"OSC52">(di::field<"selections", &OSC52::selections>, di::field<"data", &OSC52::data>,
-                                        di::field<"query", &OSC52::query>);
+                                        di::field<"query", &OSC52::query>,
+                                        di::field<"oversized", &OSC52::oversized>);
     }
 };
 }
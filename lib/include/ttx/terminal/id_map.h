@@ -97,20 +97,22 @@ public:
         return id;
     }
 
-    auto use_id(Id id) -> Id {
+    auto use_id(Id id, u32 count = 1) -> Id {
         auto it = m_id_map.find(id);
         ASSERT_NOT_EQ(it, m_id_map.end());
 
-        di::get<1>(*it).ref_count++;
+        di::get<1>(*it).ref_count += count;
         return id;
     }
 
-    void drop_id(Id id) {
+    void drop_id(Id id, u32 count = 1) {
         auto it = m_id_map.find(id);
         ASSERT_NOT_EQ(it, m_id_map.end());
 
         auto& rc = di::get<1>(*it);
-        if (--rc.ref_count == 0) {
+        ASSERT_GT_EQ(rc.ref_count, count);
+        rc.ref_count -= count;
+        if (rc.ref_count == 0) {
             m_id_lookup.erase(get_key(rc.value));
             m_ids_used[id - 1] = false;
             m_id_map.erase(id);
@@ -2,6 +2,7 @@
 #include "di/bit/bitset/prelude.h"
 #include "di/container/string/string_view.h"
 #include "di/container/view/cache_last.h"
+#include "di/io/vector_writer.h"
 #include "di/reflect/prelude.h"
 #include "scroll_region.h"
 #include "ttx/size.h"
@@ -116,7 +117,12 @@ public:
     void clear_row_before_cursor();
     void erase_characters(u32 n);
 
-    void scroll_down();
+    /// @brief Scroll the scroll region down by \p count rows
+    ///
+    /// The cursor must be on the last row of the scroll region. This is equivalent to
+    /// calling scroll_down() \p count times, but moves rows into the scroll back buffer
+    /// in bulk.
+    void scroll_down(u32 count = 1);
     void put_code_point(c32 code_point, AutoWrapMode auto_wrap_mode);
     void put_osc66(OSC66 const& sized_text, AutoWrapMode auto_wrap_mode);
 
@@ -136,6 +142,7 @@ public:
     auto absolute_row_screen_start() const -> u64 { return m_scroll_back.absolute_row_end(); }
     auto absolute_row_end() const -> u64 { return absolute_row_screen_start() + max_height(); }
     auto total_rows() const -> usize { return m_scroll_back.total_rows() + m_active_rows.total_rows(); }
+    auto scroll_back_memory_usage() const -> usize { return m_scroll_back.memory_usage(); }
 
     void clear_scroll_back();
 
@@ -183,12 +190,28 @@ public:
     /// not embedded in the returned escape sequences. The
     /// Terminal::state_as_escape_sequences() includes a superset of
     /// information, including the size and dec modes.
-    auto state_as_escape_sequences() const -> di::String;
+    ///
+    /// When \p include_scroll_back is false, only the rows on the screen
+    /// are written. Processing the output of scroll_back_as_escape_sequences()
+    /// beforehand places those rows in the scroll back.
+    auto state_as_escape_sequences(bool include_scroll_back = true) const -> di::String;
+
+    /// @brief Serialize scroll back rows to terminal escape sequences
+    ///
+    /// This writes the absolute rows in the range [\p row_start, \p row_end), clamped to the
+    /// rows currently in the scroll back. Every row not marked as overflowed is terminated by
+    /// a new line, and the graphics rendition is reset at the end, so the results for adjacent
+    /// ranges can be concatenated.
+    auto scroll_back_as_escape_sequences(u64 row_start, u64 row_end) const -> di::String;
 
     void put_cell(di::StringView text, MultiCellInfo const& multi_cell_info, AutoWrapMode auto_wrap_mode,
                   bool explicitly_sized, bool complex_grapheme_cluster);
 
 private:
+    // Write the rows in the range [row_start, row_end), returning the last graphics rendition and hyperlink written.
+    auto write_rows_as_escape_sequences(di::VectorWriter<>& writer, u64 row_start, u64 row_end) const
+        -> di::Tuple<GraphicsRendition, di::Optional<Hyperlink const&>>;
+
     void put_single_cell(di::StringView text, MultiCellInfo const& multi_cell_info, AutoWrapMode auto_wrap_mode,
                          bool explicitly_sized, bool complex_grapheme_cluster);
     void put_wide_cell(di::StringView text, MultiCellInfo const& multi_cell_info, AutoWrapMode auto_wrap_mode,
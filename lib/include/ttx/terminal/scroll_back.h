@@ -33,6 +33,7 @@ class ScrollBack {
     struct Group {
         RowGroup group;
         usize cell_count { 0 };
+        usize memory_usage { 0 };
         di::Optional<u32> last_reflowed_to;
     };
 
@@ -41,6 +42,13 @@ public:
     auto absolute_row_end() const -> u64 { return m_absolute_row_start + total_rows(); }
     auto total_rows() const -> usize { return m_total_rows; }
 
+    /// @brief Estimate the number of bytes used to store the scroll back
+    ///
+    /// This accounts for the row and cell storage as well as row text, but not the memory
+    /// used by the graphics renditions, hyperlinks, and multi cell info of each group. The
+    /// value is kept up to date as rows are added and removed, so this is constant time.
+    auto memory_usage() const -> usize { return m_memory_usage; }
+
     /// @brief Clear the scroll back history
     void clear();
 
@@ -107,12 +115,15 @@ private:
         return last_row_overflow ? max_cells_per_group : target_cells_per_group;
     }
 
+    static auto rows_memory_usage(RowGroup const& group, usize row_index, usize row_count) -> usize;
+
     auto find_row_group(u64 row) -> di::Tuple<u32, u64, Group&>;
     auto is_last_group_full() const -> bool;
     auto add_group() -> Group&;
 
     di::Ring<Group> m_groups;
     usize m_total_rows { 0 };
+    usize m_memory_usage { 0 };
     u64 m_absolute_row_start { 0 };
 };
 }
@@ -23,6 +23,13 @@ using Event = di::Variant<KeyEvent, MouseEvent, FocusEvent, PasteEvent, terminal
                           terminal::DarkLightModeDetectionReport, terminal::StatusStringResponse,
                           terminal::TerminfoString, terminal::OSC21, terminal::OSC52, terminal::OSC8671>;
 
+/// @brief Collapse each run of consecutive mouse motion events into the most recent one
+///
+/// Motion events only report where the mouse is now, so when several are read at once only the last one matters.
+/// Motion events are only collapsed when they have the same buttons held and the same modifiers, so presses,
+/// releases and changes in the held buttons are always preserved.
+void coalesce_mouse_motion(di::Vector<Event>& events);
+
 class TerminalInputParser {
 public:
     auto parse(di::StringView input, Feature features) -> di::Vector<Event>;
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "di/container/queue/priority_queue.h"
+#include "di/container/tree/tree_map.h"
+#include "di/container/vector/vector.h"
+#include "di/function/compare_backwards.h"
+#include "di/function/container/function.h"
+#include "di/sync/atomic.h"
+#include "di/sync/synchronized.h"
+#include "di/vocab/error/result.h"
+#include "di/vocab/pointer/box.h"
+#include "dius/condition_variable.h"
+#include "dius/steady_clock.h"
+#include "dius/thread.h"
+
+namespace ttx {
+/// @brief A set of callbacks ordered by deadline
+///
+/// This class does no synchronization and never reads the clock, which is left to the caller (see TimerThread).
+class TimerQueue {
+public:
+    using Callback = di::Function<void()>;
+
+    /// @brief Schedule \p callback to run at \p deadline, returning an id which can be passed to cancel()
+    auto add(dius::SteadyClock::TimePoint deadline, Callback callback) -> u64;
+
+    /// @brief Cancel the timer with \p id, which does nothing if the timer has already expired
+    void cancel(u64 id);
+
+    /// @brief The earliest deadline of any timer which has not been cancelled
+    auto next_deadline() -> di::Optional<dius::SteadyClock::TimePoint>;
+
+    /// @brief Remove and return the callbacks of all timers whose deadline is at or before \p now
+    ///
+    /// The callbacks are ordered by deadline, with ties broken by the order the timers were added.
+    auto take_expired(dius::SteadyClock::TimePoint now) -> di::Vector<Callback>;
+
+    auto empty() const -> bool { return m_callbacks.empty(); }
+
+private:
+    struct Entry {
+        dius::SteadyClock::TimePoint deadline;
+        u64 id { 0 };
+
+        auto operator==(Entry const&) const -> bool = default;
+        auto operator<=>(Entry const&) const = default;
+    };
+
+    // Cancelled timers are only removed from the callbacks, and their entries are skipped once they reach the top.
+    di::PriorityQueue<Entry, di::Vector<Entry>, di::CompareBackwards> m_entries;
+    di::TreeMap<u64, Callback> m_callbacks;
+    u64 m_next_id { 1 };
+};
+
+/// @brief A thread which runs callbacks at their deadline
+///
+/// Threads which block on something other than a condition variable (like the input thread reading from the
+/// terminal), or which only wake up for events (like the render thread), use this to act on deadlines without
+/// needing to poll. The callbacks run on the timer thread, so they must be short and thread safe. Typically they
+/// just wake up the thread which cares about the deadline.
+class TimerThread {
+public:
+    /// @brief How long the timer thread sleeps before checking if an earlier timer was added
+    ///
+    /// The thread sleeps until the earliest deadline, but a timer added while it sleeps may have an even earlier
+    /// deadline. Sleeping in bounded increments limits how late such a timer can run, while the thread still blocks
+    /// indefinitely when there are no timers.
+    constexpr static auto max_sleep = di::Milliseconds(10);
+
+    static auto create() -> di::Result<di::Box<TimerThread>>;
+
+    TimerThread() = default;
+    ~TimerThread();
+
+    auto add(dius::SteadyClock::TimePoint deadline, TimerQueue::Callback callback) -> u64;
+    void cancel(u64 id);
+
+    /// @brief Stop the timer thread, waiting for any running callback to finish
+    ///
+    /// After this returns, no callbacks will run. This must be called before destroying anything which the
+    /// callbacks reference.
+    void stop();
+
+private:
+    void timer_thread();
+
+    di::Synchronized<TimerQueue> m_timers;
+    dius::ConditionVariable m_condition;
+    di::Atomic<bool> m_done { false };
+    dius::Thread m_thread;
+};
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "di/container/array/array.h"
+#include "di/container/path/path.h"
+#include "di/container/string/string.h"
+#include "di/container/vector/vector.h"
+#include "di/sync/atomic.h"
+#include "di/sync/synchronized.h"
+#include "di/vocab/error/result.h"
+#include "di/vocab/pointer/box.h"
+#include "dius/steady_clock.h"
+
+namespace ttx {
+class Tracer;
+
+/// @brief The kinds of spans which can be traced
+enum class TraceEventType : u64 {
+    ProcessPendingEvents,
+    DoRender,
+    PaneDraw,
+    RendererFinish,
+    PaneOutput,
+};
+
+auto trace_event_name(TraceEventType type) -> di::StringView;
+
+struct TraceEvent {
+    TraceEventType type { TraceEventType::DoRender };
+    u64 start_ns { 0 };
+    u64 duration_ns { 0 };
+    u64 arg { 0 };
+};
+
+/// @brief A fixed size ring buffer of trace events
+///
+/// Each buffer must only have a single writer at a time, which is usually a single thread.
+/// Recording events is lock-free, and the oldest events are overwritten once the buffer is
+/// full. The buffer can be read concurrently with writes, in which case events which are
+/// being overwritten are skipped.
+class TraceBuffer {
+public:
+    constexpr static auto capacity = 4096_usize;
+
+    explicit TraceBuffer(Tracer& tracer, di::String name, u32 id)
+        : m_tracer(tracer), m_name(di::move(name)), m_id(id) {}
+
+    auto name() const -> di::StringView { return m_name; }
+    auto id() const -> u32 { return m_id; }
+
+    void record(TraceEventType type, dius::SteadyClock::TimePoint start, dius::SteadyClock::TimePoint end,
+                u64 arg = 0);
+
+    /// @brief Copy out the events currently in the buffer, from oldest to newest.
+    auto snapshot() const -> di::Vector<TraceEvent>;
+
+private:
+    // Each field is atomic so that a reader racing with a writer can detect the race using the
+    // sequence number, which is odd while the slot is being written.
+    struct Slot {
+        di::Atomic<u64> sequence { 0 };
+        di::Atomic<u64> type { 0 };
+        di::Atomic<u64> start_ns { 0 };
+        di::Atomic<u64> duration_ns { 0 };
+        di::Atomic<u64> arg { 0 };
+    };
+
+    Tracer& m_tracer;
+    di::String m_name;
+    u32 m_id { 0 };
+    di::Atomic<u64> m_head { 0 };
+    di::Array<Slot, capacity> m_slots;
+};
+
+/// @brief Measure a span and record it into a trace buffer when destroyed
+///
+/// If the buffer is null, tracing is disabled and this does nothing.
+class TraceSpan {
+public:
+    explicit TraceSpan(TraceBuffer* buffer, TraceEventType type, u64 arg = 0)
+        : m_buffer(buffer), m_type(type), m_arg(arg) {
+        if (m_buffer) {
+            m_start = dius::SteadyClock::now();
+        }
+    }
+
+    ~TraceSpan() {
+        if (m_buffer) {
+            m_buffer->record(m_type, m_start, dius::SteadyClock::now(), m_arg);
+        }
+    }
+
+    TraceSpan(TraceSpan const&) = delete;
+    auto operator=(TraceSpan const&) -> TraceSpan& = delete;
+
+private:
+    TraceBuffer* m_buffer { nullptr };
+    TraceEventType m_type { TraceEventType::DoRender };
+    u64 m_arg { 0 };
+    dius::SteadyClock::TimePoint m_start {};
+};
+
+/// @brief Collects trace events from multiple threads and writes them in the Trace Event format
+///
+/// The output can be viewed using chrome://tracing or https://ui.perfetto.dev.
+class Tracer {
+public:
+    constexpr static auto max_released_events = 16 * TraceBuffer::capacity;
+
+    explicit Tracer(di::Path path) : m_path(di::move(path)), m_start(dius::SteadyClock::now()) {}
+
+    auto path() const -> di::PathView { return m_path; }
+
+    /// @brief Create a buffer for a new thread
+    ///
+    /// The buffer lives until it is released or the tracer is destroyed, so its events are kept after the thread
+    /// exits.
+    auto create_buffer(di::String name) -> TraceBuffer&;
+
+    /// @brief Destroy \p buffer, keeping a copy of its events for the trace
+    ///
+    /// Owners which come and go (like panes) release their buffers so that the tracer's memory stays bounded. The
+    /// events of released buffers are still written, but once more than \ref max_released_events are retained the
+    /// oldest released buffers are dropped. The buffer must not be recorded to afterwards.
+    void release_buffer(TraceBuffer& buffer);
+
+    /// @brief Convert a time point to nanoseconds since the tracer was created.
+    auto to_trace_ns(dius::SteadyClock::TimePoint time) const -> u64;
+
+    /// @brief Serialize all trace events as Trace Event JSON.
+    auto to_json() -> di::String;
+
+    /// @brief Write all trace events to the output path.
+    auto write() -> di::Result<>;
+
+private:
+    struct ReleasedBuffer {
+        di::String name;
+        u32 id { 0 };
+        di::Vector<TraceEvent> events;
+    };
+
+    struct Buffers {
+        di::Vector<di::Box<TraceBuffer>> live;
+        di::Vector<ReleasedBuffer> released; ///< Oldest first
+        usize released_events { 0 };
+    };
+
+    di::Path m_path;
+    dius::SteadyClock::TimePoint m_start;
+    di::Synchronized<Buffers> m_buffers;
+    di::Atomic<u32> m_next_buffer_id { 1 };
+};
+}
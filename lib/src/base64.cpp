@@ -0,0 +1,115 @@
+#include "ttx/base64.h"
+
+#include "di/container/array/array.h"
+
+namespace ttx {
+constexpr auto alphabet = di::Array {
+    'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V',
+    'W', 'X', 'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r',
+    's', 't', 'u', 'v', 'w', 'x', 'y', 'z', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '+', '/',
+};
+
+constexpr auto invalid_sextet = u8(0xff);
+
+// Maps 12 bits of input to the 2 characters which encode them, stored adjacently.
+constexpr auto encode_pairs = [] {
+    auto result = di::Array<byte, 2 * 4096> {};
+    for (auto i = 0_usize; i < 4096; i++) {
+        result[2 * i] = byte(alphabet[i >> 6]);
+        result[2 * i + 1] = byte(alphabet[i & 63]);
+    }
+    return result;
+}();
+
+constexpr auto decode_table = [] {
+    auto result = di::Array<u8, 256> {};
+    for (auto& value : result) {
+        value = invalid_sextet;
+    }
+    for (auto i = 0_usize; i < alphabet.size(); i++) {
+        result[usize(u8(alphabet[i]))] = u8(i);
+    }
+    return result;
+}();
+
+void base64_encode(di::Span<byte const> input, di::Vector<byte>& output) {
+    auto const offset = output.size();
+    output.resize(offset + base64_encoded_size(input.size()));
+
+    auto const* in = input.data();
+    auto* out = output.data() + offset;
+    auto remaining = input.size();
+    for (; remaining >= 3; remaining -= 3, in += 3, out += 4) {
+        auto const bits = (u32(in[0]) << 16) | (u32(in[1]) << 8) | u32(in[2]);
+        auto const high = (bits >> 12) * 2;
+        auto const low = (bits & 0xfff) * 2;
+        out[0] = encode_pairs[high];
+        out[1] = encode_pairs[high + 1];
+        out[2] = encode_pairs[low];
+        out[3] = encode_pairs[low + 1];
+    }
+
+    if (remaining > 0) {
+        auto bits = u32(in[0]) << 16;
+        if (remaining == 2) {
+            bits |= u32(in[1]) << 8;
+        }
+        out[0] = byte(alphabet[bits >> 18]);
+        out[1] = byte(alphabet[(bits >> 12) & 63]);
+        out[2] = remaining == 2 ? byte(alphabet[(bits >> 6) & 63]) : byte('=');
+        out[3] = byte('=');
+    }
+}
+
+auto base64_decode(di::Span<byte const> input) -> di::Optional<di::Vector<byte>> {
+    // Strip padding, which can only be present at the end.
+    auto size = input.size();
+    for (auto i = 0; i < 2 && size > 0 && input[size - 1] == byte('='); i++) {
+        size--;
+    }
+    if (size % 4 == 1) {
+        return {};
+    }
+
+    auto result = di::Vector<byte> {};
+    result.resize(size / 4 * 3 + (size % 4 == 0 ? 0 : size % 4 - 1));
+
+    auto const* in = input.data();
+    auto* out = result.data();
+    auto remaining = size;
+
+    // Accumulate invalid characters across the whole input, so the main loop has no extra branches.
+    auto invalid = u8(0);
+    for (; remaining >= 4; remaining -= 4, in += 4, out += 3) {
+        auto const a = decode_table[usize(in[0])];
+        auto const b = decode_table[usize(in[1])];
+        auto const c = decode_table[usize(in[2])];
+        auto const d = decode_table[usize(in[3])];
+        invalid = u8(invalid | a | b | c | d);
+
+        auto const bits = (u32(a) << 18) | (u32(b) << 12) | (u32(c) << 6) | u32(d);
+        out[0] = byte(u8(bits >> 16));
+        out[1] = byte(u8(bits >> 8));
+        out[2] = byte(u8(bits));
+    }
+
+    if (remaining > 0) {
+        auto bits = u32(0);
+        for (auto i = 0_usize; i < remaining; i++) {
+            auto const sextet = decode_table[usize(in[i])];
+            invalid = u8(invalid | sextet);
+            bits |= u32(sextet) << (18 - 6 * i);
+        }
+        out[0] = byte(u8(bits >> 16));
+        if (remaining == 3) {
+            out[1] = byte(u8(bits >> 8));
+        }
+    }
+
+    // Valid sextets never have the top 2 bits set, while the invalid marker does.
+    if (invalid & 0xc0) {
+        return {};
+    }
+    return result;
+}
+}
@@ -0,0 +1,98 @@
+#include "ttx/capture.h"
+
+#include "ttx/stats.h"
+
+namespace ttx {
+namespace capture {
+    void append_u32(di::Vector<byte>& output, u32 value) {
+        for (auto i : di::range(4)) {
+            output.push_back(byte(value >> (8 * i)));
+        }
+    }
+
+    void append_u64(di::Vector<byte>& output, u64 value) {
+        for (auto i : di::range(8)) {
+            output.push_back(byte(value >> (8 * i)));
+        }
+    }
+
+    auto read_u32(di::Span<byte const> input) -> u32 {
+        auto result = 0_u32;
+        for (auto i : di::range(4)) {
+            result |= u32(input[i]) << (8 * i);
+        }
+        return result;
+    }
+
+    auto read_u64(di::Span<byte const> input) -> u64 {
+        auto result = 0_u64;
+        for (auto i : di::range(8)) {
+            result |= u64(input[i]) << (8 * i);
+        }
+        return result;
+    }
+}
+
+auto CaptureWriter::create(di::PathView path, Size const& size) -> di::Result<CaptureWriter> {
+    auto result = CaptureWriter(TRY(dius::open_sync(path, dius::OpenMode::WriteClobber)));
+    TRY(result.m_file.write_exactly(di::as_bytes(capture::header_magic.span())));
+    result.m_position = capture::header_magic.size_bytes();
+
+    // Write out inital terminal size information.
+    TRY(result.write_resize(size));
+    return result;
+}
+
+auto CaptureWriter::offset_us() const -> u64 {
+    return elapsed_ns(m_start) / 1000;
+}
+
+auto CaptureWriter::write_record(capture::RecordType type, di::Span<byte const> payload, u64 offset_us)
+    -> di::Result<> {
+    auto header = di::Vector<byte> {};
+    capture::append_u32(header, u32(type));
+    capture::append_u32(header, u32(payload.size()));
+    capture::append_u64(header, offset_us);
+    TRY(m_file.write_exactly(header.span()));
+    TRY(m_file.write_exactly(payload));
+    m_position += header.size() + payload.size();
+    return {};
+}
+
+auto CaptureWriter::write_output(di::Span<byte const> data) -> di::Result<> {
+    m_output_since_keyframe += data.size();
+    return write_record(capture::RecordType::Output, data, offset_us());
+}
+
+auto CaptureWriter::write_resize(Size const& size) -> di::Result<> {
+    auto payload = di::Vector<byte> {};
+    capture::append_u32(payload, size.rows);
+    capture::append_u32(payload, size.cols);
+    capture::append_u32(payload, size.xpixels);
+    capture::append_u32(payload, size.ypixels);
+    return write_record(capture::RecordType::Resize, payload.span(), offset_us());
+}
+
+auto CaptureWriter::write_keyframe(di::StringView state) -> di::Result<> {
+    auto keyframe = capture::Keyframe { offset_us(), m_position };
+    TRY(write_record(capture::RecordType::Keyframe, di::as_bytes(state.span()), keyframe.offset_us));
+    m_keyframes.push_back(keyframe);
+    m_output_since_keyframe = 0;
+    return {};
+}
+
+auto CaptureWriter::finish() -> di::Result<> {
+    auto index_position = m_position;
+    auto payload = di::Vector<byte> {};
+    for (auto const& keyframe : m_keyframes) {
+        capture::append_u64(payload, keyframe.offset_us);
+        capture::append_u64(payload, keyframe.file_position);
+    }
+    TRY(write_record(capture::RecordType::Index, payload.span(), offset_us()));
+
+    auto footer = di::Vector<byte> {};
+    capture::append_u64(footer, index_position);
+    footer.append_container(di::as_bytes(capture::footer_magic.span()));
+    return m_file.write_exactly(footer.span());
+}
+}
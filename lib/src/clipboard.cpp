@@ -5,7 +5,8 @@
 #include "ttx/terminal/escapes/osc_52.h"
 
 namespace ttx {
-Clipboard::Clipboard(ClipboardMode mode, Feature features) : m_mode(mode), m_features(features) {}
+Clipboard::Clipboard(ClipboardMode mode, Feature features, usize max_size)
+    : m_mode(mode), m_features(features), m_max_size(max_size) {}
 
 auto Clipboard::set_clipboard(terminal::SelectionType type, di::Vector<byte> data,
                               dius::SteadyClock::TimePoint reception) -> bool {
@@ -15,6 +16,10 @@ auto Clipboard::set_clipboard(terminal::SelectionType type, di::Vector<byte> dat
         expire(reception);
     });
 
+    if (exceeds_max_size(data.size())) {
+        return false;
+    }
+
     auto write_system = false;
     auto action = action_for_clipboard_write(type);
     switch (action) {
@@ -83,8 +88,8 @@ void Clipboard::got_clipboard_response(terminal::SelectionType type, di::Vector<
     // Don't overwrite the clipboard if an empty response is detected. In this case, its
     // possible the user has configured their terminal in such a way that applications don't
     // have permission to read the clipboard. We want to fallback to our own local clipboard
-    // in this case.
-    if (!data.empty()) {
+    // in this case. Responses which are too large to store are ignored as well.
+    if (!data.empty() && !exceeds_max_size(data.size())) {
         state.data = di::move(data);
     }
 
@@ -102,6 +107,19 @@ auto Clipboard::get_replies(dius::SteadyClock::TimePoint reception) -> di::Vecto
     return di::exchange(m_replies, di::Vector<Reply> {});
 }
 
+auto Clipboard::next_expiration() -> di::Optional<dius::SteadyClock::TimePoint> {
+    auto result = di::Optional<dius::SteadyClock::TimePoint> {};
+    for (auto& state : m_state) {
+        if (auto top = state.requests.top()) {
+            auto expiration = top.value().reception + request_timeout;
+            if (!result || expiration < result.value()) {
+                result = expiration;
+            }
+        }
+    }
+    return result;
+}
+
 void Clipboard::expire(dius::SteadyClock::TimePoint reception) {
     for (auto [i, state] : m_state | di::enumerate) {
         while (!state.requests.empty()) {
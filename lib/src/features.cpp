@@ -1,8 +1,11 @@
 #include "ttx/features.h"
 
+#include "di/container/string/conversion.h"
 #include "di/io/vector_writer.h"
 #include "di/io/writer_print.h"
 #include "dius/condition_variable.h"
+#include "dius/filesystem/operations.h"
+#include "dius/system/process.h"
 #include "dius/thread.h"
 #include "ttx/focus_event.h"
 #include "ttx/key_event.h"
@@ -48,7 +51,6 @@ class FeatureDetector {
 public:
     auto done() const -> bool { return m_done; }
     auto result() const -> FeatureResult { return m_result; }
-    auto need_to_disable_mode_2027() const { return m_need_to_restore_mode_2027; }
 
     void handle_event(KeyEvent const&) {}
     void handle_event(MouseEvent const&) {}
@@ -65,7 +67,7 @@ public:
                 if (mode == terminal::DecMode::GraphemeClustering) {
                     is_supported |= reply.support == terminal::ModeSupport::AlwaysSet;
                     if (reply.support == terminal::ModeSupport::Unset) {
-                        m_need_to_restore_mode_2027 = true;
+                        m_result.restore_mode_2027 = true;
                     }
                 }
                 if (is_supported) {
@@ -151,10 +153,22 @@ private:
     di::Optional<terminal::CursorPositionReport> m_prev_cursor;
     u32 m_cursor_reports { 0 };
     u32 m_cursor_color_reports { 0 };
-    bool m_need_to_restore_mode_2027 { false };
 };
 
-auto detect_features(dius::SyncFile& terminal) -> di::Result<FeatureResult> {
+static void process_replies(FeatureDetector& detector, TerminalInputParser& parser, Utf8StreamDecoder& utf8_decoder,
+                            di::Span<byte const> replies) {
+    auto utf8_string = utf8_decoder.decode(replies);
+    auto events = parser.parse(utf8_string, Feature::KittyKeyProtocol);
+    for (auto const& event : events) {
+        di::visit(
+            [&](auto const& ev) {
+                detector.handle_event(ev);
+            },
+            event);
+    }
+}
+
+auto feature_detection_query() -> di::String {
     // For feature detection, the general strategy is to write a byte series to the host
     // terminal, ending with a query for device attributes. All terminals will respond to
     // the device attributes, so we can determine when a terminal igonres a specific request.
@@ -268,6 +282,21 @@ auto detect_features(dius::SyncFile& terminal) -> di::Result<FeatureResult> {
     // Clear the line, as we have been writing text:
     di::writer_print<di::String::Encoding>(request_buffer, "\r\033[K"_sv);
 
+    return request_buffer.vector() | di::transform(di::construct<c8>) | di::to<di::String>(di::encoding::assume_valid);
+}
+
+auto features_from_replies(di::Span<byte const> replies) -> di::Optional<FeatureResult> {
+    auto detector = FeatureDetector {};
+    auto parser = TerminalInputParser {};
+    auto utf8_decoder = Utf8StreamDecoder {};
+    process_replies(detector, parser, utf8_decoder, replies);
+    if (!detector.done()) {
+        return {};
+    }
+    return detector.result();
+}
+
+auto detect_features(dius::SyncFile& terminal, di::Vector<byte>* replies) -> di::Result<FeatureResult> {
     // Setup reader thread.
     auto detector = FeatureDetector {};
     auto error = di::Error {};
@@ -294,21 +323,19 @@ auto detect_features(dius::SyncFile& terminal) -> di::Result<FeatureResult> {
                 error = di::BasicError::StreamTimeout;
             }
 
-            auto utf8_string = utf8_decoder.decode(buffer | di::take(nread.value()));
-            auto events = parser.parse(utf8_string, Feature::KittyKeyProtocol);
-            for (auto const& event : events) {
-                di::visit(
-                    [&](auto const& ev) {
-                        detector.handle_event(ev);
-                    },
-                    event);
+            auto data = *buffer.span().subspan(0, nread.value());
+            if (replies) {
+                for (auto b : data) {
+                    replies->push_back(b);
+                }
             }
+            process_replies(detector, parser, utf8_decoder, data);
         }
     }));
 
     // Write query
     auto _ = TRY(terminal.enter_raw_mode());
-    auto text = di::move(request_buffer).vector();
+    auto text = feature_detection_query();
     TRY(terminal.write_exactly(di::as_bytes(text.span())));
 
     auto guard = di::UniqueLock(lock);
@@ -320,11 +347,32 @@ auto detect_features(dius::SyncFile& terminal) -> di::Result<FeatureResult> {
     }
 
     auto result = detector.result();
-    if (detector.need_to_disable_mode_2027()) {
+    if (result.restore_mode_2027) {
         // Be a good citizen, and restore the mode. We need to enable it to properly
         // test the implementation.
         di::writer_print<di::String::Encoding>(terminal, "\033[?2027l"_sv);
     }
     return result;
 }
+
+auto feature_cache_path(di::PathView directory) -> di::Path {
+    auto const& env = dius::system::get_environment();
+    auto key = di::format("{}\n{}\n{}\n{}"_sv, env.at("TERM"_tsv).value_or(""_tsv),
+                          env.at("TERM_PROGRAM"_tsv).value_or(""_tsv),
+                          env.at("TERM_PROGRAM_VERSION"_tsv).value_or(""_tsv), feature_detection_query());
+    return directory.to_owned() / di::to_transparent_string(di::to_string(di::hash(key)));
+}
+
+auto load_cached_features(di::PathView path) -> di::Optional<FeatureResult> {
+    auto replies = dius::read_to_string(path);
+    if (!replies) {
+        return {};
+    }
+    return features_from_replies(di::as_bytes(replies.value().span()));
+}
+
+auto store_cached_features(di::PathView path, di::Span<byte const> replies) -> di::Result<> {
+    auto file = TRY(dius::open_sync(path, dius::OpenMode::WriteClobber));
+    return file.write_exactly(replies);
+}
 }
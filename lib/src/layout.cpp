@@ -1,7 +1,7 @@
 #include "ttx/layout.h"
 
 #include "di/container/algorithm/count_if.h"
-#include "di/container/interface/erase.h"
+#include "di/container/algorithm/find_if.h"
 #include "di/container/view/as_rvalue.h"
 #include "di/function/overload.h"
 #include "di/util/scope_exit.h"
@@ -298,39 +298,44 @@ auto LayoutGroup::split(Size const& size, u32 row_offset, u32 col_offset, Pane*
 }
 
 auto LayoutGroup::remove_pane(Pane* pane) -> di::Box<Pane> {
+    auto result = remove_child(pane);
+    if (!result) {
+        return {};
+    }
+    return di::move(result).value();
+}
+
+auto LayoutGroup::remove_placeholder() -> bool {
+    return remove_child(nullptr).has_value();
+}
+
+auto LayoutGroup::remove_child(Pane* pane) -> di::Optional<di::Box<Pane>> {
     auto _ = di::ScopeExit([&] {
         validate_layout();
     });
 
-    // First, try to delete the pane from this level.
-    auto result = di::Box<Pane> {};
-    auto removed_size = di::Optional<i64> {};
-    di::erase_if(m_children, [&](auto const& variant) {
-        return di::visit(di::overload(
-                             [&](di::Box<LayoutGroup> const&) {
-                                 return false;
-                             },
-                             [&](di::Box<LayoutPane> const& layout_pane) {
-                                 if (layout_pane->pane.get() == pane) {
-                                     result = di::move(layout_pane->pane);
-                                     removed_size = layout_pane->relative_size;
-                                     return true;
-                                 }
-                                 return false;
-                             }),
-                         variant);
+    // First, try to delete the pane from this level. Only a single child is removed, because placeholders all
+    // have a null pane and the space of each removed child must be redistributed separately.
+    auto result = di::Optional<di::Box<Pane>> {};
+    auto* it = di::find_if(m_children, [&](auto const& variant) {
+        auto layout_pane = di::get_if<di::Box<LayoutPane>>(variant);
+        return layout_pane && layout_pane.value()->pane.get() == pane;
     });
-    if (removed_size) {
-        redistribute_space(nullptr, max_layout_precision - removed_size.value(), max_layout_precision);
+    if (it != m_children.end()) {
+        auto& layout_pane = di::get<di::Box<LayoutPane>>(*it);
+        result = di::move(layout_pane->pane);
+        auto removed_size = layout_pane->relative_size;
+        m_children.erase(it);
+        redistribute_space(nullptr, max_layout_precision - removed_size, max_layout_precision);
     }
 
     // Then, try to delete the pane recursively.
     for (auto const& child : m_children) {
+        if (result) {
+            break;
+        }
         if (auto group = di::get_if<di::Box<LayoutGroup>>(child)) {
-            auto res = group.value()->remove_pane(pane);
-            if (res) {
-                result = di::move(res);
-            }
+            result = group.value()->remove_child(pane);
         }
     }
 
@@ -661,6 +666,12 @@ struct ToJsonV1 {
             json.current_working_directory = node->pane->current_working_directory().transform([](di::PathView path) {
                 return di::PercentEncoded<>::from_raw_data(path.data().to_owned());
             });
+        } else {
+            // This is a placeholder for a pane which hasn't been created yet.
+            json.id = node->pane_id;
+            json.current_working_directory = node->cwd.transform([](di::Path const& path) {
+                return di::PercentEncoded<>::from_raw_data(path.data().to_owned());
+            });
         }
         json.relative_size = node->relative_size;
         return json;
@@ -705,26 +716,31 @@ struct FromJsonV1 {
 struct MakePane {
     LayoutNode& layout;
     di::FunctionRef<di::Result<di::Box<Pane>>(u64 id, di::Optional<di::Path>, Size const&)> make_pane;
+    di::Result<>& result;
 
-    auto operator()(LayoutGroup& node) const -> di::Result<> {
+    void operator()(LayoutGroup& node) const {
         for (auto& child : node.m_children) {
-            TRY(di::visit(*this, child));
+            di::visit(*this, child);
         }
-        return {};
     }
 
-    auto operator()(di::Box<LayoutGroup>& node) const -> di::Result<> { return (*this)(*node); }
+    void operator()(di::Box<LayoutGroup>& node) const { (*this)(*node); }
 
-    auto operator()(di::Box<LayoutPane>& node) const -> di::Result<> {
+    void operator()(di::Box<LayoutPane>& node) const {
+        // Use a default size. If there's no layout, the pane was too small. So
+        // make a 1x10 pane.
         auto entry = layout.find_pane_by_id(node->pane_id);
-        if (!entry) {
-            // Use a default size. If there's no layout, the pane was too small. So
-            // make a 1x10 pane.
-            node->pane = TRY(make_pane(node->pane_id, di::move(node->cwd), Size { 1, 10, 12, 160 }));
-        } else {
-            node->pane = TRY(make_pane(node->pane_id, di::move(node->cwd), entry->size));
+        auto size = entry ? entry->size : Size { 1, 10, 12, 160 };
+
+        // The working directory is kept in case creating the pane fails, as the placeholder stays.
+        auto pane = make_pane(node->pane_id, di::clone(node->cwd), size);
+        if (!pane) {
+            if (result) {
+                result = di::Unexpected(di::move(pane).error());
+            }
+            return;
         }
-        return {};
+        node->pane = di::move(pane).value();
     }
 };
 
@@ -732,9 +748,41 @@ auto LayoutGroup::from_json_v1(
     json::v1::PaneLayoutNode const& json, Size const& size,
     di::FunctionRef<di::Result<di::Box<Pane>>(u64 id, di::Optional<di::Path>, Size const&)> make_pane)
     -> di::Result<LayoutGroup> {
-    auto group = TRY(FromJsonV1::operator()(json));
-    auto layout = group.layout(size, 0, 0);
-    TRY(MakePane(*layout, make_pane)(group));
+    auto group = TRY(placeholder_from_json_v1(json));
+    TRY(group.make_panes(size, make_pane));
     return group;
 }
+
+auto LayoutGroup::placeholder_from_json_v1(json::v1::PaneLayoutNode const& json) -> di::Result<LayoutGroup> {
+    return FromJsonV1::operator()(json);
+}
+
+auto LayoutGroup::make_panes(
+    Size const& size, di::FunctionRef<di::Result<di::Box<Pane>>(u64 id, di::Optional<di::Path>, Size const&)> make_pane)
+    -> di::Result<> {
+    auto tree = layout(size, 0, 0);
+    auto result = di::Result<> {};
+    MakePane(*tree, make_pane, result)(*this);
+    return result;
+}
+
+struct MaxPaneId {
+    static auto operator()(LayoutGroup const& node) -> u64 {
+        auto result = u64(0);
+        for (auto const& child : node.m_children) {
+            result = di::max(result, di::visit(MaxPaneId {}, child));
+        }
+        return result;
+    }
+
+    static auto operator()(di::Box<LayoutGroup> const& node) -> u64 { return MaxPaneId::operator()(*node); }
+
+    static auto operator()(di::Box<LayoutPane> const& node) -> u64 {
+        return node->pane ? node->pane->id() : node->pane_id;
+    }
+};
+
+auto LayoutGroup::max_pane_id() const -> u64 {
+    return MaxPaneId::operator()(*this);
+}
 }
@@ -10,12 +10,17 @@
 #include "dius/print.h"
 #include "dius/sync_file.h"
 #include "dius/system/process.h"
+#include "ttx/base64.h"
+#include "ttx/capture.h"
 #include "ttx/direction.h"
 #include "ttx/modifiers.h"
 #include "ttx/mouse.h"
 #include "ttx/mouse_event.h"
+#include "ttx/pane_snapshot.h"
 #include "ttx/paste_event.h"
+#include "ttx/paste_event_io.h"
 #include "ttx/renderer.h"
+#include "ttx/replay.h"
 #include "ttx/size.h"
 #include "ttx/terminal.h"
 #include "ttx/terminal/escapes/osc_2.h"
@@ -74,56 +79,91 @@ static auto spawn_child(CreatePaneArgs& args, dius::SyncFile& pty, Size const& s
     return di::move(result).spawn();
 }
 
-auto Pane::create_from_replay(u64 id, di::Optional<di::Path> cwd, di::PathView replay_path,
-                              di::Optional<di::Path> save_state_path, Size const& size, PaneHooks hooks)
-    -> di::Result<di::Box<Pane>> {
-    auto replay_file = TRY(dius::open_sync(replay_path, dius::OpenMode::Readonly));
+auto Pane::create_from_replay(u64 id, CreatePaneArgs args, Size const& size) -> di::Result<di::Box<Pane>> {
+    auto replay = TRY(ReplayReader::open(*args.replay_path));
 
-    // When replaying content, there is no need for any threads, a psudeo terminal or a sub-process.
-    auto pane =
-        di::make_box<Pane>(id, di::move(cwd), dius::SyncFile(), size, dius::system::ProcessHandle(),
-                           terminal::Palette {}, terminal::Palette {}, terminal::ThemeMode::Dark, di::move(hooks));
+    // Jumping ahead relies on the capture's keyframes. Any output between the keyframe and the requested start
+    // is processed without waiting in timed mode.
+    auto const replay_start = args.replay_start;
+    if (replay_start > dius::SteadyClock::Duration {}) {
+        (void) replay.seek(replay_start);
+    }
+
+    // When replaying content, there is no need for a psudeo terminal or a sub-process.
+    auto pane = di::make_box<Pane>(id, di::move(args.cwd), dius::SyncFile(), size, dius::system::ProcessHandle(),
+                                   terminal::Palette {}, terminal::Palette {}, terminal::ThemeMode::Dark,
+                                   di::move(args.hooks));
 
     // Allow the terminal to use CSI 8; height; width; t. Normally this would be ignored since application
     // shouldn't control this.
     pane->m_terminal.get_assuming_no_concurrent_accesses().set_allow_force_terminal_size();
+    pane->set_max_clipboard_bytes(args.max_clipboard_bytes);
 
-    // Now read the replay file and play it back directly into the terminal. By doing this synchronously any test system
-    // can look at the pane content's afterwards and no we've finished.
-    auto buffer = di::Vector<byte> {};
-    buffer.resize(16384);
-
-    auto parser = EscapeSequenceParser();
-    auto utf8_decoder = Utf8StreamDecoder {};
-    for (;;) {
-        auto nread = replay_file.read_some(buffer.span());
-        if (!nread.has_value() || nread == 0) {
-            break;
+    auto did_finish_replay = [&pane = *pane, save_state_path = di::move(args.save_state_path)] -> di::Result<> {
+        // If requested, write out the terminal state now that everything has been replayed.
+        // This is useful to testing.
+        for (auto const& path : save_state_path) {
+            TRY(pane.save_state(path));
         }
 
-        auto utf8_string = utf8_decoder.decode(buffer | di::take(*nread));
-
-        auto parser_result = parser.parse_application_escape_sequences(utf8_string);
-
-        auto events = pane->m_terminal.with_lock([&](Terminal& terminal) {
-            terminal.on_parser_results(parser_result.span());
-            return terminal.outgoing_events();
-        });
+        // Ensure mouse works even if the replayed file enabled mouse reporting.
+        pane.m_terminal.lock()->reset_mouse_reporting();
+        return {};
+    };
 
-        for (auto&& event : events) {
-            pane->handle_terminal_event(di::move(event));
+    // Now read the replay file and play it back directly into the terminal. By doing this synchronously any test system
+    // can look at the pane content's afterwards and no we've finished.
+    if (args.replay_mode == ReplayMode::Instant) {
+        auto buffer = di::Vector<byte> {};
+        buffer.resize(16384);
+
+        auto parser = EscapeSequenceParser();
+        auto utf8_decoder = Utf8StreamDecoder {};
+        while (auto chunk = replay.read(buffer.span())) {
+            pane->process_output(buffer | di::take(chunk->size), parser, utf8_decoder);
         }
-    }
 
-    // If requested, write out the terminal state now that everything has been replayed.
-    // This is useful to testing.
-    for (auto const& path : save_state_path) {
-        TRY(pane->save_state(path));
+        TRY(did_finish_replay());
+        return pane;
     }
 
-    // Ensure mouse works even if the replayed file enabled mouse reporting.
-    pane->m_terminal.get_assuming_no_concurrent_accesses().reset_mouse_reporting();
+    // Otherwise, stream the replay file on the reader thread, just like output from a live process. This makes
+    // replays useful for load testing the render path.
+    pane->set_max_bytes_per_frame(args.max_bytes_per_frame);
+    auto* trace = args.tracer ? &args.tracer->create_buffer(di::format("pane {} replay"_sv, id)) : nullptr;
+    pane->m_tracer = args.tracer;
+    pane->m_trace = trace;
+    auto const timed = args.replay_mode == ReplayMode::Timed;
+    pane->m_reader_thread =
+        TRY(dius::Thread::create([&pane = *pane, replay = di::move(replay), timed, replay_start,
+                                  did_finish_replay = di::move(did_finish_replay), trace] mutable -> void {
+            auto buffer = di::Vector<byte> {};
+            buffer.resize(16384);
+
+            auto start = dius::SteadyClock::now();
+            pane.read_output(
+                [&] -> di::Optional<di::Span<byte const>> {
+                    auto chunk = replay.read(buffer.span());
+                    if (!chunk) {
+                        return {};
+                    }
+                    if (timed && chunk->offset && chunk->offset.value() > replay_start) {
+                        // Sleep in increments of at most a frame, so that the pane can be destroyed promptly.
+                        auto deadline = start + (chunk->offset.value() - replay_start);
+                        while (!pane.m_done.load(di::MemoryOrder::Acquire) && dius::SteadyClock::now() < deadline) {
+                            auto next_frame = dius::SteadyClock::now() + frame_duration;
+                            dius::this_thread::sleep_until(di::min(deadline, next_frame));
+                        }
+                    }
+                    return buffer | di::take(chunk->size);
+                },
+                trace);
 
+            if (!pane.m_done.load(di::MemoryOrder::Acquire)) {
+                (void) did_finish_replay();
+                pane.mark_dirty();
+            }
+        }));
     return pane;
 }
 
@@ -133,17 +173,12 @@ auto Pane::create(u64 id, CreatePaneArgs args, Size const& size) -> di::Result<d
     }
 
     if (args.replay_path) {
-        return create_from_replay(id, di::move(args.cwd), *args.replay_path, di::move(args.save_state_path), size,
-                                  di::move(args.hooks));
+        return create_from_replay(id, di::move(args), size);
     }
 
-    auto capture_file = di::Optional<dius::SyncFile> {};
+    auto capture = di::Optional<CaptureWriter> {};
     if (args.capture_command_output_path) {
-        capture_file = TRY(dius::open_sync(args.capture_command_output_path.value(), dius::OpenMode::WriteClobber));
-
-        // Write out inital terminal size information.
-        di::writer_print<di::String::Encoding>(capture_file.value(), "\033[4;{};{}t"_sv, size.ypixels, size.xpixels);
-        di::writer_print<di::String::Encoding>(capture_file.value(), "\033[8;{};{}t"_sv, size.rows, size.cols);
+        capture = TRY(CaptureWriter::create(args.capture_command_output_path.value(), size));
     }
 
     auto pty_controller = TRY(dius::open_psuedo_terminal_controller(dius::OpenMode::ReadWrite));
@@ -184,6 +219,14 @@ auto Pane::create(u64 id, CreatePaneArgs args, Size const& size) -> di::Result<d
 #ifdef __linux__
     pane->m_restore_termios = di::move(restore_termios);
 #endif
+    pane->set_max_bytes_per_frame(args.max_bytes_per_frame);
+    pane->set_max_clipboard_bytes(args.max_clipboard_bytes);
+    pane->m_capture.get_assuming_no_concurrent_accesses() = di::move(capture);
+    pane->m_restoring_contents.store(args.restore_contents_directory.has_value(), di::MemoryOrder::Relaxed);
+
+    auto* trace = args.tracer ? &args.tracer->create_buffer(di::format("pane {} reader"_sv, id)) : nullptr;
+    pane->m_tracer = args.tracer;
+    pane->m_trace = trace;
 
     pane->m_process_thread = TRY(dius::Thread::create([&pane = *pane] mutable {
         auto result = pane.m_process.wait();
@@ -195,51 +238,56 @@ auto Pane::create(u64 id, CreatePaneArgs args, Size const& size) -> di::Result<d
         }
     }));
 
-    pane->m_reader_thread =
-        TRY(dius::Thread::create([&pane = *pane, capture_file = di::move(capture_file)] mutable -> void {
-            auto parser = EscapeSequenceParser();
-            auto utf8_decoder = Utf8StreamDecoder {};
+    pane->m_reader_thread = TRY(dius::Thread::create([&pane = *pane, trace,
+                                                      restore_contents_directory =
+                                                          di::move(args.restore_contents_directory)] -> void {
+        // Restoring happens here instead of when creating the pane, so that restoring a layout isn't slowed down by
+        // large snapshots. The application's output waits in the psuedo terminal until this finishes.
+        for (auto const& directory : restore_contents_directory) {
+            pane.restore_contents(directory);
+        }
 
-            auto buffer = di::Vector<byte> {};
-            buffer.resize(16384);
+        auto buffer = di::Vector<byte> {};
+        buffer.resize(16384);
 
-            while (!pane.m_done.load(di::MemoryOrder::Acquire)) {
+        pane.read_output(
+            [&] -> di::Optional<di::Span<byte const>> {
                 // SAFETY: this thread is the only one which reads the pty.
                 auto nread = pane.m_pty_controller.read_some(buffer.span());
                 if (!nread.has_value()) {
-                    break;
+                    return {};
                 }
 
-                if (capture_file) {
-                    if (pane.m_capture.load(di::MemoryOrder::Acquire)) {
-                        (void) di::write_exactly(*capture_file, buffer | di::take(*nread));
-                    } else {
-                        capture_file = {};
+                pane.m_capture.with_lock([&](di::Optional<CaptureWriter>& capture) {
+                    if (!capture) {
+                        return;
                     }
-                }
-
-                auto utf8_string = utf8_decoder.decode(buffer | di::take(*nread));
-
-                auto parser_result = parser.parse_application_escape_sequences(utf8_string);
 
-                auto events = pane.m_terminal.with_lock([&](Terminal& terminal) {
-                    terminal.on_parser_results(parser_result.span());
-                    return terminal.outgoing_events();
+                    // The terminal state reflects all output before this chunk, so the keyframe goes first. Only
+                    // the visible screen is included, since serializing the whole scroll back while holding the
+                    // terminal lock would stall rendering and input every keyframe.
+                    if (capture->wants_keyframe()) {
+                        auto state = pane.m_terminal.with_lock([](Terminal& terminal) {
+                            return terminal.state_as_escape_sequences(false);
+                        });
+                        (void) capture->write_keyframe(state);
+                    }
+                    (void) capture->write_output(buffer | di::take(*nread));
                 });
+                return buffer | di::take(*nread);
+            },
+            trace);
 
-                for (auto&& event : events) {
-                    pane.handle_terminal_event(di::move(event));
-                }
-
-                if (pane.m_hooks.did_update) {
-                    pane.m_hooks.did_update(pane);
-                }
-            }
-        }));
+        pane.stop_capture();
+    }));
 
     pane->m_output_thread = TRY(dius::Thread::create([&pane = *pane] -> void {
+        // Everything queued since the last write is written at once, so a burst of events (like fast mouse
+        // motion or key repeat) costs a single syscall. The two buffers are swapped back and forth, so that
+        // their allocations are reused.
+        auto output_bytes = di::Vector<byte> {};
         while (!pane.m_done.load(di::MemoryOrder::Acquire)) {
-            auto output_bytes = [&] {
+            {
                 auto lock = di::UniqueLock(pane.m_output_queue.get_lock());
                 pane.m_output_condition.wait(lock, [&] {
                     // SAFETY: we acquired the lock manually above.
@@ -248,19 +296,37 @@ auto Pane::create(u64 id, CreatePaneArgs args, Size const& size) -> di::Result<d
                 });
 
                 // SAFETY: we acquired the lock manually above.
-                auto result = di::Vector<di::Vector<byte>> {};
-                for (auto& bytes : pane.m_output_queue.get_assuming_no_concurrent_accesses()) {
-                    result.push_back(di::move(bytes));
-                }
-                return result;
-            }();
+                auto& queue = pane.m_output_queue.get_assuming_no_concurrent_accesses();
+                if (!queue.bytes.empty()) {
+                    di::swap(output_bytes, queue.bytes);
+                } else if (auto paste = queue.pastes.front()) {
+                    // Pastes are written a chunk at a time, which bounds the memory used and allows
+                    // cancelling the paste in between chunks.
+                    if (!paste->started && paste->bracketed) {
+                        output_bytes.append_container(di::as_bytes(bracketed_paste_begin.span()));
+                    }
+                    paste->started = true;
 
-            for (auto const& bytes : output_bytes) {
-                if (pane.m_done.load(di::MemoryOrder::Acquire)) {
-                    break;
+                    auto text = di::as_bytes(paste->text.span());
+                    auto chunk_size = di::min(paste_chunk_size, text.size() - paste->offset);
+                    output_bytes.append_container(*text.subspan(paste->offset, chunk_size));
+                    paste->offset += chunk_size;
+
+                    if (paste->offset == text.size()) {
+                        if (paste->bracketed) {
+                            output_bytes.append_container(di::as_bytes(bracketed_paste_end.span()));
+                        }
+                        queue.bytes = di::move(paste->trailing);
+                        queue.pastes.pop_front();
+                    }
                 }
-                (void) pane.m_pty_controller.write_exactly(bytes.span());
             }
+
+            if (pane.m_done.load(di::MemoryOrder::Acquire)) {
+                break;
+            }
+            (void) pane.m_pty_controller.write_exactly(output_bytes.span());
+            output_bytes.clear();
         }
     }));
 
@@ -347,7 +413,117 @@ auto Pane::create_mock(u64 id, di::Optional<di::Path> cwd) -> di::Box<Pane> {
                               terminal::ThemeMode::Dark, PaneHooks {});
 }
 
+void Pane::read_output(di::FunctionRef<di::Optional<di::Span<byte const>>()> read, TraceBuffer* trace) {
+    auto parser = EscapeSequenceParser();
+    auto utf8_decoder = Utf8StreamDecoder {};
+
+    auto frame_end = dius::SteadyClock::now() + frame_duration;
+    auto bytes_this_frame = 0_usize;
+
+    while (!m_done.load(di::MemoryOrder::Acquire)) {
+        auto data = read();
+        if (!data) {
+            break;
+        }
+
+        {
+            auto _ = TraceSpan(trace, TraceEventType::PaneOutput, id());
+            process_output(*data, parser, utf8_decoder);
+        }
+        mark_dirty();
+
+        // When the application produces output faster than we can display it, most of it would scroll off
+        // the screen before the next frame. Pause reading once the budget for the current frame has been
+        // used up. While paused the pseudo terminal's buffer fills up, which blocks the application's writes
+        // and so bounds the CPU time a single pane can consume.
+        auto const max_bytes_per_frame = m_max_bytes_per_frame.load(di::MemoryOrder::Relaxed);
+        if (max_bytes_per_frame > 0) {
+            auto now = dius::SteadyClock::now();
+            if (now >= frame_end) {
+                frame_end = now + frame_duration;
+                bytes_this_frame = 0;
+            }
+            bytes_this_frame += data->size();
+            if (bytes_this_frame >= max_bytes_per_frame) {
+                dius::this_thread::sleep_until(frame_end);
+                frame_end += frame_duration;
+                bytes_this_frame = 0;
+            }
+        }
+    }
+}
+
+void Pane::restore_contents(di::PathView directory) {
+    auto _ = di::ScopeExit([&] {
+        m_restoring_contents.store(false, di::MemoryOrder::Release);
+    });
+
+    auto parser = EscapeSequenceParser();
+    auto utf8_decoder = Utf8StreamDecoder {};
+    auto buffer = di::Vector<byte> {};
+    buffer.resize(16384);
+
+    auto paths = di::Array { PaneSnapshot::history_path(directory, id()), PaneSnapshot::screen_path(directory, id()) };
+    for (auto const& path : paths) {
+        // A missing file means there's nothing to restore.
+        auto file = dius::open_sync(path, dius::OpenMode::Readonly);
+        if (!file) {
+            continue;
+        }
+
+        while (!m_done.load(di::MemoryOrder::Acquire)) {
+            auto nread = file.value().read_some(buffer.span());
+            if (!nread || *nread == 0) {
+                break;
+            }
+            process_output(buffer | di::take(*nread), parser, utf8_decoder);
+        }
+    }
+    mark_dirty();
+}
+
+auto Pane::update_snapshot(PaneSnapshot& snapshot, di::FunctionRef<void()> did_lock)
+    -> di::Optional<PaneSnapshot::Update> {
+    return m_terminal.with_lock([&](Terminal const& terminal) -> di::Optional<PaneSnapshot::Update> {
+        did_lock();
+
+        // A snapshot which was never saved (or failed to save) is always updated.
+        if (!m_snapshot_dirty.exchange(false, di::MemoryOrder::Acquire) && snapshot.saved()) {
+            return {};
+        }
+        return snapshot.update(terminal);
+    });
+}
+
+void Pane::process_output(di::Span<byte const> data, EscapeSequenceParser& parser, Utf8StreamDecoder& utf8_decoder) {
+    auto start = dius::SteadyClock::now();
+    auto utf8_string = utf8_decoder.decode(data);
+
+    auto parser_result = parser.parse_application_escape_sequences(utf8_string);
+
+    auto lock_start = dius::SteadyClock::now();
+    auto events = m_terminal.with_lock([&](Terminal& terminal) {
+        auto locked = dius::SteadyClock::now();
+        m_stats.terminal_lock_wait_ns.record(elapsed_ns(lock_start, locked));
+
+        terminal.on_parser_results(parser_result.span());
+
+        // Don't count time spent waiting for the lock as parsing time.
+        m_stats.parse_ns.add(elapsed_ns(start, lock_start) + elapsed_ns(locked));
+        return terminal.outgoing_events();
+    });
+    m_stats.bytes_read.add(data.size());
+    m_stats.input_latency.did_process_output();
+
+    for (auto&& event : events) {
+        handle_terminal_event(di::move(event));
+    }
+}
+
 Pane::~Pane() {
+    // Stop any replay in progress. Live panes stop reading once the process exits.
+    m_done.store(true, di::MemoryOrder::Release);
+
     // TODO: timeout/skip waiting for processes to die after sending SIGHUP.
     (void) m_process.signal(dius::Signal::Hangup);
     (void) m_pipe_reader_thread.join();
@@ -356,12 +532,31 @@ Pane::~Pane() {
     (void) m_reader_thread.join();
     (void) m_output_thread.join();
     (void) m_process_thread.join();
+
+    // Wait for a snapshot which is still reading the terminal. See update_snapshot().
+    m_terminal.with_lock([](Terminal&) {});
+
+    // The threads which recorded into the trace buffer have exited.
+    if (m_trace) {
+        m_tracer->release_buffer(*m_trace);
+    }
 }
 
 // NOLINTNEXTLINE(readability-function-cognitive-complexity)
-auto Pane::draw(Renderer& renderer) -> di::Tuple<RenderedCursor, terminal::Color> {
+auto Pane::draw(Renderer& renderer, bool force) -> di::Tuple<RenderedCursor, terminal::Color> {
+    // Clear the dirty flag before acquiring the terminal lock. Any update which races with
+    // this draw will set the flag again, and so schedule another render.
+    auto const was_dirty = m_dirty.exchange(false, di::MemoryOrder::Acquire);
+    if (!was_dirty && !force && m_last_draw) {
+        return m_last_draw.value();
+    }
+    m_stats.input_latency.will_draw();
+
+    auto lock_start = dius::SteadyClock::now();
     auto [rendered_cursor,
           bg] = m_terminal.with_lock([&](Terminal& terminal) -> di::Tuple<RenderedCursor, terminal::Color> {
+        m_stats.terminal_lock_wait_ns.record(elapsed_ns(lock_start));
+
         auto const& palette = terminal.local_palette();
         auto _ =
             palette.modified() ? renderer.set_local_palette(palette) : di::ScopeExit(di::make_function<void()>([] {}));
@@ -477,14 +672,28 @@ auto Pane::draw(Renderer& renderer) -> di::Tuple<RenderedCursor, terminal::Color
     for (auto&& event : events) {
         handle_terminal_event(di::move(event));
     }
-    if (need_another_render && m_hooks.did_update) {
-        m_hooks.did_update(*this);
+    if (need_another_render) {
+        mark_dirty();
     }
 
+    m_last_draw = di::Tuple { rendered_cursor, bg };
     return { rendered_cursor, bg };
 }
 
-auto Pane::event(KeyEvent const& event) -> bool {
+auto Pane::scroll_back_memory_usage() -> usize {
+    return m_terminal.with_lock([&](Terminal& terminal) {
+        return terminal.scroll_back_memory_usage();
+    });
+}
+
+void Pane::mark_dirty() {
+    m_snapshot_dirty.store(true, di::MemoryOrder::Release);
+    if (!m_dirty.exchange(true, di::MemoryOrder::Release) && m_hooks.did_update) {
+        m_hooks.did_update(*this);
+    }
+}
+
+auto Pane::event(KeyEvent const& event, di::Optional<dius::SteadyClock::TimePoint> received) -> bool {
     auto [application_cursor_keys_mode, key_reporting_flags] = m_terminal.with_lock([&](Terminal& terminal) {
         return di::Tuple { terminal.application_cursor_keys_mode(), terminal.key_reporting_flags() };
     });
@@ -497,8 +706,12 @@ auto Pane::event(KeyEvent const& event) -> bool {
             terminal.active_screen().screen.clear_selection();
             m_pending_selection_start = {};
         });
+        mark_dirty();
 
         write_pty_string(serialized_event.value());
+        if (received) {
+            m_stats.input_latency.did_write_input(received.value());
+        }
         return true;
     }
     return false;
@@ -563,6 +776,7 @@ auto Pane::event(MouseEvent const& event) -> bool {
                 m_pending_selection_start = scroll_adjusted_position;
             }
         });
+        mark_dirty();
         return true;
     }
 
@@ -576,6 +790,7 @@ auto Pane::event(MouseEvent const& event) -> bool {
             }
             terminal.active_screen().screen.update_selection(scroll_adjusted_position);
         });
+        mark_dirty();
         return true;
     }
 
@@ -586,6 +801,7 @@ auto Pane::event(MouseEvent const& event) -> bool {
             m_pending_selection_start = {};
             return result;
         });
+        mark_dirty();
         if (!text.empty() && m_hooks.did_selection) {
             // Simulate a selection as an OSC 52 request.
             auto osc52 = terminal::OSC52 {};
@@ -601,6 +817,9 @@ auto Pane::event(MouseEvent const& event) -> bool {
         terminal.active_screen().screen.clear_selection();
         m_pending_selection_start = {};
     });
+    if (selection.has_value()) {
+        mark_dirty();
+    }
     return false;
 }
 
@@ -613,6 +832,7 @@ auto Pane::event(FocusEvent const& event) -> bool {
         terminal.invalidate_all();
         return di::Tuple { terminal.focus_event_mode() };
     });
+    mark_dirty();
 
     auto serialized_event = serialize_focus_event(event, focus_event_mode);
     if (serialized_event) {
@@ -622,22 +842,54 @@ auto Pane::event(FocusEvent const& event) -> bool {
     return false;
 }
 
-auto Pane::event(PasteEvent const& event) -> bool {
+auto Pane::event(PasteEvent&& event) -> bool {
     auto [bracketed_paste_mode] = m_terminal.with_lock([&](Terminal& terminal) {
         terminal.active_screen().screen.clear_selection();
         m_pending_selection_start = {};
         return di::Tuple { terminal.bracked_paste_mode() };
     });
-
-    auto serialized_event = serialize_paste_event(event, bracketed_paste_mode);
-    write_pty_string(serialized_event);
+    mark_dirty();
+
+    // The framing matches serialize_paste_event(), but is added by the output thread.
+    m_output_queue.with_lock([&](OutputQueue& queue) {
+        auto was_empty = queue.empty();
+        queue.pastes.push_back(PendingPaste {
+            .text = di::move(event).take_text(),
+            .bracketed = bracketed_paste_mode == BracketedPasteMode::Enabled,
+        });
+        if (was_empty) {
+            m_output_condition.notify_one();
+        }
+    });
     return true;
 }
 
+auto Pane::cancel_paste() -> bool {
+    return m_output_queue.with_lock([&](OutputQueue& queue) {
+        auto did_cancel = false;
+        for (auto& paste : queue.pastes) {
+            if (paste.offset == di::as_bytes(paste.text.span()).size()) {
+                continue;
+            }
+
+            // Drop the rest of the text. If the paste was never started, this also skips the framing
+            // since the output thread treats it as an empty paste.
+            if (!paste.started) {
+                paste.bracketed = false;
+            }
+            paste.text = {};
+            paste.offset = 0;
+            did_cancel = true;
+        }
+        return did_cancel;
+    });
+}
+
 void Pane::invalidate_all() {
     m_terminal.with_lock([&](Terminal& terminal) {
         terminal.invalidate_all();
     });
+    mark_dirty();
 }
 
 void Pane::resize(Size const& size) {
@@ -648,9 +900,7 @@ void Pane::resize(Size const& size) {
 
     // We need to request a re-render as we're using the render thread
     // to actualize the size update.
-    if (m_hooks.did_update) {
-        m_hooks.did_update(*this);
-    }
+    mark_dirty();
 }
 
 void Pane::scroll(Direction direction, i32 amount_in_cells) {
@@ -700,6 +950,7 @@ void Pane::scroll(Direction direction, i32 amount_in_cells) {
             }
         });
     }
+    mark_dirty();
 
     update_selection_after_scrolling();
 }
@@ -733,6 +984,7 @@ void Pane::scroll_to_top() {
         terminal.active_screen().screen.visual_scroll_to_top();
         m_vertical_scroll_offset = 0;
     });
+    mark_dirty();
     update_selection_after_scrolling();
 }
 
@@ -743,6 +995,7 @@ void Pane::scroll_to_bottom() {
             m_vertical_scroll_offset = terminal.row_count() - terminal.visible_size().rows;
         }
     });
+    mark_dirty();
     update_selection_after_scrolling();
 }
 
@@ -752,6 +1005,7 @@ void Pane::scroll_prev_command() {
     m_terminal.with_lock([&](Terminal& terminal) {
         terminal.active_screen().screen.visual_scroll_prev_command();
     });
+    mark_dirty();
 }
 
 void Pane::scroll_next_command() {
@@ -760,6 +1014,7 @@ void Pane::scroll_next_command() {
     m_terminal.with_lock([&](Terminal& terminal) {
         terminal.active_screen().screen.visual_scroll_next_command();
     });
+    mark_dirty();
 }
 
 void Pane::copy_last_command(bool include_command) {
@@ -788,20 +1043,29 @@ auto Pane::save_state(di::PathView path) -> di::Result<> {
 void Pane::send_clipboard(terminal::SelectionType selection_type, di::Vector<byte> data) {
     auto osc52 = terminal::OSC52 {};
     (void) osc52.selections.push_back(selection_type);
-    osc52.data = di::Base64<>(di::move(data));
 
-    auto string = osc52.serialize();
-    write_pty_string(string);
+    // Encode directly into the bytes written to the pty, as the reply can be as large as the clipboard.
+    auto bytes = di::Vector<byte> {};
+    bytes.append_container(di::as_bytes(di::format("\033]52;{};"_sv, osc52.serialize_selections()).span()));
+    base64_encode(data.span(), bytes);
+    bytes.append_container(di::as_bytes("\033\\"_sv.span()));
+    write_pty_bytes(bytes.span());
 }
 
 void Pane::stop_capture() {
-    m_capture.store(false, di::MemoryOrder::Release);
+    m_capture.with_lock([](di::Optional<CaptureWriter>& capture) {
+        if (capture) {
+            (void) capture->finish();
+            capture = {};
+        }
+    });
 }
 
 void Pane::soft_reset() {
     m_terminal.with_lock([&](Terminal& terminal) {
         terminal.soft_reset();
     });
+    mark_dirty();
 
     if (m_restore_termios) {
         m_restore_termios();
@@ -875,6 +1139,11 @@ void Pane::handle_terminal_event(TerminalEvent&& event) {
                   },
                   [&](Size&& size) {
                       (void) m_pty_controller.set_tty_window_size(size.as_window_size());
+                      m_capture.with_lock([&](di::Optional<CaptureWriter>& capture) {
+                          if (capture) {
+                              (void) capture->write_resize(size);
+                          }
+                      });
                   },
                   [&](WritePtyString&& write_command) {
                       write_pty_string(write_command.string);
@@ -883,18 +1152,26 @@ void Pane::handle_terminal_event(TerminalEvent&& event) {
 }
 
 void Pane::write_pty_string(di::StringView data) {
-    auto bytes = di::as_bytes(data.span()) | di::to<di::Vector>();
-    m_output_queue.with_lock([&](auto& queue) {
-        queue.push(di::move(bytes));
-        m_output_condition.notify_one();
-    });
+    write_pty_bytes(di::as_bytes(data.span()));
 }
 
 void Pane::write_pty_string(di::TransparentStringView data) {
-    auto bytes = di::as_bytes(data.span()) | di::to<di::Vector>();
-    m_output_queue.with_lock([&](auto& queue) {
-        queue.push(di::move(bytes));
-        m_output_condition.notify_one();
+    write_pty_bytes(di::as_bytes(data.span()));
+}
+
+void Pane::write_pty_bytes(di::Span<byte const> data) {
+    m_output_queue.with_lock([&](OutputQueue& queue) {
+        // Only wake the output thread when the queue was empty. Otherwise, it was already woken up and will
+        // write these bytes along with the rest.
+        auto was_empty = queue.empty();
+        if (auto paste = queue.pastes.back()) {
+            paste->trailing.append_container(data);
+        } else {
+            queue.bytes.append_container(data);
+        }
+        if (was_empty) {
+            m_output_condition.notify_one();
+        }
     });
 }
 
@@ -907,6 +1184,7 @@ void Pane::reset_viewport_scroll() {
     m_vertical_scroll_offset = m_horizontal_scroll_offset = 0;
     if (needs_invalidation) {
         m_terminal.with_lock(&Terminal::invalidate_all);
+        mark_dirty();
     }
 }
 
@@ -925,6 +1203,7 @@ auto Pane::seamless_navigate(terminal::OSC8671&& osc_8671) -> bool {
         }
         return active;
     });
+    mark_dirty();
     if (result) {
         auto message = osc_8671.serialize();
         write_pty_string(message);
@@ -939,6 +1218,7 @@ void Pane::update_local_palette(di::FunctionRef<void(terminal::Palette&)> update
         terminal.set_local_palette(palette);
         return terminal.outgoing_events();
     });
+    mark_dirty();
 
     for (auto&& event : events) {
         handle_terminal_event(di::move(event));
@@ -946,21 +1226,37 @@ void Pane::update_local_palette(di::FunctionRef<void(terminal::Palette&)> update
 }
 
 void Pane::set_global_palette(terminal::Palette const& palette) {
+    auto did_change = false;
     auto events = m_terminal.with_lock([&](Terminal& terminal) {
+        did_change = terminal.global_palette() != palette;
         terminal.set_global_palette(palette);
         return terminal.outgoing_events();
     });
+    if (did_change) {
+        mark_dirty();
+    }
 
     for (auto&& event : events) {
         handle_terminal_event(di::move(event));
     }
 }
 
+void Pane::set_max_clipboard_bytes(u32 max_clipboard_bytes) {
+    m_terminal.with_lock([&](Terminal& terminal) {
+        terminal.set_max_clipboard_size(max_clipboard_bytes);
+    });
+}
+
 void Pane::set_theme_mode(terminal::ThemeMode theme_mode) {
+    auto did_change = false;
     auto events = m_terminal.with_lock([&](Terminal& terminal) {
+        did_change = terminal.theme_mode() != theme_mode;
         terminal.set_theme_mode(theme_mode);
         return terminal.outgoing_events();
     });
+    if (did_change) {
+        mark_dirty();
+    }
 
     for (auto&& event : events) {
         handle_terminal_event(di::move(event));
@@ -0,0 +1,72 @@
+#include "ttx/pane_snapshot.h"
+
+#include "di/format/prelude.h"
+#include "dius/sync_file.h"
+
+namespace ttx {
+static auto snapshot_path(di::PathView directory, u64 pane_id, di::StringView extension) -> di::Path {
+    auto result = directory.to_owned();
+    result /= di::to_transparent_string(di::format("{}.{}"_sv, pane_id, extension));
+    return result;
+}
+
+auto PaneSnapshot::history_path(di::PathView directory, u64 pane_id) -> di::Path {
+    return snapshot_path(directory, pane_id, "history"_sv);
+}
+
+auto PaneSnapshot::screen_path(di::PathView directory, u64 pane_id) -> di::Path {
+    return snapshot_path(directory, pane_id, "screen"_sv);
+}
+
+auto PaneSnapshot::update(Terminal const& terminal) -> Update {
+    auto const& screen = terminal.primary_screen().screen;
+    auto row_start = screen.absolute_row_start();
+    auto row_end = screen.absolute_row_screen_start();
+
+    // The history must be replaced if it is missing rows (because they were dropped before being saved), or has rows
+    // which are no longer in the scroll back (because it was cleared or rows were pulled back onto the screen). Rows
+    // dropped because of the scroll back limit are tolerated until they outnumber the rows still in the scroll back.
+    auto result = Update {};
+    auto dropped_rows = di::max(row_start, m_history_row_start) - m_history_row_start;
+    auto retained_rows = m_history_row_end - di::min(row_start, m_history_row_end);
+    if (!m_saved || row_start > m_history_row_end || row_end < m_history_row_end || dropped_rows > retained_rows) {
+        result.replace_history = true;
+        m_saved = true;
+        m_history_row_start = row_start;
+        m_history_row_end = row_start;
+    }
+
+    result.history = screen.scroll_back_as_escape_sequences(m_history_row_end, row_end);
+    m_history_row_end = row_end;
+
+    // Reset the graphics rendition and hyperlink and move to the next line, so the contents are left untouched when
+    // the restored pane's shell starts writing.
+    auto contents = screen.state_as_escape_sequences(false);
+    contents += "\033[m\033]8;;\033\\\r\n"_sv;
+    if (result.replace_history || contents != m_screen) {
+        m_screen = contents.clone();
+        result.screen = di::move(contents);
+    }
+    return result;
+}
+
+auto PaneSnapshot::write(di::PathView directory, u64 pane_id, Update const& update) -> di::Result<> {
+    if (update.replace_history || !update.history.empty()) {
+        auto history = TRY(dius::open_sync(history_path(directory, pane_id),
+                                           update.replace_history ? dius::OpenMode::WriteClobber
+                                                                  : dius::OpenMode::AppendOnly));
+        TRY(history.write_exactly(di::as_bytes(update.history.span())));
+    }
+
+    if (update.screen) {
+        auto screen = TRY(dius::open_sync(screen_path(directory, pane_id), dius::OpenMode::WriteClobber));
+        TRY(screen.write_exactly(di::as_bytes(update.screen.value().span())));
+    }
+    return {};
+}
+
+void PaneSnapshot::clear(di::PathView directory, u64 pane_id) {
+    (void) dius::open_sync(history_path(directory, pane_id), dius::OpenMode::WriteClobber);
+    (void) dius::open_sync(screen_path(directory, pane_id), dius::OpenMode::WriteClobber);
+}
+}
@@ -506,6 +506,7 @@ auto Renderer::finish(dius::SyncFile& output, RenderedCursor const& cursor_in, d
         // No updates, so do nothing. Note that when seamless navigation is enabled we need to always draw the cursor
         // because we configured it to clear the cursor automatically when it navigates to us. Ideally, we'd only
         // clear the cursor state when receiving that specific event, but this works fine for now.
+        m_last_frame_bytes = 0;
         return {};
     }
 
@@ -640,6 +641,7 @@ auto Renderer::finish(dius::SyncFile& output, RenderedCursor const& cursor_in, d
     }
 
     auto text = di::move(buffer).vector();
+    m_last_frame_bytes = text.size();
     return output.write_exactly(di::as_bytes(text.span()));
 }
 
@@ -718,6 +720,61 @@ void Renderer::set_bound(u32 row, u32 col, u32 width, u32 height) {
     m_bound_height = height;
 }
 
+void Renderer::start_tile(Renderer const& parent, Size const& size, u32 dim_factor) {
+    if (m_desired_screen.size() != size) {
+        m_desired_screen.resize(size);
+        m_desired_screen.clear();
+        m_desired_screen.clear_damage_tracking();
+    }
+
+    m_features = parent.m_features;
+    m_global_palette = parent.m_global_palette;
+    m_local_palette = {};
+    m_outer_terminal_palette = parent.m_outer_terminal_palette;
+    m_dim_factor = dim_factor;
+    set_bound(0, 0, size.cols, size.rows);
+}
+
+void Renderer::compose_tile(Renderer& tile, u32 row, u32 col) {
+    // The palettes are borrowed from the parent, and so are only valid for the current frame.
+    auto _ = di::ScopeExit([&] {
+        tile.m_global_palette = {};
+        tile.m_outer_terminal_palette = {};
+    });
+
+    ASSERT_EQ(tile.m_desired_screen.absolute_row_start(), 0);
+    auto [_, row_group] = tile.m_desired_screen.find_row(0);
+    for (auto r : di::range(tile.m_desired_screen.size().rows)) {
+        if (row + r >= size().rows) {
+            break;
+        }
+
+        auto const& tile_row = row_group.rows()[r];
+        if (tile_row.stale) {
+            continue;
+        }
+
+        // The cells have already been resolved against the palette when drawn into the tile,
+        // so they are placed directly into the desired screen.
+        for (auto [c, cell, text, graphics, hyperlink, multi_cell_info] : row_group.iterate_row(r)) {
+            if (cell.stale || cell.is_nonprimary_in_multi_cell()) {
+                continue;
+            }
+            if (col + c + multi_cell_info.compute_width() > size().cols) {
+                break;
+            }
+
+            m_desired_screen.set_current_graphics_rendition(graphics);
+            m_desired_screen.set_cursor(row + r, col + c);
+            m_desired_screen.set_current_hyperlink(hyperlink);
+            m_desired_screen.put_cell(text, multi_cell_info, terminal::AutoWrapMode::Disabled, cell.explicitly_sized,
+                                      cell.complex_grapheme_cluster);
+            cell.stale = true;
+        }
+        tile_row.stale = true;
+    }
+}
+
 auto Renderer::resolve_rendition(terminal::GraphicsRendition const& rendition) const -> terminal::GraphicsRendition {
     auto result = rendition;
     if (m_global_palette || m_local_palette) {
@@ -0,0 +1,217 @@
+#include "ttx/replay.h"
+
+#include "di/parser/prelude.h"
+#include "dius/filesystem/operations.h"
+
+namespace ttx {
+auto ReplayReader::timing_path(di::PathView path) -> di::Path {
+    auto result = path.to_owned();
+    result += ".timing"_tsv;
+    return result;
+}
+
+// Read the keyframe index using the footer. Captures which weren't finished cleanly don't have one.
+static auto read_keyframe_index(dius::SyncFile const& file, di::PathView path) -> di::Vector<capture::Keyframe> {
+    auto file_size = dius::filesystem::file_size(path);
+    if (!file_size || *file_size < capture::header_magic.size_bytes() + capture::footer_size) {
+        return {};
+    }
+
+    auto read_at = [&](u64 position, di::Span<byte> buffer) {
+        auto nread = file.read_some(position, buffer);
+        return nread && *nread == buffer.size();
+    };
+
+    auto footer = di::Vector<byte> {};
+    footer.resize(capture::footer_size);
+    if (!read_at(*file_size - capture::footer_size, footer.span()) ||
+        !di::container::equal(footer | di::drop(8), di::as_bytes(capture::footer_magic.span()))) {
+        return {};
+    }
+
+    auto index_position = capture::read_u64(footer.span());
+    auto header = di::Vector<byte> {};
+    header.resize(capture::record_header_size);
+    if (!read_at(index_position, header.span()) ||
+        capture::RecordType(capture::read_u32(header.span())) != capture::RecordType::Index) {
+        return {};
+    }
+
+    auto payload = di::Vector<byte> {};
+    payload.resize(capture::read_u32(header.span().subspan(4).value()));
+    if (!read_at(index_position + capture::record_header_size, payload.span())) {
+        return {};
+    }
+
+    auto result = di::Vector<capture::Keyframe> {};
+    for (auto i = 0_usize; i + 16 <= payload.size(); i += 16) {
+        auto entry = payload.span().subspan(i).value();
+        result.push_back({ capture::read_u64(entry), capture::read_u64(entry.subspan(8).value()) });
+    }
+    return result;
+}
+
+auto ReplayReader::open(di::PathView path) -> di::Result<ReplayReader> {
+    auto file = TRY(dius::open_sync(path, dius::OpenMode::Readonly));
+
+    auto magic = di::Vector<byte> {};
+    magic.resize(capture::header_magic.size_bytes());
+    auto nread = file.read_some(0, magic.span());
+    if (nread && *nread == magic.size() && di::container::equal(magic, di::as_bytes(capture::header_magic.span()))) {
+        auto keyframes = read_keyframe_index(file, path);
+        return ReplayReader(di::move(file), true, {}, di::move(keyframes));
+    }
+
+    // The timing file is optional, as raw captures from other programs won't have one.
+    auto timing = di::Vector<di::Tuple<u64, usize>> {};
+    if (auto contents = dius::read_to_string(timing_path(path))) {
+        for (auto line : contents.value() | di::split(U'\n')) {
+            auto fields = line | di::split(U' ') | di::to<di::Vector>();
+            if (fields.size() != 2) {
+                continue;
+            }
+            auto offset_us = di::parse<u64>(fields[0]);
+            auto size = di::parse<usize>(fields[1]);
+            if (!offset_us || !size) {
+                // Each entry covers the bytes after the previous one, so skipping an entry would misplace all of
+                // the following ones. Fall back to an untimed replay instead.
+                timing.clear();
+                break;
+            }
+            timing.push_back({ offset_us.value(), size.value() });
+        }
+    }
+    return ReplayReader(di::move(file), false, di::move(timing));
+}
+
+ReplayReader::ReplayReader(dius::SyncFile file, bool container, di::Vector<di::Tuple<u64, usize>> timing,
+                           di::Vector<capture::Keyframe> keyframes)
+    : m_file(di::move(file))
+    , m_container(container)
+    , m_position(container ? capture::header_magic.size_bytes() : 0)
+    , m_timing(di::move(timing))
+    , m_keyframes(di::move(keyframes)) {}
+
+auto ReplayReader::seek(dius::SteadyClock::Duration offset) -> bool {
+    auto offset_us = u64(di::chrono::duration_cast<di::chrono::Microseconds>(offset).count());
+    auto keyframe = di::Optional<capture::Keyframe> {};
+    for (auto const& candidate : m_keyframes) {
+        if (candidate.offset_us > offset_us) {
+            break;
+        }
+        keyframe = candidate;
+    }
+    if (!keyframe) {
+        return false;
+    }
+
+    m_position = keyframe.value().file_position;
+    m_emit_keyframe = true;
+    m_pending.clear();
+    m_pending_offset = 0;
+    m_chunk_remaining = 0;
+    return true;
+}
+
+auto ReplayReader::read(di::Span<byte> buffer) -> di::Optional<ReplayChunk> {
+    if (m_container) {
+        return read_container(buffer);
+    }
+    return read_raw(buffer);
+}
+
+auto ReplayReader::read_exactly_at(u64 position, di::Span<byte> buffer) -> bool {
+    auto nread = m_file.read_some(position, buffer);
+    return nread && *nread == buffer.size();
+}
+
+auto ReplayReader::read_container(di::Span<byte> buffer) -> di::Optional<ReplayChunk> {
+    for (;;) {
+        // Return synthesized escape sequences first.
+        if (m_pending_offset < m_pending.size()) {
+            auto count = di::min(buffer.size(), m_pending.size() - m_pending_offset);
+            di::copy(m_pending | di::drop(m_pending_offset) | di::take(count), buffer.data());
+            m_pending_offset += count;
+            return ReplayChunk { count, m_chunk_offset };
+        }
+
+        // Then the rest of the current output record. Records larger than the buffer are returned in pieces.
+        if (m_chunk_remaining > 0) {
+            auto to_read = di::min(buffer.size(), m_chunk_remaining);
+            auto nread = m_file.read_some(m_position, buffer.subspan(0, to_read).value());
+            if (!nread || *nread == 0) {
+                return {};
+            }
+            m_position += *nread;
+            m_chunk_remaining -= *nread;
+            return ReplayChunk { *nread, m_chunk_offset };
+        }
+
+        auto header = di::Array<byte, capture::record_header_size> {};
+        if (!read_exactly_at(m_position, header.span())) {
+            return {};
+        }
+        auto type = capture::RecordType(capture::read_u32(header.span()));
+        auto size = capture::read_u32(header.span().subspan(4).value());
+        m_chunk_offset = di::Microseconds(capture::read_u64(header.span().subspan(8).value()));
+        m_position += capture::record_header_size;
+
+        switch (type) {
+            case capture::RecordType::Output:
+                m_chunk_remaining = size;
+                break;
+            case capture::RecordType::Resize: {
+                auto payload = di::Array<byte, 16> {};
+                if (size != payload.size() || !read_exactly_at(m_position, payload.span())) {
+                    return {};
+                }
+                auto rows = capture::read_u32(payload.span());
+                auto cols = capture::read_u32(payload.span().subspan(4).value());
+                auto xpixels = capture::read_u32(payload.span().subspan(8).value());
+                auto ypixels = capture::read_u32(payload.span().subspan(12).value());
+                auto string = di::format("\033[4;{};{}t\033[8;{};{}t"_sv, ypixels, xpixels, rows, cols);
+                m_pending = di::as_bytes(string.span()) | di::to<di::Vector>();
+                m_pending_offset = 0;
+                m_position += size;
+                break;
+            }
+            case capture::RecordType::Keyframe:
+                // Keyframes are only needed when starting playback from them.
+                if (m_emit_keyframe) {
+                    m_pending.resize(size);
+                    if (!read_exactly_at(m_position, m_pending.span())) {
+                        return {};
+                    }
+                    m_pending_offset = 0;
+                    m_emit_keyframe = false;
+                }
+                m_position += size;
+                break;
+            case capture::RecordType::Index:
+                return {};
+            default:
+                // Skip unknown records, to allow adding new record types.
+                m_position += size;
+                break;
+        }
+    }
+}
+
+auto ReplayReader::read_raw(di::Span<byte> buffer) -> di::Optional<ReplayChunk> {
+    // Advance to the next timed chunk. Chunks larger than the buffer are returned in pieces with the same offset.
+    // Any output which isn't covered by the timing file is returned with the last chunk's offset.
+    if (m_chunk_remaining == 0 && m_timing_index < m_timing.size()) {
+        auto [offset_us, size] = m_timing[m_timing_index++];
+        m_chunk_remaining = size;
+        m_chunk_offset = di::Microseconds(offset_us);
+    }
+
+    auto to_read = m_chunk_remaining > 0 ? di::min(buffer.size(), m_chunk_remaining) : buffer.size();
+    auto nread = m_file.read_some(buffer.subspan(0, to_read).value());
+    if (!nread || *nread == 0) {
+        return {};
+    }
+    m_chunk_remaining -= di::min(m_chunk_remaining, *nread);
+    return ReplayChunk { *nread, m_chunk_offset };
+}
+}
@@ -0,0 +1,82 @@
+#include "ttx/stats.h"
+
+namespace ttx {
+auto elapsed_ns(dius::SteadyClock::TimePoint start, dius::SteadyClock::TimePoint end) -> u64 {
+    if (end < start) {
+        return 0;
+    }
+    return u64(di::chrono::duration_cast<di::chrono::Nanoseconds>(end - start).count());
+}
+
+void StatHistogram::record(u64 value) {
+    // Bucket i holds values in the range [2^(i-1), 2^i), with bucket 0 holding only 0.
+    auto bucket = value == 0 ? 0_usize : usize(64 - __builtin_clzll(value));
+    m_buckets[bucket].add(1);
+    m_count.add(1);
+    m_sum.add(value);
+}
+
+auto StatHistogram::percentile(u32 percent) const -> u64 {
+    auto total = count();
+    if (total == 0) {
+        return 0;
+    }
+
+    // Find the first bucket where the cumulative count reaches the target rank.
+    auto target = di::max(di::divide_round_up(total * di::min(percent, 100_u32), 100_u64), 1_u64);
+    auto seen = 0_u64;
+    for (auto [i, bucket] : m_buckets | di::enumerate) {
+        seen += bucket.value();
+        if (seen >= target) {
+            return i == 0 ? 0 : (i >= 64 ? di::NumericLimits<u64>::max : (1_u64 << i) - 1);
+        }
+    }
+    return di::NumericLimits<u64>::max;
+}
+
+static auto since_epoch_ns(dius::SteadyClock::TimePoint time) -> u64 {
+    return elapsed_ns(dius::SteadyClock::TimePoint {}, time);
+}
+
+static auto elapsed_since_ns(u64 start_ns, dius::SteadyClock::TimePoint end) -> u64 {
+    auto end_ns = since_epoch_ns(end);
+    return end_ns > start_ns ? end_ns - start_ns : 0;
+}
+
+// Move a key press to the next stage, unless an older key press is already waiting there.
+static void advance_stage(di::Atomic<u64>& stage, u64 received_ns) {
+    if (stage.load(di::MemoryOrder::Relaxed) == 0) {
+        stage.store(received_ns, di::MemoryOrder::Relaxed);
+    }
+}
+
+void InputLatency::did_write_input(dius::SteadyClock::TimePoint received, dius::SteadyClock::TimePoint written) {
+    m_input_to_write_ns.record(elapsed_ns(received, written));
+    advance_stage(m_awaiting_output, di::max(since_epoch_ns(received), 1_u64));
+}
+
+void InputLatency::did_process_output(dius::SteadyClock::TimePoint now) {
+    auto received_ns = m_awaiting_output.exchange(0, di::MemoryOrder::Relaxed);
+    if (received_ns == 0) {
+        return;
+    }
+    m_input_to_output_ns.record(elapsed_since_ns(received_ns, now));
+    advance_stage(m_awaiting_draw, received_ns);
+}
+
+void InputLatency::will_draw() {
+    auto received_ns = m_awaiting_draw.exchange(0, di::MemoryOrder::Relaxed);
+    if (received_ns == 0) {
+        return;
+    }
+    advance_stage(m_awaiting_frame, received_ns);
+}
+
+void InputLatency::did_present_frame(dius::SteadyClock::TimePoint now) {
+    auto received_ns = m_awaiting_frame.exchange(0, di::MemoryOrder::Relaxed);
+    if (received_ns == 0) {
+        return;
+    }
+    m_input_to_frame_ns.record(elapsed_since_ns(received_ns, now));
+}
+}
@@ -40,13 +40,55 @@ Terminal::Terminal(u64 id, Size const& size, terminal::Palette const& global_pal
     , m_global_palette(global_palette) {}
 
 void Terminal::on_parser_results(di::Span<ParserResult> results) {
-    for (auto& result : results) {
+    while (!results.empty()) {
+        if (auto consumed = batch_line_feeds(results); consumed > 0) {
+            results = results.subspan(consumed).value();
+            continue;
+        }
+
         di::visit(
             [&](auto& r) {
                 this->on_parser_result(di::move(r));
             },
-            result);
+            results[0]);
+        results = results.subspan(1).value();
+    }
+}
+
+auto Terminal::batch_line_feeds(di::Span<ParserResult> results) -> usize {
+    auto is_control_character = [](ParserResult const& result, c32 code_point) {
+        auto control = di::get_if<ControlCharacter>(result);
+        return control && control.value().code_point == code_point;
+    };
+
+    // Only line feeds which happen at the bottom of the scroll region will scroll the screen.
+    if (!is_control_character(results[0], '\n') ||
+        cursor_row() + 1 != active_screen().screen.scroll_region().end_row) {
+        return 0;
+    }
+
+    // Consume a run of line feeds and carriage returns. Carriage returns are included because
+    // output typically uses "\r\n" line endings. Since scrolling doesn't affect the cursor column,
+    // performing the carriage return up front yields the same result as interleaving it.
+    auto line_feeds = 0_u32;
+    auto carriage_return = false;
+    auto consumed = 0_usize;
+    for (auto const& result : results) {
+        if (is_control_character(result, '\n')) {
+            line_feeds++;
+        } else if (is_control_character(result, '\r')) {
+            carriage_return = true;
+        } else {
+            break;
+        }
+        consumed++;
+    }
+
+    if (carriage_return) {
+        c0_cr();
     }
+    active_screen().screen.scroll_down(line_feeds);
+    return consumed;
 }
 
 void Terminal::on_parser_result(PrintableCharacter&& printable_character) {
@@ -674,7 +716,7 @@ void Terminal::osc_21(di::StringView data) {
 
 // OSC 52 - https://invisible-island.net/xterm/ctlseqs/ctlseqs.html#h3-Operating-System-Commands
 void Terminal::osc_52(di::StringView data) {
-    auto osc52 = terminal::OSC52::parse(data);
+    auto osc52 = terminal::OSC52::parse(data, m_max_clipboard_size);
     if (!osc52) {
         return;
     }
@@ -1404,7 +1446,7 @@ void Terminal::soft_reset() {
     resize(visible_size());
 }
 
-auto Terminal::state_as_escape_sequences() const -> di::String {
+auto Terminal::state_as_escape_sequences(bool include_scroll_back) const -> di::String {
     auto writer = di::VectorWriter<> {};
 
     // 1. Reset terminal
@@ -1435,7 +1477,8 @@ auto Terminal::state_as_escape_sequences() const -> di::String {
         di::writer_print<di::String::Encoding>(writer, "\033[?7h"_sv);
 
         auto print_screen = [&](ScreenState const& screen) {
-            di::writer_print<di::String::Encoding>(writer, "{}"_sv, screen.screen.state_as_escape_sequences());
+            di::writer_print<di::String::Encoding>(writer, "{}"_sv,
+                                                   screen.screen.state_as_escape_sequences(include_scroll_back));
             di::writer_print<di::String::Encoding>(writer, "\033[{} q"_sv, i32(screen.cursor_style));
         };
 
@@ -5,6 +5,7 @@
 #include "di/container/algorithm/sort.h"
 #include "di/container/algorithm/unique.h"
 #include "di/format/prelude.h"
+#include "terminfo_names.h"
 #include "ttx/terminal/escapes/terminfo_string.h"
 
 namespace ttx::terminal {
@@ -40,6 +41,294 @@ auto Terminfo::serialize() const -> di::String {
     return result;
 }
 
+namespace compiled {
+    // The magic numbers for the legacy format, which stores numbers as 16 bits, and the extended
+    // number format, which stores numbers as 32 bits. The extended format is only understood by
+    // ncurses 6.1 and later, so its only used when required.
+    constexpr auto legacy_magic = u32(0432);
+    constexpr auto extended_number_magic = u32(01036);
+
+    constexpr auto absent = u32(-1);
+
+    static void append_integer(di::Vector<byte>& output, u64 value, usize size) {
+        for (auto i : di::range(size)) {
+            output.push_back(byte(value >> (8 * i)));
+        }
+    }
+
+    static void append_string(di::Vector<byte>& output, di::TransparentStringView string) {
+        for (auto c : string) {
+            output.push_back(byte(c));
+        }
+        output.push_back(byte(0));
+    }
+
+    static void align(di::Vector<byte>& output) {
+        if (output.size() % 2 != 0) {
+            output.push_back(byte(0));
+        }
+    }
+
+    static auto standard_index(di::Span<di::TransparentStringView const> names, di::TransparentStringView name)
+        -> di::Optional<usize> {
+        auto const* it = di::find(names, name);
+        if (it == names.end()) {
+            return {};
+        }
+        return usize(it - names.begin());
+    }
+
+    // Translate the escapes used in the terminfo source format into the actual bytes. This follows
+    // the rules used by tic, including storing NUL bytes as \200 since strings are NUL terminated.
+    static auto unescape(di::TransparentStringView value) -> di::TransparentString {
+        auto result = ""_ts;
+        auto const bytes = value.span();
+        for (auto i = 0_usize; i < bytes.size(); i++) {
+            auto c = u8(bytes[i]);
+            if (c == '^' && i + 1 < bytes.size()) {
+                c = u8(bytes[++i]);
+                if (c == '?') {
+                    result.push_back(char(0x7f));
+                } else {
+                    c &= 0x1f;
+                    result.push_back(char(c == 0 ? 0x80 : c));
+                }
+            } else if (c == '\\' && i + 1 < bytes.size()) {
+                c = u8(bytes[++i]);
+                if (c >= '0' && c <= '7') {
+                    auto number = u32(c - '0');
+                    for (auto j = 0; j < 2 && i + 1 < bytes.size() && bytes[i + 1] >= '0' && bytes[i + 1] <= '7';
+                         j++) {
+                        number = number * 8 + u32(bytes[++i] - '0');
+                    }
+                    number &= 0xff;
+                    result.push_back(char(number == 0 ? 0x80 : number));
+                    continue;
+                }
+                switch (c) {
+                    case 'E':
+                    case 'e':
+                        result.push_back('\x1b');
+                        break;
+                    case 'n':
+                    case 'l':
+                        result.push_back('\n');
+                        break;
+                    case 'r':
+                        result.push_back('\r');
+                        break;
+                    case 't':
+                        result.push_back('\t');
+                        break;
+                    case 'b':
+                        result.push_back('\b');
+                        break;
+                    case 'f':
+                        result.push_back('\f');
+                        break;
+                    case 's':
+                        result.push_back(' ');
+                        break;
+                    case 'a':
+                        result.push_back('\a');
+                        break;
+                    default:
+                        // Escaped backslashes, carets, commas, and colons are the character itself.
+                        result.push_back(char(c));
+                        break;
+                }
+            } else {
+                result.push_back(char(c));
+            }
+        }
+        return result;
+    }
+}
+
+auto Terminfo::compile() const -> di::Vector<byte> {
+    using namespace compiled;
+
+    // Standard capabilities are stored at a fixed index, while extended capabilities are stored with
+    // their names. Like tic, extended capabilities are sorted by name.
+    auto booleans = di::Array<bool, terminfo_boolean_names.size()> {};
+    auto numbers = di::Array<u32, terminfo_number_names.size()> {};
+    auto strings = di::Array<di::Optional<di::TransparentString>, terminfo_string_names.size()> {};
+    for (auto& number : numbers) {
+        number = absent;
+    }
+    auto boolean_count = 0_usize;
+    auto number_count = 0_usize;
+    auto string_count = 0_usize;
+    auto extended_booleans = di::Vector<di::TransparentStringView> {};
+    auto extended_numbers = di::Vector<di::Tuple<di::TransparentStringView, u32>> {};
+    auto extended_strings = di::Vector<di::Tuple<di::TransparentStringView, di::TransparentString>> {};
+    for (auto const& capability : capabilities | di::filter(&Capability::enabled)) {
+        auto name = capability.short_name;
+        di::visit(di::overload(
+                      [&](di::Void) {
+                          if (auto index = standard_index(terminfo_boolean_names.span(), name)) {
+                              booleans[*index] = true;
+                              boolean_count = di::max(boolean_count, *index + 1);
+                          } else {
+                              extended_booleans.push_back(name);
+                          }
+                      },
+                      [&](u32 value) {
+                          if (auto index = standard_index(terminfo_number_names.span(), name)) {
+                              numbers[*index] = value;
+                              number_count = di::max(number_count, *index + 1);
+                          } else {
+                              extended_numbers.push_back({ name, value });
+                          }
+                      },
+                      [&](di::TransparentStringView value) {
+                          if (auto index = standard_index(terminfo_string_names.span(), name)) {
+                              strings[*index] = unescape(value);
+                              string_count = di::max(string_count, *index + 1);
+                          } else {
+                              extended_strings.push_back({ name, unescape(value) });
+                          }
+                      }),
+                  capability.value);
+    }
+    auto by_name = [](auto const& entry) -> di::TransparentStringView {
+        return di::get<0>(entry);
+    };
+    di::sort(extended_booleans);
+    di::sort(extended_numbers, di::compare, by_name);
+    di::sort(extended_strings, di::compare, by_name);
+
+    auto wide_numbers = false;
+    for (auto value : numbers | di::take(number_count)) {
+        wide_numbers |= value != absent && value > 0x7fff;
+    }
+    for (auto const& [_, value] : extended_numbers) {
+        wide_numbers |= value > 0x7fff;
+    }
+    auto const number_size = wide_numbers ? 4_usize : 2_usize;
+
+    // Header, which is followed by the names, booleans, numbers, and strings.
+    auto names_size = 0_usize;
+    for (auto name : names) {
+        names_size += name.size_bytes() + 1;
+    }
+    auto string_table_size = 0_usize;
+    for (auto const& string : strings | di::take(string_count)) {
+        if (string) {
+            string_table_size += string->size_bytes() + 1;
+        }
+    }
+
+    auto output = di::Vector<byte> {};
+    append_integer(output, wide_numbers ? extended_number_magic : legacy_magic, 2);
+    append_integer(output, names_size, 2);
+    append_integer(output, boolean_count, 2);
+    append_integer(output, number_count, 2);
+    append_integer(output, string_count, 2);
+    append_integer(output, string_table_size, 2);
+
+    for (auto [i, name] : di::enumerate(names)) {
+        if (i > 0) {
+            output.push_back(byte('|'));
+        }
+        for (auto c : name) {
+            output.push_back(byte(c));
+        }
+    }
+    output.push_back(byte(0));
+    for (auto value : booleans | di::take(boolean_count)) {
+        output.push_back(byte(value));
+    }
+    align(output);
+    for (auto value : numbers | di::take(number_count)) {
+        append_integer(output, value, number_size);
+    }
+    auto offset = 0_usize;
+    for (auto const& string : strings | di::take(string_count)) {
+        if (!string) {
+            append_integer(output, absent, 2);
+            continue;
+        }
+        append_integer(output, offset, 2);
+        offset += string->size_bytes() + 1;
+    }
+    for (auto const& string : strings | di::take(string_count)) {
+        if (string) {
+            append_string(output, string.value());
+        }
+    }
+
+    // Extended capabilities. The header is followed by the booleans, numbers, and the offsets of the
+    // string values and then of all the names. The offsets of the names are relative to the end of
+    // the string values.
+    auto extended_names_count = extended_booleans.size() + extended_numbers.size() + extended_strings.size();
+    if (extended_names_count == 0) {
+        return output;
+    }
+    align(output);
+
+    auto extended_table_size = 0_usize;
+    for (auto const& [_, value] : extended_strings) {
+        extended_table_size += value.size_bytes() + 1;
+    }
+    for (auto name : extended_booleans) {
+        extended_table_size += name.size_bytes() + 1;
+    }
+    for (auto const& [name, _] : extended_numbers) {
+        extended_table_size += name.size_bytes() + 1;
+    }
+    for (auto const& [name, _] : extended_strings) {
+        extended_table_size += name.size_bytes() + 1;
+    }
+
+    append_integer(output, extended_booleans.size(), 2);
+    append_integer(output, extended_numbers.size(), 2);
+    append_integer(output, extended_strings.size(), 2);
+    append_integer(output, extended_strings.size() + extended_names_count, 2);
+    append_integer(output, extended_table_size, 2);
+
+    for (auto _ : extended_booleans) {
+        output.push_back(byte(true));
+    }
+    align(output);
+    for (auto const& [_, value] : extended_numbers) {
+        append_integer(output, value, number_size);
+    }
+    offset = 0;
+    for (auto const& [_, value] : extended_strings) {
+        append_integer(output, offset, 2);
+        offset += value.size_bytes() + 1;
+    }
+    offset = 0;
+    auto append_name_offset = [&](di::TransparentStringView name) {
+        append_integer(output, offset, 2);
+        offset += name.size_bytes() + 1;
+    };
+    for (auto name : extended_booleans) {
+        append_name_offset(name);
+    }
+    for (auto const& [name, _] : extended_numbers) {
+        append_name_offset(name);
+    }
+    for (auto const& [name, _] : extended_strings) {
+        append_name_offset(name);
+    }
+
+    for (auto const& [_, value] : extended_strings) {
+        append_string(output, value);
+    }
+    for (auto name : extended_booleans) {
+        append_string(output, name);
+    }
+    for (auto const& [name, _] : extended_numbers) {
+        append_string(output, name);
+    }
+    for (auto const& [name, _] : extended_strings) {
+        append_string(output, name);
+    }
+    return output;
+}
+
 auto get_ttx_terminfo() -> Terminfo const& {
     return ttx_terminfo;
 }
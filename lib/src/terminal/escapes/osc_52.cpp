@@ -1,6 +1,7 @@
 #include "ttx/terminal/escapes/osc_52.h"
 
 #include "di/format/prelude.h"
+#include "ttx/base64.h"
 
 namespace ttx::terminal {
 constexpr auto selection_mapping = di::Array {
@@ -12,7 +13,7 @@ constexpr auto selection_mapping = di::Array {
     di::Tuple { SelectionType::_7, U'7' },
 };
 
-auto OSC52::parse(di::StringView data) -> di::Optional<OSC52> {
+auto OSC52::parse(di::StringView data, usize max_size) -> di::Optional<OSC52> {
     auto semicolon = data.find(U';');
     if (!semicolon) {
         return {};
@@ -45,14 +46,20 @@ auto OSC52::parse(di::StringView data) -> di::Optional<OSC52> {
         return result;
     }
 
+    // Every 4 base64 characters encode 3 bytes, which bounds the decoded size without decoding anything.
+    if (auto size = data.size_bytes() / 4 * 3; max_size != 0 && size > max_size) {
+        result.oversized = size;
+        return result;
+    }
+
     // Xterm spec says that invalid base64 strings will result in clearing
     // the selection, instead of ignoring. Which is weird, but we'll do what
     // it says.
-    result.data = di::parse<di::Base64<>>(data).value_or(di::Base64<>());
+    result.data = di::Base64<>(base64_decode(di::as_bytes(data.span())).value_or(di::Vector<byte> {}));
     return result;
 }
 
-auto OSC52::serialize() const -> di::String {
+auto OSC52::serialize_selections() const -> di::String {
     auto selection = "c"_s;
     if (!selections.empty()) {
         selection = selections | di::transform([](SelectionType type) -> c32 {
@@ -65,9 +72,19 @@ auto OSC52::serialize() const -> di::String {
                     }) |
                     di::to<di::String>();
     }
+    return selection;
+}
+
+auto OSC52::serialize() const -> di::String {
+    auto selection = serialize_selections();
     if (query) {
         return di::format("\033]52;{};?\033\\"_sv, selection);
     }
-    return di::format("\033]52;{};{}\033\\"_sv, selection, data);
+
+    auto result = di::Vector<byte> {};
+    result.append_container(di::as_bytes(di::format("\033]52;{};"_sv, selection).span()));
+    base64_encode(data.container().span(), result);
+    result.append_container(di::as_bytes("\033\\"_sv.span()));
+    return result | di::transform(di::construct<c8>) | di::to<di::String>(di::encoding::assume_valid);
 }
 }
@@ -1,6 +1,7 @@
 #include "ttx/terminal/row_group.h"
 
 #include "di/container/algorithm/find_last_if_not.h"
+#include "di/container/tree/tree_map.h"
 #include "ttx/terminal/cell.h"
 #include "ttx/terminal/multi_cell_info.h"
 #include "ttx/terminal/reflow_result.h"
@@ -206,6 +207,59 @@ auto RowGroup::multi_cell_info(u16 id) const -> MultiCellInfo const& {
     return m_multi_cell_info.lookup_id(id);
 }
 
+// Translates the ids of one IdMap into another over the course of a single transfer. Adjacent cells almost
+// always share the same ids, so the most recent translation is cached. Reference count updates are deferred
+// until the transfer completes, which means each distinct id costs a fixed number of map operations instead
+// of several map operations per cell.
+struct TransferIdTranslation {
+    struct Entry {
+        u16 to_id { 0 };
+        u32 count { 0 };
+    };
+
+    template<typename Allocate>
+    auto translate(u16 from_id, Allocate&& allocate) -> u16 {
+        if (last_entry && last_from_id == from_id) {
+            last_entry->count++;
+            return last_entry->to_id;
+        }
+
+        auto it = entries.find(from_id);
+        if (it == entries.end()) {
+            entries.insert_or_assign(from_id, Entry { allocate(), 0 });
+            it = entries.find(from_id);
+        }
+
+        auto& entry = di::get<1>(*it);
+        entry.count++;
+        last_from_id = from_id;
+        last_entry = &entry;
+        return entry.to_id;
+    }
+
+    // The destination already holds 1 reference from allocating the id, and the source must release
+    // a reference for every cell which was transferred.
+    template<typename T>
+    void finish(IdMap<T>& from, IdMap<T>& to) {
+        for (auto const& [from_id, entry] : entries) {
+            if (entry.to_id && entry.count > 1) {
+                to.use_id(entry.to_id, entry.count - 1);
+            }
+            from.drop_id(from_id, entry.count);
+        }
+    }
+
+    di::TreeMap<u16, Entry> entries;
+    u16 last_from_id { 0 };
+    Entry* last_entry { nullptr };
+};
+
+// Cells which don't reference any id can be copied directly.
+static auto has_default_attributes(Cell const& cell) -> bool {
+    return (!cell.has_ids() || (cell.ids.graphics_rendition_id == 0 && cell.ids.hyperlink_id == 0)) &&
+           cell.multi_cell_id <= 1;
+}
+
 auto RowGroup::transfer_from(RowGroup& from, usize from_index, usize to_index, usize row_count,
                              di::Optional<u32> desired_cols) -> usize {
     auto& to = *this;
@@ -222,11 +276,14 @@ auto RowGroup::transfer_from(RowGroup& from, usize from_index, usize to_index, u
     auto to_begin = to.rows().iterator(to_index);
     auto to_end = to_begin + isize(row_count);
 
+    auto graphics_translation = TransferIdTranslation {};
+    auto hyperlink_translation = TransferIdTranslation {};
+    auto multi_cell_translation = TransferIdTranslation {};
+
     auto total_cells = 0_usize;
     for (auto [from_row, to_row] : di::zip(di::View(from_begin, from_end), di::View(to_begin, to_end))) {
         auto cols_to_take = desired_cols.value_or(from_row.cells.size());
         total_cells += cols_to_take > 0 ? cols_to_take : 1; // Consider empty rows to have 1 cell.
-        to_row.cells.resize(cols_to_take);
 
         // Truncate any wide cells if they won't fully fit into the requested column size.
         auto from_cells_to_take = di::min(cols_to_take, u32(from_row.cells.size()));
@@ -243,33 +300,40 @@ auto RowGroup::transfer_from(RowGroup& from, usize from_index, usize to_index, u
             }
         }
 
+        // Copy the cells over directly, and then fix up any ids. The cells in `from` don't need to be cleared,
+        // since the entire row is deleted later. The associated text is also handled separately.
+        auto from_cells = from_row.cells.subspan(0, from_cells_to_take).value();
+        to_row.cells.append_container(from_cells);
+        to_row.cells.resize(cols_to_take);
+
         auto text_size = 0_usize;
-        for (auto [i, cells] : di::zip(from_row.cells | di::take(from_cells_to_take), to_row.cells) | di::enumerate) {
-            // Insert the new cell as desired.
-            auto& [from_cell, to_cell] = cells;
-            if (i < cols_to_take) {
-                to_cell = from_cell;
-                if (from_cell.has_ids()) {
-                    if (from_cell.ids.graphics_rendition_id) {
-                        to_cell.ids.graphics_rendition_id =
-                            to.maybe_allocate_graphics_id(from.graphics_rendition(from_cell.ids.graphics_rendition_id))
+        for (auto [from_cell, to_cell] : di::zip(from_cells, to_row.cells)) {
+            text_size += from_cell.text_size;
+            if (has_default_attributes(from_cell)) {
+                continue;
+            }
+
+            if (from_cell.has_ids()) {
+                if (from_cell.ids.graphics_rendition_id) {
+                    to_cell.ids.graphics_rendition_id =
+                        graphics_translation.translate(from_cell.ids.graphics_rendition_id, [&] {
+                            return to
+                                .maybe_allocate_graphics_id(
+                                    from.graphics_rendition(from_cell.ids.graphics_rendition_id))
                                 .value_or(0);
-                    }
-                    if (from_cell.ids.hyperlink_id) {
-                        to_cell.ids.hyperlink_id =
-                            to.maybe_allocate_hyperlink_id(from.hyperlink(from_cell.ids.hyperlink_id)).value_or(0);
-                    }
+                        });
                 }
-                if (from_cell.multi_cell_id) {
-                    to_cell.multi_cell_id =
-                        to.maybe_allocate_multi_cell_id(from.multi_cell_info(from_cell.multi_cell_id)).value_or(0);
+                if (from_cell.ids.hyperlink_id) {
+                    to_cell.ids.hyperlink_id = hyperlink_translation.translate(from_cell.ids.hyperlink_id, [&] {
+                        return to.maybe_allocate_hyperlink_id(from.hyperlink(from_cell.ids.hyperlink_id)).value_or(0);
+                    });
                 }
             }
-
-            // Always drop the cell `from` cell. We don't have to worry about clearing the associated text since the
-            // entire row is deleted later.
-            text_size += from_cell.text_size;
-            from.drop_cell(from_cell);
+            if (from_cell.multi_cell_id > 1) {
+                to_cell.multi_cell_id = multi_cell_translation.translate(from_cell.multi_cell_id, [&] {
+                    return to.maybe_allocate_multi_cell_id(from.multi_cell_info(from_cell.multi_cell_id)).value_or(0);
+                });
+            }
         }
 
         // Copy over row attributes (overflow flag and text). Text is moved over to prevent
@@ -281,6 +345,11 @@ auto RowGroup::transfer_from(RowGroup& from, usize from_index, usize to_index, u
         to_row.text.erase(text_end.value(), to_row.text.end());
     }
 
+    // Now that all cells have been transferred, apply the reference count updates.
+    graphics_translation.finish(from.m_graphics_renditions, to.m_graphics_renditions);
+    hyperlink_translation.finish(from.m_hyperlinks, to.m_hyperlinks);
+    multi_cell_translation.finish(from.m_multi_cell_info, to.m_multi_cell_info);
+
     // Erase all desired rows in `from`.
     from.rows().erase(from_begin, from_end);
 
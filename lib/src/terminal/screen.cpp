@@ -746,38 +746,54 @@ void Screen::erase_characters(u32 n) {
     m_cursor.text_offset = text_start_position;
 }
 
-void Screen::scroll_down() {
+void Screen::scroll_down(u32 count) {
     ASSERT_EQ(m_cursor.row + 1, m_scroll_region.end_row);
 
-    // Clear the first row, optionally putting it into the scroll back buffer.
-    if (m_scroll_back_enabled == ScrollBackEnabled::Yes) {
-        auto was_at_bottom = visual_scroll_at_bottom();
-        m_scroll_back.add_rows(m_active_rows, m_scroll_region.start_row, 1);
+    // Scrolling more than the height of the scroll region is done in chunks, since
+    // each chunk can only move rows which are inside the region.
+    auto region_height = m_scroll_region.end_row - m_scroll_region.start_row;
+    while (count > 0) {
+        auto to_scroll = di::min(count, region_height);
+        count -= to_scroll;
 
-        // Insert the new row.
-        auto row = m_active_rows.rows().emplace(m_active_rows.rows().iterator(m_scroll_region.end_row - 1));
-        row->cells.resize(max_width(), blank_cell());
+        // Clear the first rows, optionally putting them into the scroll back buffer.
+        if (m_scroll_back_enabled == ScrollBackEnabled::Yes) {
+            auto was_at_bottom = visual_scroll_at_bottom();
+            m_scroll_back.add_rows(m_active_rows, m_scroll_region.start_row, to_scroll);
+
+            // Insert the new rows.
+            for (auto _ : di::range(to_scroll)) {
+                auto row =
+                    m_active_rows.rows().emplace(m_active_rows.rows().iterator(m_scroll_region.end_row - to_scroll));
+                row->cells.resize(max_width(), blank_cell());
+            }
 
-        if (was_at_bottom) {
-            // Automatically scroll to the bottom if the screen isn't already scrolled.
-            m_visual_scroll_offset = absolute_row_screen_start();
-        } else if (m_visual_scroll_offset < absolute_row_start()) {
-            // Adjust the visual scroll offset to be in bounds, if needed.
-            m_visual_scroll_offset = absolute_row_start();
+            if (was_at_bottom) {
+                // Automatically scroll to the bottom if the screen isn't already scrolled.
+                m_visual_scroll_offset = absolute_row_screen_start();
+            } else if (m_visual_scroll_offset < absolute_row_start()) {
+                // Adjust the visual scroll offset to be in bounds, if needed.
+                m_visual_scroll_offset = absolute_row_start();
+            }
+        } else {
+            auto clear_end = begin_row_iterator() + to_scroll;
+            for (auto& row : di::View(begin_row_iterator(), clear_end)) {
+                for (auto& cell : row.cells) {
+                    clear_cell(cell);
+                    cell.text_size = 0;
+                }
+                row.text.clear();
+                row.overflow = false;
+            }
+
+            // Rotate rows into place.
+            di::rotate(begin_row_iterator(), clear_end, end_row_iterator());
         }
+    }
+
+    if (m_scroll_back_enabled == ScrollBackEnabled::Yes) {
         clamp_selection();
         clamp_semantic_prompts();
-    } else {
-        auto& row = *begin_row_iterator();
-        for (auto& cell : row.cells) {
-            clear_cell(cell);
-            cell.text_size = 0;
-        }
-        row.text.clear();
-        row.overflow = false;
-
-        // Rotate rows into place.
-        di::rotate(begin_row_iterator(), begin_row_iterator() + 1, end_row_iterator());
     }
 
     m_cursor.text_offset = 0;
@@ -1709,38 +1725,32 @@ auto Screen::find_row(u64 row) const -> di::Tuple<u32, RowGroup const&> {
     return m_scroll_back.find_row(row);
 }
 
-// NOLINTNEXTLINE(readability-function-cognitive-complexity)
-auto Screen::state_as_escape_sequences() const -> di::String {
-    auto writer = di::VectorWriter<> {};
-
-    auto write_hyperlink = [&](di::Optional<Hyperlink const&> hyperlink) {
-        if (!hyperlink) {
-            di::writer_print<di::String::Encoding>(writer, "{}"_sv, OSC8::from_hyperlink(hyperlink).serialize());
-            return;
-        }
-
-        // To ensure the escape sequence representation is a fixed point, we need to strip our fixed prefix from the
-        // hyperlink id.
-        auto prefix = hyperlink.value().id.find(U'-');
-        ASSERT(prefix);
-        auto new_id = hyperlink.value().id.substr(prefix.end());
-        auto new_hyperlink = Hyperlink { .uri = di::clone(hyperlink.value().uri), .id = new_id.to_owned() };
-        di::writer_print<di::String::Encoding>(writer, "{}"_sv, OSC8::from_hyperlink(new_hyperlink).serialize());
-    };
-
-    // 1. Set default margins
-    di::writer_print<di::String::Encoding>(writer, "\033[r"_sv);
-
-    // 2. Set origin mode
-    if (m_origin_mode == OriginMode::Enabled) {
-        di::writer_print<di::String::Encoding>(writer, "\033[?6h"_sv);
+static void write_hyperlink(di::VectorWriter<>& writer, di::Optional<Hyperlink const&> hyperlink) {
+    if (!hyperlink) {
+        di::writer_print<di::String::Encoding>(writer, "{}"_sv, OSC8::from_hyperlink(hyperlink).serialize());
+        return;
     }
 
-    // 3. Screen contents
+    // To ensure the escape sequence representation is a fixed point, we need to strip our fixed prefix from the
+    // hyperlink id.
+    auto prefix = hyperlink.value().id.find(U'-');
+    ASSERT(prefix);
+    auto new_id = hyperlink.value().id.substr(prefix.end());
+    auto new_hyperlink = Hyperlink { .uri = di::clone(hyperlink.value().uri), .id = new_id.to_owned() };
+    di::writer_print<di::String::Encoding>(writer, "{}"_sv, OSC8::from_hyperlink(new_hyperlink).serialize());
+}
+
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+auto Screen::write_rows_as_escape_sequences(di::VectorWriter<>& writer, u64 row_start, u64 row_end) const
+    -> di::Tuple<GraphicsRendition, di::Optional<Hyperlink const&>> {
     auto prev_sgr = GraphicsRendition();
     auto prev_hyperlink = di::Optional<Hyperlink const&> {};
     auto semantic_prompts = di::TreeMap<AbsolutePosition, di::Vector<OSC133>> {};
     for (auto const& command : m_commands.commands()) {
+        if (command.prompt_start.row >= row_end ||
+            (command.output_end != AbsolutePosition() && command.output_end.row < row_start)) {
+            continue;
+        }
         semantic_prompts[command.prompt_start].emplace_back(BeginPrompt {
             .application_id = command.application_id.clone(),
             .click_mode = command.prompt_click_mode,
@@ -1761,7 +1771,7 @@ auto Screen::state_as_escape_sequences() const -> di::String {
             });
         }
     }
-    for (auto r : di::range(absolute_row_start(), absolute_row_end())) {
+    for (auto r : di::range(row_start, row_end)) {
         // Once we get to the screen buffer, force the screen to fully scroll.
         if (r == absolute_row_screen_start()) {
             for (auto _ : di::range(max_height() - 1)) {
@@ -1782,12 +1792,11 @@ auto Screen::state_as_escape_sequences() const -> di::String {
             }
 
             // If we're at a semantic prompt, emit it.
-            if (auto it = semantic_prompts.find({ row_index, c }); it != semantic_prompts.end()) {
+            if (auto it = semantic_prompts.find({ r, c }); it != semantic_prompts.end()) {
                 for (auto const& osc133 : di::get<1>(*it)) {
                     di::writer_print<di::String::Encoding>(writer, "{}"_sv, osc133.serialize());
                 }
             }
-
             // Ignore rendering non-primary multi cells.
             if (cell.is_nonprimary_in_multi_cell()) {
                 continue;
@@ -1808,7 +1817,7 @@ auto Screen::state_as_escape_sequences() const -> di::String {
                 prev_sgr = gfx;
             }
             if (hyperlink != prev_hyperlink) {
-                write_hyperlink(hyperlink);
+                write_hyperlink(writer, hyperlink);
                 prev_hyperlink = hyperlink;
             }
 
@@ -1837,6 +1846,42 @@ auto Screen::state_as_escape_sequences() const -> di::String {
         }
     }
 
+    return { di::move(prev_sgr), prev_hyperlink };
+}
+
+auto Screen::scroll_back_as_escape_sequences(u64 row_start, u64 row_end) const -> di::String {
+    auto writer = di::VectorWriter<> {};
+
+    row_start = di::clamp(row_start, absolute_row_start(), absolute_row_screen_start());
+    row_end = di::clamp(row_end, row_start, absolute_row_screen_start());
+    auto [prev_sgr, prev_hyperlink] = write_rows_as_escape_sequences(writer, row_start, row_end);
+
+    // Reset the graphics rendition and hyperlink so that the result can be concatenated with other output.
+    if (prev_sgr != GraphicsRendition()) {
+        di::writer_print<di::String::Encoding>(writer, "\033[m"_sv);
+    }
+    if (prev_hyperlink) {
+        write_hyperlink(writer, {});
+    }
+
+    return writer.vector() | di::transform(di::construct<c8>) | di::to<di::String>(di::encoding::assume_valid);
+}
+
+auto Screen::state_as_escape_sequences(bool include_scroll_back) const -> di::String {
+    auto writer = di::VectorWriter<> {};
+
+    // 1. Set default margins
+    di::writer_print<di::String::Encoding>(writer, "\033[r"_sv);
+
+    // 2. Set origin mode
+    if (m_origin_mode == OriginMode::Enabled) {
+        di::writer_print<di::String::Encoding>(writer, "\033[?6h"_sv);
+    }
+
+    // 3. Screen contents
+    auto [prev_sgr, prev_hyperlink] = write_rows_as_escape_sequences(
+        writer, include_scroll_back ? absolute_row_start() : absolute_row_screen_start(), absolute_row_end());
+
     // 4. Scroll region
     // This is saved before the cursor because setting the scroll region also moves the cursor.
     di::writer_print<di::String::Encoding>(writer, "\033[{};{}r"_sv, m_scroll_region.start_row + 1,
@@ -1852,7 +1897,7 @@ auto Screen::state_as_escape_sequences() const -> di::String {
 
     // 7. Current hyperlink
     if (auto hyperlink = current_hyperlink(); hyperlink != prev_hyperlink) {
-        write_hyperlink(current_hyperlink());
+        write_hyperlink(writer, current_hyperlink());
     }
 
     // Return the resulting string.
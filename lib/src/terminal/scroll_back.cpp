@@ -22,17 +22,19 @@ void ScrollBack::add_rows(RowGroup& from, usize row_index, usize row_count) {
             // Strip empty cells from the end of the row.
             auto cells = from.strip_trailing_empty_cells(row_index + rows_to_take);
             cells_to_take += cells;
-            rows_to_take++;
-
             prev_row_overflow = from.rows()[row_index + rows_to_take].overflow;
+            rows_to_take++;
         }
 
         auto cells_taken = to.group.transfer_from(from, row_index, to.group.total_rows(), rows_to_take);
+        auto bytes_taken = rows_memory_usage(to.group, to.group.total_rows() - rows_to_take, rows_to_take);
 
         // NOTE: row index remains unchanged because the "old" rows have now been deleted.
         row_count -= rows_to_take;
         m_total_rows += rows_to_take;
         to.cell_count += cells_taken;
+        to.memory_usage += bytes_taken;
+        m_memory_usage += bytes_taken;
         to.last_reflowed_to = {};
     }
 }
@@ -47,12 +49,15 @@ void ScrollBack::take_rows(RowGroup& to, u32 desired_cols, usize row_index, usiz
         auto& from = m_groups.back().value();
         auto rows_to_take = di::min(row_count, from.group.total_rows());
         auto from_index = from.group.total_rows() - rows_to_take;
+        auto bytes_taken = rows_memory_usage(from.group, from_index, rows_to_take);
 
         auto cells_taken = to.transfer_from(from.group, from_index, row_index, rows_to_take, desired_cols);
 
         row_count -= rows_to_take;
         m_total_rows -= rows_to_take;
         from.cell_count -= cells_taken;
+        from.memory_usage -= bytes_taken;
+        m_memory_usage -= bytes_taken;
 
         if (from.group.empty()) {
             m_groups.pop_back();
@@ -73,9 +78,14 @@ auto ScrollBack::take_rows_for_reflow(RowGroup& to) -> u64 {
             break;
         }
 
-        auto cells_taken = to.transfer_from(group.group, group.group.total_rows() - rows_to_take, 0, rows_to_take);
+        auto from_index = group.group.total_rows() - rows_to_take;
+        auto bytes_taken = rows_memory_usage(group.group, from_index, rows_to_take);
+
+        auto cells_taken = to.transfer_from(group.group, from_index, 0, rows_to_take);
         m_total_rows -= rows_to_take;
         group.cell_count -= cells_taken;
+        group.memory_usage -= bytes_taken;
+        m_memory_usage -= bytes_taken;
     }
 
     return rows_to_take;
@@ -94,6 +104,11 @@ auto ScrollBack::reflow_visual_rows(u64 absolute_row_start, usize row_count, u32
             auto reflow_result = group.group.reflow(row_group_start, desired_cols);
             m_total_rows += group.group.total_rows();
 
+            // Reflowing rewrites every row in the group, so its size has to be recomputed.
+            m_memory_usage -= group.memory_usage;
+            group.memory_usage = rows_memory_usage(group.group, 0, group.group.total_rows());
+            m_memory_usage += group.memory_usage;
+
             absolute_row_start = reflow_result.map_position({ absolute_row_start, 0 }).row;
             row_offset = reflow_result.map_position({ row_group_start + row_offset, 0 }).row - row_group_start;
 
@@ -140,6 +155,16 @@ void ScrollBack::clear() {
         m_groups.pop_front();
     }
     m_total_rows = 0;
+    m_memory_usage = 0;
+}
+
+auto ScrollBack::rows_memory_usage(RowGroup const& group, usize row_index, usize row_count) -> usize {
+    auto result = 0_usize;
+    for (auto i : di::range(row_index, row_index + row_count)) {
+        auto const& row = group.rows()[i];
+        result += sizeof(Row) + row.cells.capacity() * sizeof(Cell) + row.text.size_bytes();
+    }
+    return result;
 }
 
 auto ScrollBack::is_last_group_full() const -> bool {
@@ -157,6 +182,7 @@ auto ScrollBack::add_group() -> Group& {
         auto deleted_rows = m_groups.front().value().group.total_rows();
         m_absolute_row_start += deleted_rows;
         m_total_rows -= deleted_rows;
+        m_memory_usage -= m_groups.front().value().memory_usage;
         m_groups.pop_front();
     }
     return m_groups.emplace_back();
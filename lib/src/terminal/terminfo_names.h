@@ -0,0 +1,72 @@
+#pragma once
+
+#include "di/container/string/prelude.h"
+
+namespace ttx::terminal {
+// The standard capability names, in the order they are stored in a compiled terminfo entry. Any
+// capability not listed here is an extended (user-defined) capability. These lists match ncurses'
+// term.h, and includes the obsolete termcap-only capabilities at the end of each list.
+constexpr auto terminfo_boolean_names = di::Array {
+    "bw"_tsv, "am"_tsv, "xsb"_tsv, "xhp"_tsv, "xenl"_tsv, "eo"_tsv, "gn"_tsv, "hc"_tsv, "km"_tsv, "hs"_tsv, "in"_tsv,
+    "da"_tsv, "db"_tsv, "mir"_tsv, "msgr"_tsv, "os"_tsv, "eslok"_tsv, "xt"_tsv, "hz"_tsv, "ul"_tsv, "xon"_tsv,
+    "nxon"_tsv, "mc5i"_tsv, "chts"_tsv, "nrrmc"_tsv, "npc"_tsv, "ndscr"_tsv, "ccc"_tsv, "bce"_tsv, "hls"_tsv,
+    "xhpa"_tsv, "crxm"_tsv, "daisy"_tsv, "xvpa"_tsv, "sam"_tsv, "cpix"_tsv, "lpix"_tsv, "OTbs"_tsv, "OTns"_tsv,
+    "OTnc"_tsv, "OTMT"_tsv, "OTNL"_tsv, "OTpt"_tsv, "OTxr"_tsv
+};
+
+constexpr auto terminfo_number_names = di::Array {
+    "cols"_tsv, "it"_tsv, "lines"_tsv, "lm"_tsv, "xmc"_tsv, "pb"_tsv, "vt"_tsv, "wsl"_tsv, "nlab"_tsv, "lh"_tsv,
+    "lw"_tsv, "ma"_tsv, "wnum"_tsv, "colors"_tsv, "pairs"_tsv, "ncv"_tsv, "bufsz"_tsv, "spinv"_tsv, "spinh"_tsv,
+    "maddr"_tsv, "mjump"_tsv, "mcs"_tsv, "mls"_tsv, "npins"_tsv, "orc"_tsv, "orl"_tsv, "orhi"_tsv, "orvi"_tsv,
+    "cps"_tsv, "widcs"_tsv, "btns"_tsv, "bitwin"_tsv, "bitype"_tsv, "OTug"_tsv, "OTdC"_tsv, "OTdN"_tsv, "OTdB"_tsv,
+    "OTdT"_tsv, "OTkn"_tsv
+};
+
+constexpr auto terminfo_string_names = di::Array {
+    "cbt"_tsv, "bel"_tsv, "cr"_tsv, "csr"_tsv, "tbc"_tsv, "clear"_tsv, "el"_tsv, "ed"_tsv, "hpa"_tsv, "cmdch"_tsv,
+    "cup"_tsv, "cud1"_tsv, "home"_tsv, "civis"_tsv, "cub1"_tsv, "mrcup"_tsv, "cnorm"_tsv, "cuf1"_tsv, "ll"_tsv,
+    "cuu1"_tsv, "cvvis"_tsv, "dch1"_tsv, "dl1"_tsv, "dsl"_tsv, "hd"_tsv, "smacs"_tsv, "blink"_tsv, "bold"_tsv,
+    "smcup"_tsv, "smdc"_tsv, "dim"_tsv, "smir"_tsv, "invis"_tsv, "prot"_tsv, "rev"_tsv, "smso"_tsv, "smul"_tsv,
+    "ech"_tsv, "rmacs"_tsv, "sgr0"_tsv, "rmcup"_tsv, "rmdc"_tsv, "rmir"_tsv, "rmso"_tsv, "rmul"_tsv, "flash"_tsv,
+    "ff"_tsv, "fsl"_tsv, "is1"_tsv, "is2"_tsv, "is3"_tsv, "if"_tsv, "ich1"_tsv, "il1"_tsv, "ip"_tsv, "kbs"_tsv,
+    "ktbc"_tsv, "kclr"_tsv, "kctab"_tsv, "kdch1"_tsv, "kdl1"_tsv, "kcud1"_tsv, "krmir"_tsv, "kel"_tsv, "ked"_tsv,
+    "kf0"_tsv, "kf1"_tsv, "kf10"_tsv, "kf2"_tsv, "kf3"_tsv, "kf4"_tsv, "kf5"_tsv, "kf6"_tsv, "kf7"_tsv, "kf8"_tsv,
+    "kf9"_tsv, "khome"_tsv, "kich1"_tsv, "kil1"_tsv, "kcub1"_tsv, "kll"_tsv, "knp"_tsv, "kpp"_tsv, "kcuf1"_tsv,
+    "kind"_tsv, "kri"_tsv, "khts"_tsv, "kcuu1"_tsv, "rmkx"_tsv, "smkx"_tsv, "lf0"_tsv, "lf1"_tsv, "lf10"_tsv, "lf2"_tsv,
+    "lf3"_tsv, "lf4"_tsv, "lf5"_tsv, "lf6"_tsv, "lf7"_tsv, "lf8"_tsv, "lf9"_tsv, "rmm"_tsv, "smm"_tsv, "nel"_tsv,
+    "pad"_tsv, "dch"_tsv, "dl"_tsv, "cud"_tsv, "ich"_tsv, "indn"_tsv, "il"_tsv, "cub"_tsv, "cuf"_tsv, "rin"_tsv,
+    "cuu"_tsv, "pfkey"_tsv, "pfloc"_tsv, "pfx"_tsv, "mc0"_tsv, "mc4"_tsv, "mc5"_tsv, "rep"_tsv, "rs1"_tsv, "rs2"_tsv,
+    "rs3"_tsv, "rf"_tsv, "rc"_tsv, "vpa"_tsv, "sc"_tsv, "ind"_tsv, "ri"_tsv, "sgr"_tsv, "hts"_tsv, "wind"_tsv, "ht"_tsv,
+    "tsl"_tsv, "uc"_tsv, "hu"_tsv, "iprog"_tsv, "ka1"_tsv, "ka3"_tsv, "kb2"_tsv, "kc1"_tsv, "kc3"_tsv, "mc5p"_tsv,
+    "rmp"_tsv, "acsc"_tsv, "pln"_tsv, "kcbt"_tsv, "smxon"_tsv, "rmxon"_tsv, "smam"_tsv, "rmam"_tsv, "xonc"_tsv,
+    "xoffc"_tsv, "enacs"_tsv, "smln"_tsv, "rmln"_tsv, "kbeg"_tsv, "kcan"_tsv, "kclo"_tsv, "kcmd"_tsv, "kcpy"_tsv,
+    "kcrt"_tsv, "kend"_tsv, "kent"_tsv, "kext"_tsv, "kfnd"_tsv, "khlp"_tsv, "kmrk"_tsv, "kmsg"_tsv, "kmov"_tsv,
+    "knxt"_tsv, "kopn"_tsv, "kopt"_tsv, "kprv"_tsv, "kprt"_tsv, "krdo"_tsv, "kref"_tsv, "krfr"_tsv, "krpl"_tsv,
+    "krst"_tsv, "kres"_tsv, "ksav"_tsv, "kspd"_tsv, "kund"_tsv, "kBEG"_tsv, "kCAN"_tsv, "kCMD"_tsv, "kCPY"_tsv,
+    "kCRT"_tsv, "kDC"_tsv, "kDL"_tsv, "kslt"_tsv, "kEND"_tsv, "kEOL"_tsv, "kEXT"_tsv, "kFND"_tsv, "kHLP"_tsv,
+    "kHOM"_tsv, "kIC"_tsv, "kLFT"_tsv, "kMSG"_tsv, "kMOV"_tsv, "kNXT"_tsv, "kOPT"_tsv, "kPRV"_tsv, "kPRT"_tsv,
+    "kRDO"_tsv, "kRPL"_tsv, "kRIT"_tsv, "kRES"_tsv, "kSAV"_tsv, "kSPD"_tsv, "kUND"_tsv, "rfi"_tsv, "kf11"_tsv,
+    "kf12"_tsv, "kf13"_tsv, "kf14"_tsv, "kf15"_tsv, "kf16"_tsv, "kf17"_tsv, "kf18"_tsv, "kf19"_tsv, "kf20"_tsv,
+    "kf21"_tsv, "kf22"_tsv, "kf23"_tsv, "kf24"_tsv, "kf25"_tsv, "kf26"_tsv, "kf27"_tsv, "kf28"_tsv, "kf29"_tsv,
+    "kf30"_tsv, "kf31"_tsv, "kf32"_tsv, "kf33"_tsv, "kf34"_tsv, "kf35"_tsv, "kf36"_tsv, "kf37"_tsv, "kf38"_tsv,
+    "kf39"_tsv, "kf40"_tsv, "kf41"_tsv, "kf42"_tsv, "kf43"_tsv, "kf44"_tsv, "kf45"_tsv, "kf46"_tsv, "kf47"_tsv,
+    "kf48"_tsv, "kf49"_tsv, "kf50"_tsv, "kf51"_tsv, "kf52"_tsv, "kf53"_tsv, "kf54"_tsv, "kf55"_tsv, "kf56"_tsv,
+    "kf57"_tsv, "kf58"_tsv, "kf59"_tsv, "kf60"_tsv, "kf61"_tsv, "kf62"_tsv, "kf63"_tsv, "el1"_tsv, "mgc"_tsv,
+    "smgl"_tsv, "smgr"_tsv, "fln"_tsv, "sclk"_tsv, "dclk"_tsv, "rmclk"_tsv, "cwin"_tsv, "wingo"_tsv, "hup"_tsv,
+    "dial"_tsv, "qdial"_tsv, "tone"_tsv, "pulse"_tsv, "hook"_tsv, "pause"_tsv, "wait"_tsv, "u0"_tsv, "u1"_tsv, "u2"_tsv,
+    "u3"_tsv, "u4"_tsv, "u5"_tsv, "u6"_tsv, "u7"_tsv, "u8"_tsv, "u9"_tsv, "op"_tsv, "oc"_tsv, "initc"_tsv, "initp"_tsv,
+    "scp"_tsv, "setf"_tsv, "setb"_tsv, "cpi"_tsv, "lpi"_tsv, "chr"_tsv, "cvr"_tsv, "defc"_tsv, "swidm"_tsv, "sdrfq"_tsv,
+    "sitm"_tsv, "slm"_tsv, "smicm"_tsv, "snlq"_tsv, "snrmq"_tsv, "sshm"_tsv, "ssubm"_tsv, "ssupm"_tsv, "sum"_tsv,
+    "rwidm"_tsv, "ritm"_tsv, "rlm"_tsv, "rmicm"_tsv, "rshm"_tsv, "rsubm"_tsv, "rsupm"_tsv, "rum"_tsv, "mhpa"_tsv,
+    "mcud1"_tsv, "mcub1"_tsv, "mcuf1"_tsv, "mvpa"_tsv, "mcuu1"_tsv, "porder"_tsv, "mcud"_tsv, "mcub"_tsv, "mcuf"_tsv,
+    "mcuu"_tsv, "scs"_tsv, "smgb"_tsv, "smgbp"_tsv, "smglp"_tsv, "smgrp"_tsv, "smgt"_tsv, "smgtp"_tsv, "sbim"_tsv,
+    "scsd"_tsv, "rbim"_tsv, "rcsd"_tsv, "subcs"_tsv, "supcs"_tsv, "docr"_tsv, "zerom"_tsv, "csnm"_tsv, "kmous"_tsv,
+    "minfo"_tsv, "reqmp"_tsv, "getm"_tsv, "setaf"_tsv, "setab"_tsv, "pfxl"_tsv, "devt"_tsv, "csin"_tsv, "s0ds"_tsv,
+    "s1ds"_tsv, "s2ds"_tsv, "s3ds"_tsv, "smglr"_tsv, "smgtb"_tsv, "birep"_tsv, "binel"_tsv, "bicr"_tsv, "colornm"_tsv,
+    "defbi"_tsv, "endbi"_tsv, "setcolor"_tsv, "slines"_tsv, "dispc"_tsv, "smpch"_tsv, "rmpch"_tsv, "smsc"_tsv,
+    "rmsc"_tsv, "pctrm"_tsv, "scesc"_tsv, "scesa"_tsv, "ehhlm"_tsv, "elhlm"_tsv, "elohlm"_tsv, "erhlm"_tsv, "ethlm"_tsv,
+    "evhlm"_tsv, "sgr1"_tsv, "slength"_tsv, "OTi2"_tsv, "OTrs"_tsv, "OTnl"_tsv, "OTbc"_tsv, "OTko"_tsv, "OTma"_tsv,
+    "OTG2"_tsv, "OTG3"_tsv, "OTG1"_tsv, "OTG4"_tsv, "OTGR"_tsv, "OTGL"_tsv, "OTGU"_tsv, "OTGD"_tsv, "OTGH"_tsv,
+    "OTGV"_tsv, "OTGC"_tsv, "meml"_tsv, "memu"_tsv, "box1"_tsv
+};
+}
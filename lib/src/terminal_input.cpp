@@ -20,6 +20,32 @@
 #include "ttx/terminal/escapes/terminfo_string.h"
 
 namespace ttx {
+void coalesce_mouse_motion(di::Vector<Event>& events) {
+    auto as_motion = [](Event const& event) -> di::Optional<MouseEvent const&> {
+        auto mouse_event = di::get_if<MouseEvent>(event);
+        if (mouse_event && mouse_event->type() == MouseEventType::Move) {
+            return mouse_event;
+        }
+        return {};
+    };
+
+    auto result = di::Vector<Event> {};
+    for (auto& event : events) {
+        if (auto motion = as_motion(event)) {
+            if (auto last = result.back()) {
+                if (auto last_motion = as_motion(last.value());
+                    last_motion && last_motion->button() == motion->button() &&
+                    last_motion->modifiers() == motion->modifiers()) {
+                    last.value() = di::move(event);
+                    continue;
+                }
+            }
+        }
+        result.push_back(di::move(event));
+    }
+    events = di::move(result);
+}
+
 auto TerminalInputParser::parse(di::StringView input, Feature features) -> di::Vector<Event> {
     // Go 1 character at a time, to ensure we can react to bracketed paste mode.
     for (auto ch : input | di::slide(1)) {
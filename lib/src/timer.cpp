@@ -0,0 +1,115 @@
+#include "ttx/timer.h"
+
+#include "di/sync/memory_order.h"
+
+namespace ttx {
+auto TimerQueue::add(dius::SteadyClock::TimePoint deadline, Callback callback) -> u64 {
+    auto id = m_next_id++;
+    m_entries.push(Entry { .deadline = deadline, .id = id });
+    m_callbacks.try_emplace(id, di::move(callback));
+    return id;
+}
+
+void TimerQueue::cancel(u64 id) {
+    m_callbacks.erase(id);
+}
+
+auto TimerQueue::next_deadline() -> di::Optional<dius::SteadyClock::TimePoint> {
+    while (auto top = m_entries.top()) {
+        if (m_callbacks.contains(top.value().id)) {
+            return top.value().deadline;
+        }
+        m_entries.pop();
+    }
+    return {};
+}
+
+auto TimerQueue::take_expired(dius::SteadyClock::TimePoint now) -> di::Vector<Callback> {
+    auto result = di::Vector<Callback> {};
+    while (auto top = m_entries.top()) {
+        if (top.value().deadline > now) {
+            break;
+        }
+        auto id = top.value().id;
+        m_entries.pop();
+        if (auto callback = m_callbacks.at(id)) {
+            result.push_back(di::move(callback.value()));
+            m_callbacks.erase(id);
+        }
+    }
+    return result;
+}
+
+auto TimerThread::create() -> di::Result<di::Box<TimerThread>> {
+    auto result = di::make_box<TimerThread>();
+    result->m_thread = TRY(dius::Thread::create([&self = *result.get()] {
+        self.timer_thread();
+    }));
+    return result;
+}
+
+TimerThread::~TimerThread() {
+    stop();
+}
+
+auto TimerThread::add(dius::SteadyClock::TimePoint deadline, TimerQueue::Callback callback) -> u64 {
+    return m_timers.with_lock([&](TimerQueue& timers) {
+        auto was_empty = timers.empty();
+        auto id = timers.add(deadline, di::move(callback));
+        if (was_empty) {
+            m_condition.notify_one();
+        }
+        return id;
+    });
+}
+
+void TimerThread::cancel(u64 id) {
+    m_timers.with_lock([&](TimerQueue& timers) {
+        timers.cancel(id);
+    });
+}
+
+void TimerThread::stop() {
+    if (!m_done.exchange(true, di::MemoryOrder::Release)) {
+        m_timers.with_lock([&](TimerQueue&) {
+            m_condition.notify_one();
+        });
+    }
+    (void) m_thread.join();
+}
+
+void TimerThread::timer_thread() {
+    while (!m_done.load(di::MemoryOrder::Acquire)) {
+        auto deadline = [&] {
+            auto lock = di::UniqueLock(m_timers.get_lock());
+            m_condition.wait(lock, [&] {
+                // SAFETY: we acquired the lock manually above.
+                return !m_timers.get_assuming_no_concurrent_accesses().empty() ||
+                       m_done.load(di::MemoryOrder::Acquire);
+            });
+
+            // SAFETY: we acquired the lock manually above.
+            return m_timers.get_assuming_no_concurrent_accesses().next_deadline();
+        }();
+        if (!deadline) {
+            continue;
+        }
+
+        auto now = dius::SteadyClock::now();
+        if (deadline.value() > now) {
+            dius::this_thread::sleep_until(di::min(deadline.value(), now + max_sleep));
+        }
+
+        // The callbacks are run without holding the lock, so that they can add more timers.
+        auto callbacks = m_timers.with_lock([&](TimerQueue& timers) {
+            return timers.take_expired(dius::SteadyClock::now());
+        });
+        for (auto& callback : callbacks) {
+            if (m_done.load(di::MemoryOrder::Acquire)) {
+                break;
+            }
+            callback();
+        }
+    }
+}
+}
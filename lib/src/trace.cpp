@@ -0,0 +1,154 @@
+#include "ttx/trace.h"
+
+#include "di/serialization/json_serializer.h"
+#include "dius/sync_file.h"
+#include "ttx/stats.h"
+
+namespace ttx {
+auto trace_event_name(TraceEventType type) -> di::StringView {
+    switch (type) {
+        case TraceEventType::ProcessPendingEvents:
+            return "InputThread::process_pending_events"_sv;
+        case TraceEventType::DoRender:
+            return "RenderThread::do_render"_sv;
+        case TraceEventType::PaneDraw:
+            return "Pane::draw"_sv;
+        case TraceEventType::RendererFinish:
+            return "Renderer::finish"_sv;
+        case TraceEventType::PaneOutput:
+            return "Pane::process_output"_sv;
+    }
+    return "unknown"_sv;
+}
+
+void TraceBuffer::record(TraceEventType type, dius::SteadyClock::TimePoint start, dius::SteadyClock::TimePoint end,
+                         u64 arg) {
+    // Only a single thread writes to the buffer, so the head can be updated without a read-modify-write.
+    auto index = m_head.load(di::MemoryOrder::Relaxed);
+    auto& slot = m_slots[index % capacity];
+
+    // Mark the slot as being written (odd sequence number) before touching its fields. The field
+    // stores use release ordering so a reader which observes any new field also observes this.
+    auto sequence = slot.sequence.load(di::MemoryOrder::Relaxed);
+    slot.sequence.store(sequence + 1, di::MemoryOrder::Relaxed);
+
+    slot.type.store(u64(type), di::MemoryOrder::Release);
+    slot.start_ns.store(m_tracer.to_trace_ns(start), di::MemoryOrder::Release);
+    slot.duration_ns.store(elapsed_ns(start, end), di::MemoryOrder::Release);
+    slot.arg.store(arg, di::MemoryOrder::Release);
+
+    slot.sequence.store(sequence + 2, di::MemoryOrder::Release);
+    m_head.store(index + 1, di::MemoryOrder::Release);
+}
+
+auto TraceBuffer::snapshot() const -> di::Vector<TraceEvent> {
+    auto head = m_head.load(di::MemoryOrder::Acquire);
+    auto first = head > capacity ? head - capacity : 0;
+
+    auto result = di::Vector<TraceEvent> {};
+    for (auto index : di::range(first, head)) {
+        auto const& slot = m_slots[index % capacity];
+        auto sequence = slot.sequence.load(di::MemoryOrder::Acquire);
+        if (sequence % 2 != 0) {
+            continue;
+        }
+
+        auto event = TraceEvent {
+            .type = TraceEventType(slot.type.load(di::MemoryOrder::Acquire)),
+            .start_ns = slot.start_ns.load(di::MemoryOrder::Acquire),
+            .duration_ns = slot.duration_ns.load(di::MemoryOrder::Acquire),
+            .arg = slot.arg.load(di::MemoryOrder::Acquire),
+        };
+
+        // If the writer touched the slot while we were reading it, the event is torn and gets dropped.
+        if (slot.sequence.load(di::MemoryOrder::Relaxed) != sequence) {
+            continue;
+        }
+        result.push_back(event);
+    }
+    return result;
+}
+
+auto Tracer::create_buffer(di::String name) -> TraceBuffer& {
+    // Ids aren't reused after a buffer is released, so that each id names a single thread in the trace.
+    auto id = m_next_buffer_id.fetch_add(1, di::MemoryOrder::Relaxed);
+    return m_buffers.with_lock([&](Buffers& buffers) -> TraceBuffer& {
+        buffers.live.push_back(di::make_box<TraceBuffer>(*this, di::move(name), id));
+        return *buffers.live.back().value();
+    });
+}
+
+void Tracer::release_buffer(TraceBuffer& buffer) {
+    m_buffers.with_lock([&](Buffers& buffers) {
+        auto it = di::find_if(buffers.live, [&](di::Box<TraceBuffer> const& candidate) {
+            return candidate.get() == &buffer;
+        });
+        if (it == buffers.live.end()) {
+            return;
+        }
+
+        auto events = buffer.snapshot();
+        buffers.released_events += events.size();
+        buffers.released.push_back(ReleasedBuffer {
+            .name = buffer.name().to_owned(),
+            .id = buffer.id(),
+            .events = di::move(events),
+        });
+        buffers.live.erase(it);
+
+        // Drop the oldest released buffers to stay within the limit. The most recent one is always kept.
+        while (buffers.released_events > max_released_events && buffers.released.size() > 1) {
+            buffers.released_events -= buffers.released.front().value().events.size();
+            buffers.released.erase(buffers.released.begin());
+        }
+    });
+}
+
+auto Tracer::to_trace_ns(dius::SteadyClock::TimePoint time) const -> u64 {
+    return elapsed_ns(m_start, time);
+}
+
+auto Tracer::to_json() -> di::String {
+    auto result = "{\"traceEvents\":["_s;
+    auto first = true;
+    auto append = [&](di::String const& event) {
+        if (!first) {
+            result += ",\n"_sv;
+        }
+        first = false;
+        result += event;
+    };
+
+    auto append_thread = [&](di::StringView name, u32 id, di::Vector<TraceEvent> const& events) {
+        auto name_json = *di::to_json_string(name.to_owned());
+        append(di::format(R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":{}}}}})"_sv, id,
+                          name_json));
+
+        // Timestamps are in microseconds, but fractional values are allowed.
+        for (auto const& event : events) {
+            append(di::format(
+                R"({{"name":"{}","ph":"X","pid":1,"tid":{},"ts":{}.{:0>3},"dur":{}.{:0>3},"args":{{"pane":{}}}}})"_sv,
+                trace_event_name(event.type), id, event.start_ns / 1000, event.start_ns % 1000,
+                event.duration_ns / 1000, event.duration_ns % 1000, event.arg));
+        }
+    };
+
+    m_buffers.with_lock([&](Buffers& buffers) {
+        for (auto const& buffer : buffers.released) {
+            append_thread(buffer.name.view(), buffer.id, buffer.events);
+        }
+        for (auto const& buffer : buffers.live) {
+            append_thread(buffer->name(), buffer->id(), buffer->snapshot());
+        }
+    });
+
+    result += "]}\n"_sv;
+    return result;
+}
+
+auto Tracer::write() -> di::Result<> {
+    auto contents = to_json();
+    auto file = TRY(dius::open_sync(m_path, dius::OpenMode::WriteClobber));
+    return file.write_exactly(di::as_bytes(contents.span()));
+}
+}
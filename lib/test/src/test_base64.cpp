@@ -0,0 +1,86 @@
+#include "di/format/prelude.h"
+#include "di/random/prelude.h"
+#include "di/serialization/base64.h"
+#include "di/test/prelude.h"
+#include "ttx/base64.h"
+
+namespace base64 {
+using namespace ttx;
+
+static auto encode(di::StringView input) -> di::String {
+    auto output = di::Vector<byte> {};
+    base64_encode(di::as_bytes(input.span()), output);
+    ASSERT_EQ(output.size(), base64_encoded_size(input.size_bytes()));
+    return output | di::transform(di::construct<c8>) | di::to<di::String>(di::encoding::assume_valid);
+}
+
+static auto decode(di::StringView input) -> di::Optional<di::String> {
+    auto bytes = base64_decode(di::as_bytes(input.span()));
+    if (!bytes) {
+        return {};
+    }
+    return bytes.value() | di::transform(di::construct<c8>) | di::to<di::String>(di::encoding::assume_valid);
+}
+
+static void encode_decode() {
+    // Test vectors from RFC 4648.
+    struct Case {
+        di::StringView decoded;
+        di::StringView encoded;
+    };
+
+    auto cases = di::Array {
+        Case { ""_sv, ""_sv },
+        Case { "f"_sv, "Zg=="_sv },
+        Case { "fo"_sv, "Zm8="_sv },
+        Case { "foo"_sv, "Zm9v"_sv },
+        Case { "foob"_sv, "Zm9vYg=="_sv },
+        Case { "fooba"_sv, "Zm9vYmE="_sv },
+        Case { "foobar"_sv, "Zm9vYmFy"_sv },
+    };
+
+    for (auto const& [decoded, encoded] : cases) {
+        ASSERT_EQ(encode(decoded), encoded);
+        ASSERT_EQ(decode(encoded).value(), decoded);
+    }
+}
+
+static void decode_lenient_padding() {
+    ASSERT_EQ(decode("Zg"_sv).value(), "f"_sv);
+    ASSERT_EQ(decode("Zm8"_sv).value(), "fo"_sv);
+    ASSERT_EQ(decode("Zm9vYg"_sv).value(), "foob"_sv);
+}
+
+static void decode_invalid() {
+    ASSERT(!decode("~~~~"_sv));
+    ASSERT(!decode("Z"_sv));
+    ASSERT(!decode("Zm9vY"_sv));
+    ASSERT(!decode("Zg==Zg=="_sv));
+    ASSERT(!decode("Zm 9v"_sv));
+    ASSERT(!decode("===="_sv));
+}
+
+static void matches_di() {
+    auto rng = di::MinstdRand(3);
+    for (auto size : di::range(200zu)) {
+        auto data = di::Vector<byte> {};
+        for (auto _ : di::range(size)) {
+            data.push_back(byte(u8(rng() % 256)));
+        }
+
+        auto output = di::Vector<byte> {};
+        base64_encode(data.span(), output);
+        auto encoded = output | di::transform(di::construct<c8>) | di::to<di::String>(di::encoding::assume_valid);
+        ASSERT_EQ(encoded, di::format("{}"_sv, di::Base64<>(di::clone(data))));
+
+        auto decoded = base64_decode(output.span());
+        ASSERT(decoded);
+        ASSERT_EQ(decoded.value(), data);
+    }
+}
+
+TEST(base64, encode_decode)
+TEST(base64, decode_lenient_padding)
+TEST(base64, decode_invalid)
+TEST(base64, matches_di)
+}
@@ -78,6 +78,71 @@ static void lookup() {
     }
 }
 
+static void compile() {
+    auto names = di::Array {
+        "ttx"_tsv,
+        "ttx Multiplexer"_tsv,
+    };
+
+    auto capabilities = di::Array {
+        Capability {
+            .long_name = {},
+            .short_name = "ccc"_tsv,
+            .description = {},
+            .enabled = false,
+        },
+        Capability {
+            .long_name = {},
+            .short_name = "am"_tsv,
+            .description = {},
+        },
+        Capability {
+            .long_name = {},
+            .short_name = "colors"_tsv,
+            .value = 256u,
+            .description = {},
+        },
+        Capability {
+            .long_name = {},
+            .short_name = "bel"_tsv,
+            .value = "^G"_tsv,
+            .description = {},
+        },
+        Capability {
+            .long_name = {},
+            .short_name = "smxx"_tsv,
+            .value = "\\E[9m"_tsv,
+            .description = {},
+        },
+    };
+
+    auto terminfo = Terminfo(names, capabilities);
+
+    // Generated by running `tic -x` on the serialized terminfo.
+    auto expected = di::Array<u8, 92> {
+        // Header: magic, names size, boolean count, number count, string count, string table size
+        0x1a, 0x01, 0x14, 0x00, 0x02, 0x00, 0x0e, 0x00, 0x02, 0x00, 0x02, 0x00,
+        // Names
+        0x74, 0x74, 0x78, 0x7c, 0x74, 0x74, 0x78, 0x20, 0x4d, 0x75, 0x6c, 0x74, 0x69, 0x70, 0x6c, 0x65, 0x78, 0x65,
+        0x72, 0x00,
+        // Booleans (am)
+        0x00, 0x01,
+        // Numbers (colors)
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x01,
+        // String offsets and table (bel)
+        0xff, 0xff, 0x00, 0x00, 0x07, 0x00,
+        // Extended header: boolean count, number count, string count, string table items, string table size
+        0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x0a, 0x00,
+        // Extended string offsets, name offsets, and table (smxx)
+        0x00, 0x00, 0x00, 0x00, 0x1b, 0x5b, 0x39, 0x6d, 0x00, 0x73, 0x6d, 0x78, 0x78, 0x00
+    };
+
+    auto result = terminfo.compile();
+    ASSERT(result == (expected | di::transform(di::construct<byte>) | di::to<di::Vector>()));
+}
+
 TEST(capability, serialize)
 TEST(capability, lookup)
+TEST(capability, compile)
 }
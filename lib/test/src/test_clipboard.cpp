@@ -20,10 +20,13 @@ static void system() {
     ASSERT_EQ(responses[0].data, di::Vector { '4'_b });
 
     // Expiration
+    ASSERT(!clipboard.next_expiration());
     ASSERT(clipboard.request_clipboard(ttx::terminal::SelectionType::Clipboard, { 1, 2, 3 }, t));
     ASSERT(clipboard.get_replies(t).empty());
+    ASSERT(clipboard.next_expiration().value() == t + ttx::Clipboard::request_timeout);
     t += ttx::Clipboard::request_timeout;
     responses = clipboard.get_replies(t);
+    ASSERT(!clipboard.next_expiration());
     ASSERT_EQ(responses.size(), 1zu);
     ASSERT_EQ(responses[0].identifier, ttx::Clipboard::Identifier(1, 2, 3));
     ASSERT_EQ(responses[0].type, ttx::terminal::SelectionType::Clipboard);
@@ -68,6 +71,35 @@ static void local() {
     ASSERT_EQ(responses[0].data, di::Vector { '5'_b });
 }
 
+static void max_size() {
+    auto clipboard = ttx::Clipboard(ttx::ClipboardMode::System, ttx::Feature::Clipboard, 2);
+
+    auto contents = [&] {
+        return clipboard.data(ttx::terminal::SelectionType::Clipboard) | di::to<di::Vector>();
+    };
+
+    auto t = dius::SteadyClock::TimePoint(di::chrono::Seconds(1000));
+    ASSERT(!clipboard.exceeds_max_size(2));
+    ASSERT(clipboard.exceeds_max_size(3));
+
+    ASSERT(clipboard.set_clipboard(ttx::terminal::SelectionType::Clipboard, { '1'_b, '2'_b }, t));
+    ASSERT_EQ(contents(), di::Vector { '1'_b, '2'_b });
+
+    // Writes which are too large are ignored and not forwarded.
+    ASSERT(!clipboard.set_clipboard(ttx::terminal::SelectionType::Clipboard, { '3'_b, '4'_b, '5'_b }, t));
+    ASSERT_EQ(contents(), di::Vector { '1'_b, '2'_b });
+
+    // As are responses from the outer terminal.
+    clipboard.got_clipboard_response(ttx::terminal::SelectionType::Clipboard, { '3'_b, '4'_b, '5'_b }, t);
+    ASSERT_EQ(contents(), di::Vector { '1'_b, '2'_b });
+
+    // A limit of 0 disables the check.
+    clipboard.set_max_size(0);
+    ASSERT(clipboard.set_clipboard(ttx::terminal::SelectionType::Clipboard, { '3'_b, '4'_b, '5'_b }, t));
+    ASSERT_EQ(contents(), di::Vector { '3'_b, '4'_b, '5'_b });
+}
+
 TEST(clipboard, system)
 TEST(clipboard, local)
+TEST(clipboard, max_size)
 }
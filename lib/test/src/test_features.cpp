@@ -0,0 +1,22 @@
+#include "di/test/prelude.h"
+#include "ttx/features.h"
+
+namespace features {
+using namespace ttx;
+
+static void from_replies() {
+    // Without the primary device attributes reply, the replies are incomplete.
+    auto incomplete = "\033[?2026;1$y"_sv;
+    ASSERT(!features_from_replies(di::as_bytes(incomplete.span())));
+
+    auto complete = "\033[?2026;1$y\033[?2027;2$y\033[?1;2c"_sv;
+    auto result = features_from_replies(di::as_bytes(complete.span()));
+    ASSERT(result);
+    ASSERT(!!(result.value().features & Feature::SyncronizedOutput));
+    ASSERT(!!(result.value().features & Feature::GraphemeClusteringMode));
+    ASSERT(!(result.value().features & Feature::KittyKeyProtocol));
+    ASSERT(result.value().restore_mode_2027);
+}
+
+TEST(features, from_replies)
+}
@@ -35,6 +35,25 @@ static void basic() {
     ASSERT_EQ(id1, 1);
 }
 
+static void bulk_reference_counting() {
+    auto map = IdMap<MultiCellInfo> {};
+
+    auto v1 = MultiCellInfo { .width = 2 };
+    auto id1 = map.allocate(v1);
+    ASSERT_EQ(id1, 1);
+
+    // Bump the reference count by 5, for a total of 6 references.
+    map.use_id(*id1, 5);
+
+    // Dropping all but 1 reference keeps the id alive.
+    map.drop_id(*id1, 5);
+    ASSERT_EQ(map.lookup_key(v1), id1);
+
+    // Dropping the last reference frees the id.
+    map.drop_id(*id1, 1);
+    ASSERT(!map.lookup_key(v1));
+}
+
 static void full() {
     auto map = IdMap<u32> {};
 
@@ -48,5 +67,6 @@ static void full() {
 }
 
 TEST(id_map, basic)
+TEST(id_map, bulk_reference_counting)
 TEST(id_map, full)
 }
@@ -1,6 +1,7 @@
 #include "di/test/prelude.h"
 #include "dius/print.h"
 #include "ttx/layout.h"
+#include "ttx/layout_json.h"
 #include "ttx/size.h"
 
 namespace layout {
@@ -545,6 +546,75 @@ static void resize_to_zero() {
     validate_layout_for_pane(pane2, *l2, 33, 0, { 31, 128 });
 }
 
+static void placeholders() {
+    constexpr auto size = Size(64, 128, 1280, 640);
+
+    auto json = json::v1::PaneLayoutNode {};
+    json.direction = Direction::Vertical;
+    json.relative_size = max_layout_precision;
+    json.children.push_back(json::v1::Pane {
+        .relative_size = max_layout_precision / 2,
+        .id = 3,
+        .current_working_directory = di::PercentEncoded<>::from_raw_data("/tmp"_s),
+    });
+    json.children.push_back(json::v1::Pane { .relative_size = max_layout_precision / 2, .id = 7 });
+
+    // Placeholders serialize exactly as they were restored.
+    auto root = *LayoutGroup::placeholder_from_json_v1(json);
+    ASSERT_EQ(root.as_json_v1(), json);
+    ASSERT_EQ(root.max_pane_id(), 7);
+
+    auto created = di::Vector<di::Tuple<u64, Size>> {};
+    auto make_pane = [&](u64 pane_id, di::Optional<di::Path> cwd, Size const& pane_size) -> di::Result<di::Box<Pane>> {
+        created.push_back(di::make_tuple(pane_id, pane_size));
+        return Pane::create_mock(pane_id, di::move(cwd));
+    };
+    ASSERT(root.make_panes(size, make_pane));
+    ASSERT_EQ(created.size(), 2zu);
+    ASSERT_EQ(di::get<0>(created[0]), 3);
+    ASSERT_EQ(di::get<0>(created[1]), 7);
+    ASSERT_EQ(di::get<1>(created[0]).cols, 128);
+    ASSERT_EQ(root.max_pane_id(), 7);
+}
+
+static void placeholders_failed() {
+    constexpr auto size = Size(64, 128, 1280, 640);
+
+    auto json = json::v1::PaneLayoutNode {};
+    json.direction = Direction::Vertical;
+    json.relative_size = max_layout_precision;
+    for (auto id : di::range(1_u64, 5_u64)) {
+        json.children.push_back(json::v1::Pane { .relative_size = max_layout_precision / 4, .id = id });
+    }
+
+    // Panes 2 and 3 fail to be created. The panes after the first failure must still be created.
+    auto root = *LayoutGroup::placeholder_from_json_v1(json);
+    auto panes = di::Vector<Pane*> {};
+    auto make_pane = [&](u64 pane_id, di::Optional<di::Path> cwd, Size const&) -> di::Result<di::Box<Pane>> {
+        if (pane_id == 2 || pane_id == 3) {
+            return di::Unexpected(di::BasicError::InvalidArgument);
+        }
+        auto pane = Pane::create_mock(pane_id, di::move(cwd));
+        panes.push_back(pane.get());
+        return pane;
+    };
+    ASSERT(!root.make_panes(size, make_pane));
+    ASSERT_EQ(panes.size(), 2zu);
+
+    // Each placeholder is removed separately, so the relative sizes of the remaining panes still add up.
+    ASSERT(root.remove_placeholder());
+    ASSERT(root.remove_placeholder());
+    ASSERT(!root.remove_placeholder());
+    ASSERT_EQ(root.max_pane_id(), 4);
+
+    auto tree = root.layout(size, 0, 0);
+    auto first = tree->find_pane(panes[0]);
+    auto second = tree->find_pane(panes[1]);
+    ASSERT(first);
+    ASSERT(second);
+    ASSERT_EQ(first->size.rows + second->size.rows, 63u);
+}
+
 TEST(layout, splits)
 TEST(layout, many_splits)
 TEST(layout, nested_splits)
@@ -554,4 +624,6 @@ TEST(layout, hit_test)
 TEST(layout, resize)
 TEST(layout, resize_nested)
 TEST(layout, resize_to_zero)
+TEST(layout, placeholders)
+TEST(layout, placeholders_failed)
 }
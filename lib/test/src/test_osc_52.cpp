@@ -94,6 +94,25 @@ static void test_serialize() {
     }
 }
 
+static void test_parse_max_size() {
+    // 12 base64 characters decode to at most 9 bytes, so a limit of 8 drops the data without decoding it.
+    auto result = OSC52::parse("c;YWJjZGVmZ2hp"_sv, 8);
+    ASSERT(result);
+    ASSERT_EQ(result.value().oversized, 9u);
+    ASSERT(result.value().data.container().empty());
+
+    result = OSC52::parse("c;YWJjZGVmZ2hp"_sv, 9);
+    ASSERT(result);
+    ASSERT_EQ(result.value().oversized, 0u);
+    ASSERT_EQ(result.value().data, "YWJjZGVmZ2hp"_base64);
+
+    // Queries have no data, so they are never too large.
+    result = OSC52::parse("c;?"_sv, 1);
+    ASSERT(result);
+    ASSERT(result.value().query);
+}
+
 TEST(osc_52, test_parse)
 TEST(osc_52, test_serialize)
+TEST(osc_52, test_parse_max_size)
 }
@@ -0,0 +1,60 @@
+#include "di/test/prelude.h"
+#include "ttx/escape_sequence_parser.h"
+#include "ttx/pane.h"
+#include "ttx/pane_snapshot.h"
+#include "ttx/utf8_stream_decoder.h"
+
+namespace pane_snapshot {
+using namespace ttx;
+
+static void process(Pane& pane, di::StringView text) {
+    auto parser = EscapeSequenceParser();
+    auto utf8_decoder = Utf8StreamDecoder {};
+    pane.process_output(di::as_bytes(text.span()), parser, utf8_decoder);
+}
+
+static void incremental() {
+    // The mock pane is 1x1, so every line after the first is moved to the scroll back.
+    auto pane = Pane::create_mock();
+    auto snapshot = PaneSnapshot {};
+
+    process(*pane, "a\r\nb\r\nc"_sv);
+    auto update = pane->update_snapshot(snapshot);
+    ASSERT(update.replace_history);
+    ASSERT(di::contains(update.history, U'a'));
+    ASSERT(di::contains(update.history, U'b'));
+    ASSERT(!di::contains(update.history, U'c'));
+    ASSERT(update.screen);
+    ASSERT(di::contains(update.screen.value(), U'c'));
+
+    // Nothing changed, so nothing needs to be written.
+    update = pane->update_snapshot(snapshot);
+    ASSERT(!update.replace_history);
+    ASSERT(update.history.empty());
+    ASSERT(!update.screen);
+
+    // Only the newly added scroll back is included.
+    process(*pane, "\r\nd"_sv);
+    update = pane->update_snapshot(snapshot);
+    ASSERT(!update.replace_history);
+    ASSERT(!di::contains(update.history, U'a'));
+    ASSERT(!di::contains(update.history, U'b'));
+    ASSERT(di::contains(update.history, U'c'));
+    ASSERT(update.screen);
+
+    // Clearing the scroll back replaces the history.
+    process(*pane, "\033[3J"_sv);
+    update = pane->update_snapshot(snapshot);
+    ASSERT(update.replace_history);
+    ASSERT(update.history.empty());
+
+    // After a reset, everything is written again.
+    process(*pane, "\r\ne"_sv);
+    snapshot.reset();
+    update = pane->update_snapshot(snapshot);
+    ASSERT(update.replace_history);
+    ASSERT(update.screen);
+}
+
+TEST(pane_snapshot, incremental)
+}
@@ -0,0 +1,141 @@
+#include "di/test/prelude.h"
+#include "dius/sync_file.h"
+#include "ttx/capture.h"
+#include "ttx/replay.h"
+
+namespace replay {
+using namespace ttx;
+
+static void write_file(di::PathView path, di::StringView contents) {
+    auto file = dius::open_sync(path, dius::OpenMode::WriteClobber);
+    ASSERT(file);
+    ASSERT(file.value().write_exactly(di::as_bytes(contents.span())));
+}
+
+static void untimed() {
+    auto path = "/tmp/ttx-test-replay-untimed.ansi"_p;
+    write_file(path, "hello"_sv);
+
+    auto reader = ReplayReader::open(path);
+    ASSERT(reader);
+    ASSERT(!reader.value().has_timing());
+
+    auto buffer = di::Vector<byte> {};
+    buffer.resize(3);
+    auto chunk = reader.value().read(buffer.span());
+    ASSERT(chunk);
+    ASSERT_EQ(chunk->size, 3);
+    ASSERT(!chunk->offset);
+
+    chunk = reader.value().read(buffer.span());
+    ASSERT(chunk);
+    ASSERT_EQ(chunk->size, 2);
+
+    ASSERT(!reader.value().read(buffer.span()));
+}
+
+static void timed() {
+    auto path = "/tmp/ttx-test-replay-timed.ansi"_p;
+    write_file(path, "abcdefghij"_sv);
+    write_file(ReplayReader::timing_path(path), "0 2\n1500 6\n3000 1\n"_sv);
+
+    auto reader = ReplayReader::open(path);
+    ASSERT(reader);
+    ASSERT(reader.value().has_timing());
+
+    // Chunks larger than the buffer are split, and output past the end of the timing uses the last offset.
+    auto buffer = di::Vector<byte> {};
+    buffer.resize(4);
+    auto expected = di::Array {
+        di::Tuple { 2_usize, 0_u64 }, di::Tuple { 4_usize, 1500_u64 }, di::Tuple { 2_usize, 1500_u64 },
+        di::Tuple { 1_usize, 3000_u64 }, di::Tuple { 1_usize, 3000_u64 },
+    };
+    for (auto [size, offset_us] : expected) {
+        auto chunk = reader.value().read(buffer.span());
+        ASSERT(chunk);
+        ASSERT_EQ(chunk->size, size);
+        ASSERT(chunk->offset);
+        ASSERT(chunk->offset.value() == di::Microseconds(offset_us));
+    }
+    ASSERT(!reader.value().read(buffer.span()));
+}
+
+static void malformed_timing() {
+    auto path = "/tmp/ttx-test-replay-malformed-timing.ansi"_p;
+    write_file(path, "abcdefghij"_sv);
+    write_file(ReplayReader::timing_path(path), "0 2\n1500 x\n3000 1\n"_sv);
+
+    // A bad timing file falls back to an untimed replay of the whole output.
+    auto reader = ReplayReader::open(path);
+    ASSERT(reader);
+    ASSERT(!reader.value().has_timing());
+
+    auto buffer = di::Vector<byte> {};
+    buffer.resize(16);
+    auto chunk = reader.value().read(buffer.span());
+    ASSERT(chunk);
+    ASSERT_EQ(chunk->size, 10);
+    ASSERT(!chunk->offset);
+}
+
+static auto read_all(ReplayReader& reader) -> di::String {
+    auto buffer = di::Vector<byte> {};
+    buffer.resize(4);
+
+    auto result = di::String {};
+    while (auto chunk = reader.read(buffer.span())) {
+        ASSERT(chunk->offset);
+        for (auto value : buffer | di::take(chunk->size)) {
+            result.push_back(c32(value));
+        }
+    }
+    return result;
+}
+
+static void container() {
+    auto path = "/tmp/ttx-test-replay-container.ttxcap"_p;
+    {
+        auto writer = CaptureWriter::create(path, { 24, 80, 800, 480 });
+        ASSERT(writer);
+        ASSERT(writer.value().write_output(di::as_bytes("abcdef"_sv.span())));
+        ASSERT(writer.value().write_resize({ 10, 20, 200, 100 }));
+        ASSERT(writer.value().write_keyframe("STATE"_sv));
+        ASSERT(writer.value().write_output(di::as_bytes("ghi"_sv.span())));
+        ASSERT(writer.value().finish());
+    }
+
+    // Reading sequentially skips keyframes, and converts resizes to escape sequences.
+    auto reader = ReplayReader::open(path);
+    ASSERT(reader);
+    ASSERT(reader.value().has_timing());
+    ASSERT_EQ(reader.value().keyframes().size(), 1);
+    ASSERT_EQ(read_all(reader.value()), "\033[4;480;800t\033[8;24;80tabcdef\033[4;100;200t\033[8;10;20tghi"_sv);
+
+    // Seeking starts from the keyframe's state.
+    auto seek_reader = ReplayReader::open(path);
+    ASSERT(seek_reader);
+    ASSERT(seek_reader.value().seek(di::Seconds(1000)));
+    ASSERT_EQ(read_all(seek_reader.value()), "STATEghi"_sv);
+}
+
+static void container_without_index() {
+    auto path = "/tmp/ttx-test-replay-container-unfinished.ttxcap"_p;
+    {
+        auto writer = CaptureWriter::create(path, { 24, 80, 0, 0 });
+        ASSERT(writer);
+        ASSERT(writer.value().write_output(di::as_bytes("abc"_sv.span())));
+    }
+
+    auto reader = ReplayReader::open(path);
+    ASSERT(reader);
+    ASSERT(reader.value().keyframes().empty());
+    ASSERT(!reader.value().seek(di::Seconds(1)));
+    ASSERT_EQ(read_all(reader.value()), "\033[4;0;0t\033[8;24;80tabc"_sv);
+}
+
+TEST(replay, untimed)
+TEST(replay, timed)
+TEST(replay, malformed_timing)
+TEST(replay, container)
+TEST(replay, container_without_index)
+}
@@ -934,6 +934,101 @@ static void vertical_scroll_region_autowrap() {
     }
 }
 
+static void scroll_down_batched() {
+    // Scrolling by N rows at once must produce the same result as scrolling N times.
+    auto fill = [](Screen& screen) {
+        auto rng = di::MinstdRand(3);
+        for (auto _ : di::range(screen.max_width() * screen.max_height() - 1)) {
+            auto ch = c32(di::UniformIntDistribution(u32('a'), u32('z'))(rng));
+            if (ch == 'z') {
+                ch = ' ';
+            }
+            screen.put_code_point(ch, AutoWrapMode::Enabled);
+        }
+    };
+
+    for (auto scroll_back_enabled : { Screen::ScrollBackEnabled::No, Screen::ScrollBackEnabled::Yes }) {
+        for (auto region : { ScrollRegion(0, 6), ScrollRegion(1, 4) }) {
+            for (auto count : { 1_u32, 2_u32, 3_u32, 5_u32, 13_u32 }) {
+                auto single = Screen({ 6, 4 }, scroll_back_enabled);
+                auto batched = Screen({ 6, 4 }, scroll_back_enabled);
+                for (auto* screen : { &single, &batched }) {
+                    fill(*screen);
+                    screen->set_scroll_region(region);
+                    screen->set_cursor(region.end_row - 1, 2);
+                }
+
+                for (auto _ : di::range(count)) {
+                    single.scroll_down();
+                }
+                batched.scroll_down(count);
+
+                ASSERT_EQ(single.cursor(), batched.cursor());
+                ASSERT_EQ(single.total_rows(), batched.total_rows());
+                ASSERT_EQ(single.visual_scroll_offset(), batched.visual_scroll_offset());
+                ASSERT_EQ(single.state_as_escape_sequences(), batched.state_as_escape_sequences());
+            }
+        }
+    }
+}
+
+static void scroll_back_as_escape_sequences() {
+    auto screen = Screen({ 2, 3 }, Screen::ScrollBackEnabled::Yes);
+    put_text(screen, "ab\n"
+                     "cdef\n"
+                     "g\n"
+                     "h"_sv);
+
+    // The scroll back has "ab", "cde" (which overflowed) and "f".
+    ASSERT_EQ(screen.absolute_row_start(), 0);
+    ASSERT_EQ(screen.absolute_row_screen_start(), 3);
+
+    auto full = screen.scroll_back_as_escape_sequences(0, 3);
+    ASSERT(di::contains(full, U'a'));
+    ASSERT(di::contains(full, U'f'));
+    ASSERT(!di::contains(full, U'g'));
+
+    // The range is clamped to the scroll back.
+    ASSERT_EQ(screen.scroll_back_as_escape_sequences(0, 100), full);
+    ASSERT(screen.scroll_back_as_escape_sequences(3, 5).empty());
+
+    auto tail = screen.scroll_back_as_escape_sequences(1, 3);
+    ASSERT(!di::contains(tail, U'a'));
+    ASSERT(di::contains(tail, U'c'));
+
+    // Excluding the scroll back leaves only the rows on the screen.
+    auto state = screen.state_as_escape_sequences(false);
+    ASSERT(!di::contains(state, U'a'));
+    ASSERT(!di::contains(state, U'f'));
+    ASSERT(di::contains(state, U'g'));
+    ASSERT(di::contains(screen.state_as_escape_sequences(), U'a'));
+}
+
+static void scroll_back_memory_usage() {
+    auto screen = Screen({ 2, 3 }, Screen::ScrollBackEnabled::Yes);
+    ASSERT_EQ(screen.scroll_back_memory_usage(), 0);
+
+    put_text(screen, "ab\n"
+                     "cd\n"
+                     "ef"_sv);
+    auto usage = screen.scroll_back_memory_usage();
+    ASSERT_GT(usage, 0);
+
+    put_text(screen, "\ngh"_sv);
+    ASSERT_GT(screen.scroll_back_memory_usage(), usage);
+
+    // Growing the screen takes every row back out of the scroll back.
+    screen.resize({ 10, 3 });
+    ASSERT_EQ(screen.absolute_row_start(), screen.absolute_row_screen_start());
+    ASSERT_EQ(screen.scroll_back_memory_usage(), 0);
+
+    // Shrinking pushes them back in, and clearing drops them.
+    screen.resize({ 2, 3 });
+    ASSERT_GT(screen.scroll_back_memory_usage(), 0);
+    screen.clear_scroll_back();
+    ASSERT_EQ(screen.scroll_back_memory_usage(), 0);
+}
+
 static void save_restore_cursor() {
     auto screen = Screen({ 5, 2 }, Screen::ScrollBackEnabled::No);
     put_text(screen, "ab"
@@ -1118,6 +1213,9 @@ TEST(screen, delete_lines)
 TEST(screen, vertical_scroll_region_delete_lines)
 TEST(screen, autowrap)
 TEST(screen, vertical_scroll_region_autowrap)
+TEST(screen, scroll_down_batched)
+TEST(screen, scroll_back_as_escape_sequences)
+TEST(screen, scroll_back_memory_usage)
 TEST(screen, save_restore_cursor)
 TEST(screen, reflow_basic)
 TEST(screen, reflow_wide)
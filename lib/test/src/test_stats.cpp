@@ -0,0 +1,84 @@
+#include "di/test/prelude.h"
+#include "ttx/stats.h"
+
+namespace stats {
+using namespace ttx;
+
+static void counter() {
+    auto counter = StatCounter {};
+    ASSERT_EQ(counter.value(), 0);
+
+    counter.add(5);
+    counter.add(7);
+    ASSERT_EQ(counter.value(), 12);
+}
+
+static void histogram() {
+    auto histogram = StatHistogram {};
+    ASSERT_EQ(histogram.count(), 0);
+    ASSERT_EQ(histogram.percentile(50), 0);
+
+    for (auto i : di::range(1_u64, 101_u64)) {
+        histogram.record(i);
+    }
+    ASSERT_EQ(histogram.count(), 100);
+    ASSERT_EQ(histogram.sum(), 5050);
+    ASSERT_EQ(histogram.average(), 50);
+
+    // Percentiles are reported as the upper bound of the containing power of 2 bucket.
+    ASSERT_EQ(histogram.percentile(0), 1);
+    ASSERT_EQ(histogram.percentile(50), 63);
+    ASSERT_EQ(histogram.percentile(99), 127);
+    ASSERT_EQ(histogram.percentile(100), 127);
+}
+
+static void histogram_extremes() {
+    auto histogram = StatHistogram {};
+    histogram.record(0);
+    ASSERT_EQ(histogram.percentile(100), 0);
+
+    histogram.record(di::NumericLimits<u64>::max);
+    ASSERT_EQ(histogram.percentile(100), di::NumericLimits<u64>::max);
+}
+
+static void input_latency() {
+    auto latency = InputLatency {};
+    auto received = dius::SteadyClock::now();
+
+    // Output and draws without a pending key press aren't measured.
+    latency.did_process_output(received);
+    latency.will_draw();
+    ASSERT(!latency.awaiting_frame());
+
+    latency.did_write_input(received, received + di::Microseconds(10));
+    ASSERT_EQ(latency.input_to_write_ns().count(), 1);
+    ASSERT_EQ(latency.input_to_write_ns().sum(), 10000);
+
+    // A second key press before the response keeps measuring from the first.
+    latency.did_write_input(received + di::Microseconds(50), received + di::Microseconds(60));
+    latency.did_process_output(received + di::Microseconds(100));
+    ASSERT_EQ(latency.input_to_output_ns().count(), 1);
+    ASSERT_EQ(latency.input_to_output_ns().sum(), 100000);
+
+    ASSERT(!latency.awaiting_frame());
+    latency.will_draw();
+    ASSERT(latency.awaiting_frame());
+
+    latency.did_present_frame(received + di::Microseconds(300));
+    ASSERT(!latency.awaiting_frame());
+    ASSERT_EQ(latency.input_to_frame_ns().count(), 1);
+    ASSERT_EQ(latency.input_to_frame_ns().sum(), 300000);
+
+    // Further frames don't record anything until there is another key press.
+    latency.did_process_output(received + di::Microseconds(400));
+    latency.will_draw();
+    latency.did_present_frame(received + di::Microseconds(500));
+    ASSERT_EQ(latency.input_to_output_ns().count(), 1);
+    ASSERT_EQ(latency.input_to_frame_ns().count(), 1);
+}
+
+TEST(stats, counter)
+TEST(stats, histogram)
+TEST(stats, histogram_extremes)
+TEST(stats, input_latency)
+}
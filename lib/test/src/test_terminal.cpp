@@ -0,0 +1,79 @@
+#include "di/test/prelude.h"
+#include "ttx/escape_sequence_parser.h"
+#include "ttx/terminal.h"
+
+namespace terminal {
+using namespace ttx;
+
+static auto make_terminal() -> Terminal {
+    return Terminal(0, { 4, 5 }, ttx::terminal::Palette::default_global(), {}, ttx::terminal::ThemeMode::Dark);
+}
+
+// Feeding results one at a time means a run of line feeds is never batched.
+static void feed_unbatched(Terminal& terminal, di::StringView data) {
+    auto parser = EscapeSequenceParser();
+    auto results = parser.parse_application_escape_sequences(data);
+    for (auto i : di::range(results.size())) {
+        terminal.on_parser_results(results.subspan(i, 1).value());
+    }
+}
+
+// Feeding results in chunks splits runs of line feeds across calls, so only part of a run is batched.
+static void feed_chunked(Terminal& terminal, di::StringView data, usize chunk_size) {
+    auto parser = EscapeSequenceParser();
+    auto results = parser.parse_application_escape_sequences(data);
+    while (!results.empty()) {
+        auto count = di::min(chunk_size, results.size());
+        terminal.on_parser_results(results.subspan(0, count).value());
+        results = results.subspan(count).value();
+    }
+}
+
+static void expect_same_as_unbatched(di::StringView data) {
+    for (auto chunk_size : { 2_usize, 3_usize, 5_usize, data.size_bytes() }) {
+        auto unbatched = make_terminal();
+        auto batched = make_terminal();
+        feed_unbatched(unbatched, data);
+        feed_chunked(batched, data, chunk_size);
+
+        ASSERT_EQ(unbatched.cursor_row(), batched.cursor_row());
+        ASSERT_EQ(unbatched.cursor_col(), batched.cursor_col());
+        ASSERT_EQ(unbatched.active_screen().screen.absolute_row_start(),
+                  batched.active_screen().screen.absolute_row_start());
+        ASSERT_EQ(unbatched.active_screen().screen.total_rows(), batched.active_screen().screen.total_rows());
+        ASSERT_EQ(unbatched.visual_scroll_offset(), batched.visual_scroll_offset());
+        ASSERT_EQ(unbatched.state_as_escape_sequences(), batched.state_as_escape_sequences());
+    }
+}
+
+static void batch_line_feeds() {
+    expect_same_as_unbatched("a\nb\nc\nd\n\n\n\n\n\n\ne\n\n\n\n\n\n\n\n\n\n\nf"_sv);
+}
+
+static void batch_line_feeds_carriage_return() {
+    // Carriage returns at the start, middle, and end of a run, including after a pending wrap.
+    expect_same_as_unbatched("ab\nc\r\nd\r\n\r\nefg\n\r\n\rhijklm\n\n\r\r\nn\n\n\r"_sv);
+    expect_same_as_unbatched("abcde\r\n\r\nfghij\n\n\n\rklmno\n\n\n\n\n\n\n"_sv);
+}
+
+static void batch_line_feeds_interrupted() {
+    // Other control characters and escape sequences end a run.
+    expect_same_as_unbatched("a\nb\nc\nd\n\n\tx\n\n\x1b[Ay\n\n\bz\n\n\n"_sv);
+}
+
+static void batch_line_feeds_scroll_region() {
+    // Line feeds above the region only move the cursor until it reaches the bottom of the region.
+    expect_same_as_unbatched("a\r\nb\r\nc\r\nd\x1b[2;3r\x1b[1;1He\n\n\n\n\n\n\nf\r\n\r\ng"_sv);
+
+    // Line feeds below the region never scroll.
+    expect_same_as_unbatched("a\r\nb\r\nc\r\nd\x1b[1;2r\x1b[3;2He\n\n\n\n\r\n\nf"_sv);
+
+    // Moving out of the region in the middle of the stream stops batching.
+    expect_same_as_unbatched("a\x1b[2;3r\x1b[3;1Hb\n\n\nc\x1b[4;1Hd\n\n\n\re\x1b[3;1H\n\n\nf"_sv);
+}
+
+TEST(terminal, batch_line_feeds)
+TEST(terminal, batch_line_feeds_carriage_return)
+TEST(terminal, batch_line_feeds_interrupted)
+TEST(terminal, batch_line_feeds_scroll_region)
+}
@@ -95,8 +95,45 @@ static void paste() {
     ASSERT_EQ(expected.size(), actual.size());
 }
 
+static void coalesce_motion() {
+    using namespace ttx;
+
+    auto move = [](MouseButton button, u32 x, Modifiers modifiers = Modifiers::None) {
+        return Event(MouseEvent(MouseEventType::Move, button, MousePosition({ x, 0 }), modifiers));
+    };
+
+    auto events = di::Vector<Event> {};
+    events.push_back(move(MouseButton::None, 1));
+    events.push_back(move(MouseButton::None, 2));
+    events.push_back(move(MouseButton::None, 3));
+    events.push_back(Event(MouseEvent::press(MouseButton::Left, MousePosition({ 3, 0 }))));
+    events.push_back(move(MouseButton::Left, 4));
+    events.push_back(move(MouseButton::Left, 5));
+    events.push_back(move(MouseButton::Left, 6, Modifiers::Shift));
+    events.push_back(Event(KeyEvent::key_down(Key::A)));
+    events.push_back(move(MouseButton::Left, 7));
+    events.push_back(Event(MouseEvent(MouseEventType::Release, MouseButton::Left, MousePosition({ 7, 0 }))));
+
+    auto expected = di::Array {
+        move(MouseButton::None, 3),
+        Event(MouseEvent::press(MouseButton::Left, MousePosition({ 3, 0 }))),
+        move(MouseButton::Left, 5),
+        move(MouseButton::Left, 6, Modifiers::Shift),
+        Event(KeyEvent::key_down(Key::A)),
+        move(MouseButton::Left, 7),
+        Event(MouseEvent(MouseEventType::Release, MouseButton::Left, MousePosition({ 7, 0 }))),
+    };
+
+    coalesce_mouse_motion(events);
+    for (auto const& [ex, ac] : di::zip(expected, events)) {
+        ASSERT_EQ(ex, ac);
+    }
+    ASSERT_EQ(expected.size(), events.size());
+}
+
 TEST(terminal_input, keyboard)
 TEST(terminal_input, mouse)
 TEST(terminal_input, focus)
 TEST(terminal_input, paste)
+TEST(terminal_input, coalesce_motion)
 }
@@ -0,0 +1,71 @@
+#include "di/test/prelude.h"
+#include "ttx/timer.h"
+
+namespace timer {
+using namespace ttx;
+
+static void queue() {
+    auto timers = TimerQueue {};
+    auto order = di::Vector<int> {};
+    auto record = [&](int value) {
+        return [&order, value] {
+            order.push_back(value);
+        };
+    };
+
+    auto t = dius::SteadyClock::TimePoint(di::chrono::Seconds(1000));
+    ASSERT(timers.empty());
+    ASSERT(!timers.next_deadline());
+
+    timers.add(t + di::Milliseconds(200), record(3));
+    timers.add(t + di::Milliseconds(100), record(1));
+    timers.add(t + di::Milliseconds(100), record(2));
+    ASSERT(timers.next_deadline().value() == t + di::Milliseconds(100));
+
+    // Nothing expires before the earliest deadline.
+    ASSERT(timers.take_expired(t).empty());
+
+    // Timers expire in deadline order, with ties in the order they were added.
+    for (auto& callback : timers.take_expired(t + di::Milliseconds(100))) {
+        callback();
+    }
+    ASSERT_EQ(order, (di::Vector { 1, 2 }));
+    ASSERT(timers.next_deadline().value() == t + di::Milliseconds(200));
+
+    for (auto& callback : timers.take_expired(t + di::Seconds(1))) {
+        callback();
+    }
+    ASSERT_EQ(order, (di::Vector { 1, 2, 3 }));
+    ASSERT(timers.empty());
+    ASSERT(!timers.next_deadline());
+}
+
+static void cancel() {
+    auto timers = TimerQueue {};
+    auto count = 0;
+    auto increment = [&] {
+        count++;
+    };
+
+    auto t = dius::SteadyClock::TimePoint(di::chrono::Seconds(1000));
+    auto first = timers.add(t + di::Milliseconds(100), increment);
+    timers.add(t + di::Milliseconds(200), increment);
+
+    // Cancelling the earliest timer moves the next deadline.
+    timers.cancel(first);
+    ASSERT(timers.next_deadline().value() == t + di::Milliseconds(200));
+
+    // Cancelling an unknown or expired timer does nothing.
+    timers.cancel(first);
+    timers.cancel(1000);
+
+    for (auto& callback : timers.take_expired(t + di::Seconds(1))) {
+        callback();
+    }
+    ASSERT_EQ(count, 1);
+    ASSERT(timers.empty());
+}
+
+TEST(timer, queue)
+TEST(timer, cancel)
+}
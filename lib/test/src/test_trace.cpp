@@ -0,0 +1,104 @@
+#include "di/test/prelude.h"
+#include "ttx/trace.h"
+
+namespace trace {
+using namespace ttx;
+
+static void record() {
+    auto tracer = Tracer("/tmp/unused.json"_p);
+    auto& buffer = tracer.create_buffer("test"_s);
+    ASSERT_EQ(buffer.id(), 1);
+    ASSERT(buffer.snapshot().empty());
+
+    auto start = dius::SteadyClock::now();
+    buffer.record(TraceEventType::PaneDraw, start, start + di::Microseconds(5), 3);
+    buffer.record(TraceEventType::DoRender, start, start + di::Microseconds(7));
+
+    auto events = buffer.snapshot();
+    ASSERT_EQ(events.size(), 2);
+    ASSERT(events[0].type == TraceEventType::PaneDraw);
+    ASSERT_EQ(events[0].duration_ns, 5000);
+    ASSERT_EQ(events[0].arg, 3);
+    ASSERT(events[1].type == TraceEventType::DoRender);
+    ASSERT_EQ(events[1].duration_ns, 7000);
+}
+
+static void wrap_around() {
+    auto tracer = Tracer("/tmp/unused.json"_p);
+    auto& buffer = tracer.create_buffer("test"_s);
+
+    // Only the most recent events are kept, oldest first.
+    auto start = dius::SteadyClock::now();
+    for (auto i : di::range(TraceBuffer::capacity + 10)) {
+        buffer.record(TraceEventType::PaneOutput, start, start, i);
+    }
+
+    auto events = buffer.snapshot();
+    ASSERT_EQ(events.size(), TraceBuffer::capacity);
+    ASSERT_EQ(events.front().value().arg, 10);
+    ASSERT_EQ(events.back().value().arg, TraceBuffer::capacity + 9);
+}
+
+static void json() {
+    auto tracer = Tracer("/tmp/unused.json"_p);
+    auto& render = tracer.create_buffer("render"_s);
+    (void) tracer.create_buffer("input"_s);
+
+    auto start = dius::SteadyClock::now();
+    render.record(TraceEventType::RendererFinish, start, start + di::Nanoseconds(1500), 0);
+
+    auto json = tracer.to_json();
+    ASSERT(json.starts_with(R"({"traceEvents":[)"_sv));
+    ASSERT(json.contains(R"({"name":"thread_name","ph":"M","pid":1,"tid":1,"args":{"name":"render"}})"_sv));
+    ASSERT(json.contains(R"({"name":"thread_name","ph":"M","pid":1,"tid":2,"args":{"name":"input"}})"_sv));
+    ASSERT(json.contains(R"("name":"Renderer::finish","ph":"X","pid":1,"tid":1,)"_sv));
+    ASSERT(json.contains(R"("dur":1.500,"args":{"pane":0}})"_sv));
+    ASSERT(json.ends_with("]}\n"_sv));
+}
+
+static void release() {
+    auto tracer = Tracer("/tmp/unused.json"_p);
+    auto& pane = tracer.create_buffer("pane"_s);
+    (void) tracer.create_buffer("render"_s);
+
+    auto start = dius::SteadyClock::now();
+    pane.record(TraceEventType::PaneOutput, start, start + di::Microseconds(2), 5);
+    tracer.release_buffer(pane);
+
+    // Released buffers still have their events written, and their ids aren't reused.
+    auto& next = tracer.create_buffer("next"_s);
+    ASSERT_EQ(next.id(), 3);
+
+    auto json = tracer.to_json();
+    ASSERT(json.contains(R"({"name":"thread_name","ph":"M","pid":1,"tid":1,"args":{"name":"pane"}})"_sv));
+    ASSERT(json.contains(R"("name":"Pane::process_output","ph":"X","pid":1,"tid":1,)"_sv));
+    ASSERT(json.contains(R"("dur":2.000,"args":{"pane":5}})"_sv));
+    ASSERT(json.contains(R"({"name":"thread_name","ph":"M","pid":1,"tid":2,"args":{"name":"render"}})"_sv));
+    ASSERT(json.contains(R"({"name":"thread_name","ph":"M","pid":1,"tid":3,"args":{"name":"next"}})"_sv));
+}
+
+static void release_limit() {
+    auto tracer = Tracer("/tmp/unused.json"_p);
+
+    // Fill more than the limit with released buffers. The oldest are dropped, but the newest are kept.
+    auto start = dius::SteadyClock::now();
+    auto buffer_count = Tracer::max_released_events / TraceBuffer::capacity + 1;
+    for (auto _ : di::range(buffer_count)) {
+        auto& buffer = tracer.create_buffer("pane"_s);
+        for (auto i : di::range(TraceBuffer::capacity)) {
+            buffer.record(TraceEventType::PaneOutput, start, start, i);
+        }
+        tracer.release_buffer(buffer);
+    }
+
+    auto json = tracer.to_json();
+    ASSERT(!json.contains(R"("tid":1,"args":{"name":"pane"}})"_sv));
+    ASSERT(json.contains(di::format(R"("tid":{},"args":{{"name":"pane"}}}})"_sv, buffer_count)));
+}
+
+TEST(trace, record)
+TEST(trace, wrap_around)
+TEST(trace, json)
+TEST(trace, release)
+TEST(trace, release_limit)
+}
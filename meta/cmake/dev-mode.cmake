@@ -6,6 +6,11 @@ if(BUILD_TESTING)
     include(meta/cmake/terminal-test.cmake)
 endif()
 
+option(BUILD_BENCHMARKS "Build throughput benchmarks" ON)
+if(BUILD_BENCHMARKS)
+    add_subdirectory(bench)
+endif()
+
 option(ENABLE_COVERAGE "Enable coverage support separate from CTest's" OFF)
 if(ENABLE_COVERAGE)
     include(meta/cmake/coverage.cmake)
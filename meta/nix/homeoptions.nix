@@ -9,6 +9,11 @@ let
         description = "Configure the way ttx interacts with the system clipboard when inner applications use OSC 52. By default ttx will read/write from the system clipboard. This requires configuring your terminal emulator to allow interacting with the system clipboard. If you do not want applications to access your system clipboard, specify the mode as 'local'";
         default = null;
       };
+      "max_bytes" = lib.mkOption {
+        type = nullOr (ints.u32);
+        description = "The maximum size in bytes of the text applications can copy to the clipboard. Larger writes are ignored, which bounds the memory used by the clipboard and how long copying can stall the outer terminal. A value of 0 disables the limit";
+        default = null;
+      };
     };
   };
   clipboardMode = enum [
@@ -318,6 +323,16 @@ let
         description = "The amount as a percentage to dim background panes when there is a popup";
         default = null;
       };
+      "draw_threads" = lib.mkOption {
+        type = nullOr (ints.u32);
+        description = "The number of threads used to draw terminal panes concurrently. When set to 0 or 1, all panes are drawn on the render thread";
+        default = null;
+      };
+      "max_pane_bytes_per_frame" = lib.mkOption {
+        type = nullOr (ints.u32);
+        description = "The maximum number of bytes of output processed for a single pane per frame (25 ms). Once exceeded, ttx stops reading from the pane until the next frame, which throttles programs producing output faster than it can be displayed. A value of 0 disables the limit";
+        default = null;
+      };
     };
   };
   session = submodule {
@@ -332,6 +347,11 @@ let
         description = "Automaticaly save the current layout to a file whenever updates occur. The layout is saved to $XDG_DATA_HOME/ttx/layouts (~/.local/share/ttx/layouts). The layout file is meant for use the `restore_layout` option";
         default = null;
       };
+      "save_pane_contents" = lib.mkOption {
+        type = nullOr (bool);
+        description = "Also save the contents of each pane, including its scroll back and shell integration commands, alongside the layout. The contents are restored when the layout is restored. Only new scroll back is written on each save, so this remains cheap for panes with a lot of history";
+        default = null;
+      };
       "layout_name" = lib.mkOption {
         type = nullOr (str);
         description = "Layout name to use for save/restore. This defaults the name of the chosen profile";
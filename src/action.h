@@ -12,6 +12,7 @@ class InputThread;
 
 struct ActionContext {
     KeyEvent const& key_event;
+    dius::SteadyClock::TimePoint key_event_time; ///< When the key event was read from the terminal
     di::Synchronized<LayoutState>& layout_state;
     RenderThread& render_thread;
     SaveLayoutThread& save_layout_thread;
@@ -485,18 +485,7 @@ auto reload_config() -> Action {
         .description = "Reload configuration files"_s,
         .apply =
             [](ActionContext const& context) {
-                auto new_config = config_json::v1::resolve_profile(context.profile, context.create_pane_args.theme_mode,
-                                                                   context.input_thread.outer_terminal_palette(),
-                                                                   di::clone(context.base_config));
-                if (!new_config) {
-                    context.render_thread.status_message(
-                        di::format("Failed to load configuration: {}"_sv, new_config.error()));
-                    return;
-                }
-
-                context.input_thread.set_config(di::clone(new_config.value()));
-                context.render_thread.set_config(di::clone(new_config.value()));
-                context.save_layout_thread.set_config(di::clone(new_config.value().session));
+                context.input_thread.request_reload_config();
             },
     };
 }
@@ -586,6 +575,24 @@ auto exit_pane() -> Action {
     };
 }
 
+auto cancel_paste() -> Action {
+    return {
+        .description = "Cancel the paste being sent to the active pane"_s,
+        .apply =
+            [](ActionContext const& context) {
+                auto did_cancel = context.layout_state.with_lock([&](LayoutState& state) {
+                    if (auto pane = state.active_pane()) {
+                        return pane->cancel_paste();
+                    }
+                    return false;
+                });
+                if (did_cancel) {
+                    context.render_thread.status_message("Cancelled paste"_s);
+                }
+            },
+    };
+}
+
 auto soft_reset() -> Action {
     return {
         .description = "Soft reset the active pane"_s,
@@ -884,6 +891,84 @@ auto switch_theme() -> Action {
     };
 }
 
+static auto format_histogram(di::StringView name, StatHistogram const& histogram, u64 divisor, di::StringView unit)
+    -> di::String {
+    return di::format("{}: count={} avg={}{} p50={}{} p99={}{}"_sv, name, histogram.count(),
+                      histogram.average() / divisor, unit, histogram.percentile(50) / divisor, unit,
+                      histogram.percentile(99) / divisor, unit);
+}
+
+auto show_stats() -> Action {
+    return {
+        .description = "Show performance statistics in a popup"_s,
+        .apply =
+            [](ActionContext const& context) {
+                auto lines = di::Vector<di::String> {};
+
+                auto const& render_stats = context.render_thread.stats();
+                lines.push_back(format_histogram("render: frame build"_sv, render_stats.frame_build_ns, 1000, "us"_sv));
+                lines.push_back(format_histogram("render: frame write"_sv, render_stats.frame_write_ns, 1000, "us"_sv));
+                lines.push_back(format_histogram("render: bytes per frame"_sv, render_stats.frame_bytes, 1, ""_sv));
+                lines.push_back(
+                    format_histogram("render: layout lock wait"_sv, render_stats.layout_lock_wait_ns, 1000, "us"_sv));
+                lines.push_back(format_histogram("input: layout lock wait"_sv,
+                                                 context.input_thread.layout_lock_wait_ns(), 1000, "us"_sv));
+
+                context.layout_state.with_lock([&](LayoutState& state) {
+                    state.for_each_pane([&](Pane& pane) {
+                        auto const& stats = pane.stats();
+                        auto title = pane.window_title().value_or(""_s);
+                        auto bytes_read = stats.bytes_read.value();
+                        auto parse_ns_per_kib = bytes_read ? stats.parse_ns.value() * 1024 / bytes_read : 0;
+                        lines.push_back(di::format("pane {} ({}): bytes read={} parse={}ns/KiB scroll back={}KiB"_sv,
+                                                   pane.id(), title, bytes_read, parse_ns_per_kib,
+                                                   pane.scroll_back_memory_usage() / 1024));
+                        lines.push_back(format_histogram(di::format("pane {}: terminal lock wait"_sv, pane.id()),
+                                                         stats.terminal_lock_wait_ns, 1000, "us"_sv));
+
+                        auto const& latency = stats.input_latency;
+                        lines.push_back(format_histogram(di::format("pane {}: key to pty write"_sv, pane.id()),
+                                                         latency.input_to_write_ns(), 1000, "us"_sv));
+                        lines.push_back(format_histogram(di::format("pane {}: key to output"_sv, pane.id()),
+                                                         latency.input_to_output_ns(), 1000, "us"_sv));
+                        lines.push_back(format_histogram(di::format("pane {}: key to frame"_sv, pane.id()),
+                                                         latency.input_to_frame_ns(), 1000, "us"_sv));
+                    });
+
+                    auto [create_pane_args, popup_layout] =
+                        FzfCommand()
+                            .with_prompt("Filter"_s)
+                            .with_title("Statistics"_s)
+                            .with_input(di::move(lines))
+                            .popup_args(context.create_pane_args.clone(), context.config.fzf);
+                    (void) state.popup_pane(popup_layout, di::move(create_pane_args), context.render_thread,
+                                            context.input_thread);
+                });
+                context.render_thread.request_render();
+            },
+    };
+}
+
+auto save_trace() -> Action {
+    return {
+        .description = "Write recorded trace events to the trace file"_s,
+        .apply =
+            [](ActionContext const& context) {
+                auto* tracer = context.input_thread.tracer();
+                if (!tracer) {
+                    context.render_thread.status_message("Tracing is not enabled (use --trace-path)"_s);
+                    return;
+                }
+                if (auto result = tracer->write(); !result) {
+                    context.render_thread.status_message(
+                        di::format("Failed to write trace file: {}"_sv, result.error()));
+                    return;
+                }
+                context.render_thread.status_message(di::format("Wrote trace file to {}"_sv, tracer->path()));
+            },
+    };
+}
+
 auto send_to_pane() -> Action {
     // NOTE: we need to hold the layout state lock the entire time
     // to prevent the Pane object from being prematurely destroyed.
@@ -893,7 +978,7 @@ auto send_to_pane() -> Action {
             [](ActionContext const& context) {
                 context.layout_state.with_lock([&](LayoutState& state) {
                     if (auto pane = state.active_pane()) {
-                        pane->event(context.key_event);
+                        pane->event(context.key_event, context.key_event_time);
                     }
                 });
             },
@@ -26,6 +26,7 @@ auto save_layout() -> Action;
 auto save_state(di::Path path) -> Action;
 auto stop_capture() -> Action;
 auto exit_pane() -> Action;
+auto cancel_paste() -> Action;
 auto soft_reset() -> Action;
 auto hard_reset() -> Action;
 auto toggle_full_screen_pane() -> Action;
@@ -39,5 +40,7 @@ auto scroll_prev_command() -> Action;
 auto scroll_next_command() -> Action;
 auto copy_last_command(bool include_command) -> Action;
 auto switch_theme() -> Action;
+auto show_stats() -> Action;
+auto save_trace() -> Action;
 auto send_to_pane() -> Action;
 }
@@ -25,17 +25,20 @@ struct InputConfig {
 
 struct ClipboardConfig {
     ClipboardMode mode { ClipboardMode::System };
+    u32 max_bytes { 10 * 1024 * 1024 };
 
     auto operator==(ClipboardConfig const&) const -> bool = default;
 
     constexpr friend auto tag_invoke(di::Tag<di::reflect>, di::InPlaceType<ClipboardConfig>) {
-        return di::make_fields<"ClipboardConfig">(di::field<"mode", &ClipboardConfig::mode>);
+        return di::make_fields<"ClipboardConfig">(di::field<"mode", &ClipboardConfig::mode>,
+                                                  di::field<"max_bytes", &ClipboardConfig::max_bytes>);
     }
 };
 
 struct SessionConfig {
     bool restore_layout { true };
     bool save_layout { true };
+    bool save_pane_contents { false };
     di::TransparentString layout_name;
 
     auto operator==(SessionConfig const&) const -> bool = default;
@@ -43,6 +46,7 @@ struct SessionConfig {
     constexpr friend auto tag_invoke(di::Tag<di::reflect>, di::InPlaceType<SessionConfig>) {
         return di::make_fields<"SessionConfig">(di::field<"restore_layout", &SessionConfig::restore_layout>,
                                                 di::field<"save_layout", &SessionConfig::save_layout>,
+                                                di::field<"save_pane_contents", &SessionConfig::save_pane_contents>,
                                                 di::field<"layout_name", &SessionConfig::layout_name>);
     }
 };
@@ -126,12 +130,17 @@ struct StatusBarConfig {
 struct RenderConfig {
     u32 inactive_dim_factor { 0 };
     u32 popup_dim_factor { 20 };
+    u32 draw_threads { 4 };
+    u32 max_pane_bytes_per_frame { 0 };
 
     auto operator==(RenderConfig const&) const -> bool = default;
 
     constexpr friend auto tag_invoke(di::Tag<di::reflect>, di::InPlaceType<RenderConfig>) {
         return di::make_fields<"RenderConfig">(di::field<"inactive_dim_factor", &RenderConfig::inactive_dim_factor>,
-                                               di::field<"popup_dim_factor", &RenderConfig::popup_dim_factor>);
+                                               di::field<"popup_dim_factor", &RenderConfig::popup_dim_factor>,
+                                               di::field<"draw_threads", &RenderConfig::draw_threads>,
+                                               di::field<"max_pane_bytes_per_frame",
+                                                         &RenderConfig::max_pane_bytes_per_frame>);
     }
 };
 
@@ -9,6 +9,7 @@
 #include "di/util/construct.h"
 #include "di/vocab/error/string_error.h"
 #include "dius/filesystem/directory_iterator.h"
+#include "dius/filesystem/operations.h"
 #include "dius/print.h"
 #include "dius/system/process.h"
 #include "theme.h"
@@ -55,14 +56,53 @@ static auto get_theme_search_paths() -> di::Result<di::Vector<di::Path>> {
     return result;
 }
 
-static auto resolve_config_path(di::Span<di::Path const> search_paths, di::TransparentStringView config_path)
-    -> di::Result<di::String> {
+static auto hash_directory(di::PathView path) -> di::Result<di::String> {
+    auto iterator = dius::filesystem::DirectoryIterator::create(
+        path.to_owned(), dius::filesystem::DirectoryOptions::FollowDirectorySymlink);
+    if (!iterator && iterator.error() == dius::PosixError::NoSuchFileOrDirectory) {
+        return di::String {};
+    }
+    if (!iterator) {
+        return di::Unexpected(
+            di::format_error("Failed to list directory contents of '{}': {}"_sv, path, iterator.error()));
+    }
+
+    // The directory iteration order is unspecified, so sort the names before hashing them.
+    auto names = di::TreeSet<di::TransparentString> {};
+    for (auto&& entry : iterator.value()) {
+        if (!entry) {
+            return di::Unexpected(
+                di::format_error("Failed to list directory contents of '{}': {}"_sv, path, entry.error()));
+        }
+        names.insert(entry->filename().value().data().to_owned());
+    }
+    auto key = di::String {};
+    for (auto const& name : names) {
+        key += di::format("{}\n"_sv, name);
+    }
+    return di::to_string(di::hash(key));
+}
+
+static auto read_config_file(di::PathView path, ConfigSources* sources) -> di::Result<di::String> {
+    auto result = dius::read_to_string(path);
+    if (sources && (result || result.error() == dius::PosixError::NoSuchFileOrDirectory)) {
+        // Missing files are recorded as well, since creating one may change which file is found.
+        sources->push_back(ConfigSource {
+            .path = di::to_utf8_string_lossy(path.data()),
+            .hash = result ? di::to_string(di::hash(result.value())) : di::String {},
+        });
+    }
+    return result;
+}
+
+static auto resolve_config_path(di::Span<di::Path const> search_paths, di::TransparentStringView config_path,
+                                ConfigSources* sources) -> di::Result<di::String> {
     if (config_path.starts_with('/')) {
-        return dius::read_to_string(di::PathView(config_path));
+        return read_config_file(di::PathView(config_path), sources);
     }
     for (auto const& dir : search_paths) {
         auto path = dir.clone() / config_path;
-        auto result = dius::read_to_string(path);
+        auto result = read_config_file(path, sources);
         if (result) {
             return di::move(result).value();
         }
@@ -72,7 +112,7 @@ static auto resolve_config_path(di::Span<di::Path const> search_paths, di::Trans
         if (!path.extension()) {
             path += ".json"_tsv;
         }
-        result = dius::read_to_string(path);
+        result = read_config_file(path, sources);
         if (result) {
             return di::move(result).value();
         }
@@ -250,13 +290,14 @@ static auto convert(di::TransparentStringView profile, Config&& json_config) ->
 }
 
 static auto load_config_recursively(di::Span<di::Path const> search_paths, di::TreeSet<di::TransparentString>& visited,
-                                    di::TransparentStringView config_name) -> di::Result<Config> {
+                                    di::TransparentStringView config_name, ConfigSources* sources)
+    -> di::Result<Config> {
     if (visited.contains(config_name)) {
         return di::Unexpected(
             di::format_error("Failed loading configuration due to circular import of config '{}'"_sv, config_name));
     }
 
-    auto maybe_profile_config = resolve_config_path(search_paths.span(), config_name);
+    auto maybe_profile_config = resolve_config_path(search_paths.span(), config_name, sources);
     if (!maybe_profile_config.has_value()) {
         // If no config file is found and this is the root config file, we just use the default configuration without
         // erroring.
@@ -275,7 +316,7 @@ static auto load_config_recursively(di::Span<di::Path const> search_paths, di::T
     if (config_json.extends.has_value()) {
         for (auto const& name : config_json.extends.value()) {
             auto name_ts = di::to_transparent_string(name);
-            auto subconfig = TRY(load_config_recursively(search_paths, visited, name_ts));
+            auto subconfig = TRY(load_config_recursively(search_paths, visited, name_ts, sources));
             merge(subconfig, di::move(config_json));
             config_json = di::move(subconfig);
         }
@@ -283,10 +324,17 @@ static auto load_config_recursively(di::Span<di::Path const> search_paths, di::T
     return config_json;
 }
 
-auto list_custom_themes() -> di::Result<di::Vector<ListedTheme>> {
+auto list_custom_themes(ConfigSources* sources) -> di::Result<di::Vector<ListedTheme>> {
     auto result = di::TreeMap<di::TransparentString, ListedTheme> {};
     auto const search_paths = TRY(get_theme_search_paths());
     for (auto const& path : search_paths) {
+        if (sources) {
+            sources->push_back(ConfigSource {
+                .path = di::to_utf8_string_lossy(path.data()),
+                .hash = TRY(hash_directory(path)),
+                .directory = true,
+            });
+        }
         auto iterator = dius::filesystem::DirectoryIterator::create(
             path.clone(), dius::filesystem::DirectoryOptions::FollowDirectorySymlink);
         if (!iterator && iterator.error() == dius::PosixError::NoSuchFileOrDirectory) {
@@ -302,7 +350,7 @@ auto list_custom_themes() -> di::Result<di::Vector<ListedTheme>> {
                     di::format_error("Failed to list directory contents of '{}': {}"_sv, path, iterator.error()));
             }
             auto name = entry->filename().value().stem().value().to_owned();
-            auto config = TRY(resolve_custom_theme(entry->path_view().data()));
+            auto config = TRY(resolve_custom_theme(entry->path_view().data(), sources));
             auto palette = convert_value(di::in_place_type<terminal::Palette>, di::move(config.colors));
             result.try_emplace(name, ListedTheme {
                                          .name = name.clone(),
@@ -315,12 +363,12 @@ auto list_custom_themes() -> di::Result<di::Vector<ListedTheme>> {
     return result | di::values | di::as_rvalue | di::to<di::Vector>();
 }
 
-auto resolve_custom_theme(di::TransparentStringView name) -> di::Result<Config> {
+auto resolve_custom_theme(di::TransparentStringView name, ConfigSources* sources) -> di::Result<Config> {
     if (name.empty()) {
         return di::Unexpected(di::format_error("Failed to find theme with name '{}'"_sv, name));
     }
     auto const search_paths = TRY(get_theme_search_paths());
-    auto maybe_theme = resolve_config_path(search_paths.span(), name);
+    auto maybe_theme = resolve_config_path(search_paths.span(), name, sources);
     if (!maybe_theme.has_value()) {
         return di::Unexpected(di::format_error("Failed to find theme with name '{}'"_sv, name));
     }
@@ -343,11 +391,11 @@ auto iterm2_themes() -> di::TreeMap<di::TransparentString, config_json::v1::Conf
 }
 #endif
 
-auto list_themes(ThemeSource source, terminal::Palette const& outer_terminal_palette)
+auto list_themes(ThemeSource source, terminal::Palette const& outer_terminal_palette, ConfigSources* sources)
     -> di::Result<di::Vector<ListedTheme>> {
     auto result = di::Vector<ListedTheme> {};
     if (source == ThemeSource::Custom || source == ThemeSource::All) {
-        result.append_container(TRY(list_custom_themes()) | di::as_rvalue);
+        result.append_container(TRY(list_custom_themes(sources)) | di::as_rvalue);
     }
     if (source == ThemeSource::BuiltIn || source == ThemeSource::All) {
         result.push_back(ListedTheme {
@@ -416,11 +464,11 @@ struct ApplyThemeDefaults {
 
 constexpr inline auto apply_theme_defaults = ApplyThemeDefaults {};
 
-auto resolve_theme(di::TransparentStringView name, terminal::Palette const& outer_terminal_palette)
-    -> di::Result<Config> {
+auto resolve_theme(di::TransparentStringView name, terminal::Palette const& outer_terminal_palette,
+                   ConfigSources* sources) -> di::Result<Config> {
     if (name.empty() || name == "auto"_tsv) {
         // Theme auto detection. First list all candidate themes.
-        auto all_themes = TRY(list_themes(ThemeSource::All, outer_terminal_palette));
+        auto all_themes = TRY(list_themes(ThemeSource::All, outer_terminal_palette, sources));
 
         // This algorithm is sub-optimal but its not that bad with only ~500 built-in themes.
         // Theme matching would be significantly more optimal by hashing the bottom 8 palette colors
@@ -433,12 +481,12 @@ auto resolve_theme(di::TransparentStringView name, terminal::Palette const& oute
                     auto index = terminal::PaletteIndex(index_number);
                     return theme.palette.get(index) == outer_terminal_palette.get(index);
                 })) {
-                return resolve_theme(theme.name.view(), outer_terminal_palette);
+                return resolve_theme(theme.name.view(), outer_terminal_palette, sources);
             }
         }
     }
 
-    auto result = resolve_custom_theme(name);
+    auto result = resolve_custom_theme(name, sources);
     if (!result) {
         if (name.empty() || name == "ansi"_tsv || name == "auto"_tsv) {
             auto result = Config {};
@@ -458,14 +506,14 @@ auto resolve_theme(di::TransparentStringView name, terminal::Palette const& oute
 
 auto resolve_profile_to_json(di::TransparentStringView profile, terminal::ThemeMode theme_preference,
                              terminal::Palette const& outer_terminal_palette, Config&& cli_config,
-                             bool should_resolve_theme) -> di::Result<Config> {
+                             bool should_resolve_theme, ConfigSources* sources) -> di::Result<Config> {
     auto profile_json = TRY([&] -> di::Result<Config> {
         if (profile.empty()) {
             return {};
         }
         auto const search_paths = TRY(get_search_paths());
         auto visited = di::TreeSet<di::TransparentString> {};
-        return load_config_recursively(search_paths.span(), visited, profile);
+        return load_config_recursively(search_paths.span(), visited, profile, sources);
     }());
     merge(profile_json, di::move(cli_config));
 
@@ -483,7 +531,7 @@ auto resolve_profile_to_json(di::TransparentStringView profile, terminal::ThemeM
         return profile_json.theme.name.transform(&di::String::view).value_or("auto"_sv);
     }();
     auto theme_name = di::to_transparent_string(theme_name_utf8);
-    auto theme = TRY(resolve_theme(theme_name, outer_terminal_palette));
+    auto theme = TRY(resolve_theme(theme_name, outer_terminal_palette, sources));
     merge(theme, di::move(profile_json));
     return theme;
 }
@@ -497,6 +545,137 @@ auto resolve_profile(di::TransparentStringView profile, terminal::ThemeMode them
     return convert(profile_name, di::move(config_json));
 }
 
+struct CachedProfile {
+    ConfigSources sources;
+    Config config;
+
+    constexpr friend auto tag_invoke(di::Tag<di::reflect>, di::InPlaceType<CachedProfile>) {
+        return di::make_fields<"CachedProfile">(di::field<"sources", &CachedProfile::sources>,
+                                                di::field<"config", &CachedProfile::config>);
+    }
+};
+
+static auto profile_cache_path(di::PathView cache_directory, di::TransparentStringView profile,
+                               terminal::ThemeMode theme_preference, terminal::Palette const& outer_terminal_palette,
+                               Config const& cli_config) -> di::Result<di::Path> {
+    // Everything which affects the result, other than the configuration files themselves, is part of the key.
+    // The built-in themes are compiled in, so their names stand in for their contents.
+    auto key = di::format("{}\n{}\n{}\n{}\n"_sv, profile, u32(theme_preference),
+                          TRY(di::to_json_string(config_from_palette(outer_terminal_palette))),
+                          TRY(di::to_json_string(cli_config)));
+    auto const search_paths = TRY(get_search_paths());
+    for (auto const& path : search_paths) {
+        key += di::format("{}\n"_sv, path);
+    }
+    for (auto const& [name, _] : built_in_themes()) {
+        key += di::format("{}\n"_sv, name);
+    }
+    for (auto const& [name, _] : iterm2_themes()) {
+        key += di::format("{}\n"_sv, name);
+    }
+    return cache_directory.to_owned() / di::to_transparent_string(di::to_string(di::hash(key)));
+}
+
+static auto is_source_current(ConfigSource const& source) -> bool {
+    auto path = di::to_transparent_string(source.path);
+    auto hash = [&] -> di::Result<di::String> {
+        if (source.directory) {
+            return hash_directory(di::PathView(path.view()));
+        }
+        auto contents = dius::read_to_string(di::PathView(path.view()));
+        if (!contents && contents.error() == dius::PosixError::NoSuchFileOrDirectory) {
+            return di::String {};
+        }
+        return contents.transform([](di::String const& contents) {
+            return di::to_string(di::hash(contents));
+        });
+    }();
+    return hash && hash.value() == source.hash;
+}
+
+static auto load_cached_profile(di::PathView path) -> di::Optional<Config> {
+    auto contents = dius::read_to_string(path);
+    if (!contents) {
+        return {};
+    }
+    auto cached = di::from_json_string<CachedProfile>(contents.value().view());
+    if (!cached || !di::all_of(cached.value().sources, is_source_current)) {
+        return {};
+    }
+    return di::move(cached.value().config);
+}
+
+static auto store_cached_profile(di::PathView path, Config const& config, ConfigSources&& sources) -> di::Result<> {
+    auto cached = CachedProfile {
+        .sources = di::move(sources),
+        .config = di::clone(config),
+    };
+    auto contents = TRY(di::to_json_string(cached));
+
+    // Write to a temporary file and rename it into place, so a concurrent reader never sees a partial entry.
+    auto temp_path = path.to_owned();
+    temp_path += ".tmp"_tsv;
+    {
+        auto file = TRY(dius::open_sync(temp_path, dius::OpenMode::WriteClobber));
+        TRY(file.write_exactly(di::as_bytes(contents.span())));
+    }
+    return dius::filesystem::rename(temp_path, path);
+}
+
+/// Each distinct outer terminal palette or command line config gets its own cache entry, so bound their number.
+constexpr auto max_cached_profiles = 16_usize;
+
+static void prune_profile_cache(di::PathView cache_directory, di::PathView keep) {
+    auto iterator = dius::filesystem::DirectoryIterator::create(
+        cache_directory.to_owned(), dius::filesystem::DirectoryOptions::FollowDirectorySymlink);
+    if (!iterator) {
+        return;
+    }
+
+    // Entries whose sources changed can never be used again, so those are always removed. After that, the
+    // directory order is arbitrary, so the entries kept past the limit are too.
+    auto kept = 1_usize;
+    auto to_remove = di::Vector<di::Path> {};
+    for (auto&& entry : iterator.value()) {
+        if (!entry) {
+            return;
+        }
+        auto path = entry->path_view();
+        if (path == keep) {
+            continue;
+        }
+        if (kept < max_cached_profiles && load_cached_profile(path)) {
+            kept++;
+            continue;
+        }
+        to_remove.push_back(path.to_owned());
+    }
+    for (auto const& path : to_remove) {
+        (void) dius::filesystem::remove(path);
+    }
+}
+
+auto resolve_profile_cached(di::PathView cache_directory, di::TransparentStringView profile,
+                            terminal::ThemeMode theme_preference, terminal::Palette const& outer_terminal_palette,
+                            Config&& cli_config) -> di::Result<ttx::Config> {
+    auto const profile_name = di::PathView(profile).stem().value_or(""_tsv);
+    auto cache_path =
+        profile_cache_path(cache_directory, profile, theme_preference, outer_terminal_palette, cli_config);
+    if (cache_path) {
+        if (auto cached = load_cached_profile(cache_path.value())) {
+            return convert(profile_name, di::move(cached).value());
+        }
+    }
+
+    auto sources = ConfigSources {};
+    auto config_json = TRY(resolve_profile_to_json(profile, theme_preference, outer_terminal_palette,
+                                                   di::move(cli_config), true, &sources));
+    if (cache_path && store_cached_profile(cache_path.value(), config_json, di::move(sources))) {
+        prune_profile_cache(cache_directory, cache_path.value());
+    }
+    return convert(profile_name, di::move(config_json));
+}
+
 auto config_from_palette(terminal::Palette const& palette) -> config_json::v1::Config {
     auto result = config_json::v1::Config {};
     result.colors = convert_value(di::in_place_type<Colors>, auto(palette));
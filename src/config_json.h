@@ -190,6 +190,7 @@ struct Fzf {
 
 struct Clipboard {
     di::Optional<ClipboardMode> mode {};
+    di::Optional<u32> max_bytes {};
 
     constexpr friend auto tag_invoke(di::Tag<di::reflect>, di::InPlaceType<Clipboard>) {
         return di::make_fields<"Clipboard", "Configuration relating to the clipboard handling of ttx (OSC 52)">(
@@ -197,13 +198,18 @@ struct Clipboard {
                       "Configure the way ttx interacts with the system clipboard when inner applications use OSC 52. "
                       "By default ttx will read/write from the system clipboard. This requires configuring your "
                       "terminal emulator to allow interacting with the system clipboard. If you do not want "
-                      "applications to access your system clipboard, specify the mode as 'local'">);
+                      "applications to access your system clipboard, specify the mode as 'local'">,
+            di::field<"max_bytes", &Clipboard::max_bytes,
+                      "The maximum size in bytes of the text applications can copy to the clipboard. Larger writes "
+                      "are ignored, which bounds the memory used by the clipboard and how long copying can stall "
+                      "the outer terminal. A value of 0 disables the limit">);
     }
 };
 
 struct Session {
     di::Optional<bool> restore_layout {};
     di::Optional<bool> save_layout {};
+    di::Optional<bool> save_pane_contents {};
     di::Optional<di::String> layout_name {};
 
     constexpr friend auto tag_invoke(di::Tag<di::reflect>, di::InPlaceType<Session>) {
@@ -217,6 +223,11 @@ struct Session {
                       "Automaticaly save the current layout to a file whenever updates occur. The layout is saved to "
                       "$XDG_DATA_HOME/ttx/layouts (~/.local/share/ttx/layouts). The layout file is meant for use the "
                       "`restore_layout` option">,
+            di::field<"save_pane_contents", &Session::save_pane_contents,
+                      "Also save the contents of each pane, including its scroll back and shell integration "
+                      "commands, alongside the layout. The contents are restored when the layout is restored. Only "
+                      "new scroll back is written on each save, so this remains cheap for panes with a lot of "
+                      "history">,
             di::field<"layout_name", &Session::layout_name,
                       "Layout name to use for save/restore. This defaults the name of the chosen profile">);
     }
@@ -287,6 +298,8 @@ struct Theme {
 struct Render {
     di::Optional<u32> inactive_dim_factor {};
     di::Optional<u32> popup_dim_factor {};
+    di::Optional<u32> draw_threads {};
+    di::Optional<u32> max_pane_bytes_per_frame {};
 
     constexpr friend auto tag_invoke(di::Tag<di::reflect>, di::InPlaceType<Render>) {
         return di::make_fields<"Render",
@@ -294,7 +307,14 @@ struct Render {
             di::field<"inactive_dim_factor", &Render::inactive_dim_factor,
                       "The amount as a percentage to dim non-active terminal panes">,
             di::field<"popup_dim_factor", &Render::popup_dim_factor,
-                      "The amount as a percentage to dim background panes when there is a popup">);
+                      "The amount as a percentage to dim background panes when there is a popup">,
+            di::field<"draw_threads", &Render::draw_threads,
+                      "The number of threads used to draw terminal panes concurrently. When set to 0 or 1, all panes "
+                      "are drawn on the render thread">,
+            di::field<"max_pane_bytes_per_frame", &Render::max_pane_bytes_per_frame,
+                      "The maximum number of bytes of output processed for a single pane per frame (25 ms). Once "
+                      "exceeded, ttx stops reading from the pane until the next frame, which throttles programs "
+                      "producing output faster than it can be displayed. A value of 0 disables the limit">);
     }
 };
 
@@ -339,22 +359,48 @@ struct Config {
     }
 };
 
-auto list_custom_themes() -> di::Result<di::Vector<ListedTheme>>;
-auto resolve_custom_theme(di::TransparentStringView name) -> di::Result<Config>;
+/// @brief A file or directory read while resolving a profile
+///
+/// These are recorded so that a cached profile can be revalidated without parsing any configuration files.
+struct ConfigSource {
+    di::String path;
+    di::String hash; ///< Hash of the file contents or directory entries, which is empty if it did not exist
+    bool directory { false };
+
+    constexpr friend auto tag_invoke(di::Tag<di::reflect>, di::InPlaceType<ConfigSource>) {
+        return di::make_fields<"ConfigSource">(di::field<"path", &ConfigSource::path>,
+                                               di::field<"hash", &ConfigSource::hash>,
+                                               di::field<"directory", &ConfigSource::directory>);
+    }
+};
+
+using ConfigSources = di::Vector<ConfigSource>;
+
+auto list_custom_themes(ConfigSources* sources = nullptr) -> di::Result<di::Vector<ListedTheme>>;
+auto resolve_custom_theme(di::TransparentStringView name, ConfigSources* sources = nullptr) -> di::Result<Config>;
 auto resolve_profile_to_json(di::TransparentStringView profile, terminal::ThemeMode theme_preference,
-                             terminal::Palette const& palette, Config&& cli_config = {}, bool resolve_theme = true)
-    -> di::Result<Config>;
+                             terminal::Palette const& palette, Config&& cli_config = {}, bool resolve_theme = true,
+                             ConfigSources* sources = nullptr) -> di::Result<Config>;
 auto convert_to_config(Config&& config) -> ttx::Config;
 auto resolve_profile(di::TransparentStringView profile, terminal::ThemeMode theme_preference,
                      terminal::Palette const& outer_terminal_palette, Config&& cli_config = {},
                      bool resolve_theme = true) -> di::Result<ttx::Config>;
+
+/// @brief Resolve a profile, reusing the result cached in \p cache_directory when none of its sources changed
+///
+/// Resolving the "auto" theme considers every custom and built-in theme, which is much slower than checking
+/// the hashes of the few files the result depends on. Failing to read or write the cache is not an error. Stale
+/// entries, and entries past a small limit, are pruned whenever a new entry is written.
+auto resolve_profile_cached(di::PathView cache_directory, di::TransparentStringView profile,
+                            terminal::ThemeMode theme_preference, terminal::Palette const& outer_terminal_palette,
+                            Config&& cli_config = {}) -> di::Result<ttx::Config>;
 auto config_with_defaults(Config&& config) -> Config;
-auto resolve_theme(di::TransparentStringView name, terminal::Palette const& outer_terminal_palette)
-    -> di::Result<config_json::v1::Config>;
+auto resolve_theme(di::TransparentStringView name, terminal::Palette const& outer_terminal_palette,
+                   ConfigSources* sources = nullptr) -> di::Result<config_json::v1::Config>;
 auto config_from_palette(terminal::Palette const& palette) -> config_json::v1::Config;
 void strip_empty_objects(di::json::Object& object);
-auto list_themes(ThemeSource source, terminal::Palette const& outer_terminal_palette)
-    -> di::Result<di::Vector<ListedTheme>>;
+auto list_themes(ThemeSource source, terminal::Palette const& outer_terminal_palette,
+                 ConfigSources* sources = nullptr) -> di::Result<di::Vector<ListedTheme>>;
 auto iterm2_themes() -> di::TreeMap<di::TransparentString, config_json::v1::Config> const&;
 auto built_in_themes() -> di::TreeMap<di::TransparentString, config_json::v1::Config> const&;
 auto json_schema() -> di::json::Object;
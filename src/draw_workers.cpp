@@ -0,0 +1,100 @@
+#include "draw_workers.h"
+
+namespace ttx {
+auto DrawWorkers::create(u32 thread_count) -> di::Result<di::Box<DrawWorkers>> {
+    auto result = di::make_box<DrawWorkers>();
+    for (auto _ : di::range(thread_count)) {
+        result->m_threads.push_back(TRY(dius::Thread::create([&self = *result.get()] {
+            self.worker_thread();
+        })));
+    }
+    return result;
+}
+
+DrawWorkers::~DrawWorkers() {
+    m_state.with_lock([&](State& state) {
+        state.exit = true;
+        for (auto _ : di::range(m_threads.size())) {
+            m_work_condition.notify_one();
+        }
+    });
+    for (auto& thread : m_threads) {
+        (void) thread.join();
+    }
+}
+
+void DrawWorkers::run(di::Span<di::Function<void()>> jobs) {
+    if (jobs.empty()) {
+        return;
+    }
+
+    m_state.with_lock([&](State& state) {
+        state.jobs = jobs;
+        state.next_job = 0;
+        state.pending_jobs = jobs.size();
+        for (auto _ : di::range(di::min(jobs.size() - 1, m_threads.size()))) {
+            m_work_condition.notify_one();
+        }
+    });
+
+    // Run jobs on this thread as well, until there are none left to claim.
+    for (;;) {
+        auto job = m_state.with_lock([&](State& state) -> di::Optional<di::Function<void()>&> {
+            if (state.next_job >= state.jobs.size()) {
+                return {};
+            }
+            return state.jobs[state.next_job++];
+        });
+        if (!job) {
+            break;
+        }
+        job.value()();
+        finish_job();
+    }
+
+    // Wait for the jobs claimed by the workers to complete.
+    auto lock = di::UniqueLock(m_state.get_lock());
+    m_done_condition.wait(lock, [&] {
+        // SAFETY: we acquired the lock manually above.
+        return m_state.get_assuming_no_concurrent_accesses().pending_jobs == 0;
+    });
+
+    // SAFETY: we acquired the lock manually above.
+    m_state.get_assuming_no_concurrent_accesses().jobs = {};
+}
+
+void DrawWorkers::worker_thread() {
+    for (;;) {
+        auto job = take_job();
+        if (!job) {
+            return;
+        }
+        job.value()();
+        finish_job();
+    }
+}
+
+auto DrawWorkers::take_job() -> di::Optional<di::Function<void()>&> {
+    auto lock = di::UniqueLock(m_state.get_lock());
+    m_work_condition.wait(lock, [&] {
+        // SAFETY: we acquired the lock manually above.
+        auto const& state = m_state.get_assuming_no_concurrent_accesses();
+        return state.exit || state.next_job < state.jobs.size();
+    });
+
+    // SAFETY: we acquired the lock manually above.
+    auto& state = m_state.get_assuming_no_concurrent_accesses();
+    if (state.exit) {
+        return {};
+    }
+    return state.jobs[state.next_job++];
+}
+
+void DrawWorkers::finish_job() {
+    m_state.with_lock([&](State& state) {
+        if (--state.pending_jobs == 0) {
+            m_done_condition.notify_one();
+        }
+    });
+}
+}
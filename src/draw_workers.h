@@ -0,0 +1,46 @@
+#pragma once
+
+#include "di/container/vector/vector.h"
+#include "di/function/container/function.h"
+#include "di/sync/synchronized.h"
+#include "di/vocab/error/result.h"
+#include "di/vocab/pointer/box.h"
+#include "di/vocab/span/prelude.h"
+#include "dius/condition_variable.h"
+#include "dius/thread.h"
+
+namespace ttx {
+/// @brief A fixed set of worker threads used by the render thread to draw panes concurrently.
+///
+/// Work is submitted as a batch of jobs, and the calling thread participates in running the
+/// jobs. This means a pool created with N threads can run N + 1 jobs at once.
+class DrawWorkers {
+public:
+    static auto create(u32 thread_count) -> di::Result<di::Box<DrawWorkers>>;
+
+    DrawWorkers() = default;
+    ~DrawWorkers();
+
+    auto thread_count() const -> u32 { return u32(m_threads.size()); }
+
+    /// @brief Run all jobs, returning once every job has completed.
+    void run(di::Span<di::Function<void()>> jobs);
+
+private:
+    void worker_thread();
+    auto take_job() -> di::Optional<di::Function<void()>&>;
+    void finish_job();
+
+    struct State {
+        di::Span<di::Function<void()>> jobs;
+        usize next_job { 0 };
+        usize pending_jobs { 0 };
+        bool exit { false };
+    };
+
+    di::Synchronized<State> m_state;
+    dius::ConditionVariable m_work_condition;
+    dius::ConditionVariable m_done_condition;
+    di::Vector<dius::Thread> m_threads;
+};
+}
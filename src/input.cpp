@@ -23,13 +23,25 @@
 #include "ttx/terminal_input.h"
 #include "ttx/utf8_stream_decoder.h"
 
+// dius has no way to wait on multiple files, so poll() is used directly.
+#include <errno.h>
+#include <poll.h>
+
 namespace ttx {
 auto InputThread::create(CreatePaneArgs create_pane_args, Config config, config_json::v1::Config base_config,
                          di::TransparentStringView profile, di::Synchronized<LayoutState>& layout_state,
-                         FeatureResult features, RenderThread& render_thread, SaveLayoutThread& save_layout_thread)
+                         dius::SyncFile& outer_terminal, FeatureResult features,
+                         di::Optional<di::Path> feature_cache_path, di::Optional<di::Path> config_cache_directory,
+                         RenderThread& render_thread, SaveLayoutThread& save_layout_thread, TimerThread* timers)
     -> di::Result<di::Box<InputThread>> {
-    auto result = di::make_box<InputThread>(di::move(create_pane_args), di::move(config), di::move(base_config),
-                                            profile, layout_state, features, render_thread, save_layout_thread);
+    auto result = di::make_box<InputThread>(
+        di::move(create_pane_args), di::move(config), di::move(base_config), profile, layout_state, outer_terminal,
+        features, di::move(feature_cache_path), di::move(config_cache_directory), render_thread, save_layout_thread,
+        timers);
+    result->m_wake_pipe = TRY(dius::open_pipe());
+    result->m_reload_thread = TRY(dius::Thread::create([&self = *result.get()] {
+        self.reload_config_thread();
+    }));
     result->m_thread = TRY(dius::Thread::create([&self = *result.get()] {
         self.input_thread();
     }));
@@ -39,34 +51,52 @@ auto InputThread::create(CreatePaneArgs create_pane_args, Config config, config_
 auto InputThread::create_mock(di::Synchronized<LayoutState>& layout_state, RenderThread& render_thread,
                               SaveLayoutThread& save_layout_thread) -> di::Box<InputThread> {
     return di::make_box<InputThread>(CreatePaneArgs {}, Config {}, config_json::v1::Config {}, ""_tsv, layout_state,
-                                     FeatureResult { Feature::All }, render_thread, save_layout_thread);
+                                     dius::std_in, FeatureResult { Feature::All }, di::Optional<di::Path> {},
+                                     di::Optional<di::Path> {}, render_thread, save_layout_thread);
 }
 
 InputThread::InputThread(CreatePaneArgs create_pane_args, Config config, config_json::v1::Config base_config,
                          di::TransparentStringView profile, di::Synchronized<LayoutState>& layout_state,
-                         FeatureResult features, RenderThread& render_thread, SaveLayoutThread& save_layout_thread)
+                         dius::SyncFile& outer_terminal, FeatureResult features,
+                         di::Optional<di::Path> feature_cache_path, di::Optional<di::Path> config_cache_directory,
+                         RenderThread& render_thread, SaveLayoutThread& save_layout_thread, TimerThread* timers)
     : m_config(di::move(config))
     , m_base_config(di::move(base_config))
     , m_profile(profile)
-    , m_key_binds(make_key_binds(m_config.input, create_pane_args.replay_path.has_value()))
+    , m_key_binds(KeyBindTable(make_key_binds(m_config.input, create_pane_args.replay_path.has_value())))
     , m_create_pane_args(di::move(create_pane_args))
     , m_layout_state(layout_state)
+    , m_outer_terminal(outer_terminal)
     , m_render_thread(render_thread)
     , m_save_layout_thread(save_layout_thread)
+    , m_timers(timers)
     , m_features(features.features)
+    , m_feature_cache_path(di::move(feature_cache_path))
+    , m_config_cache_directory(di::move(config_cache_directory))
     , m_outer_terminal_palette(features.palette)
-    , m_rng(u32(dius::SteadyClock::now().time_since_epoch().count())) {}
+    , m_rng(u32(dius::SteadyClock::now().time_since_epoch().count()))
+    , m_trace(m_create_pane_args.tracer ? &m_create_pane_args.tracer->create_buffer("input"_s) : nullptr) {}
 
 InputThread::~InputThread() {
     request_exit();
     (void) m_thread.join();
+
+    // The reload thread checks m_done while holding the lock, so notifying with the lock held can't be missed.
+    m_reload_request.with_lock([&](di::Optional<ReloadRequest>&) {
+        m_reload_condition.notify_one();
+    });
+    (void) m_reload_thread.join();
 }
 
 void InputThread::request_exit() {
     if (!m_done.exchange(true, di::MemoryOrder::Release)) {
-        // Ensure the input thread exits. (By requesting device attributes, thus waking up the input thread).
-        // It would be better to use something else to cancel the input thread.
-        (void) dius::std_in.write_exactly(di::as_bytes("\033[c"_sv.span()));
+        // Ensure the input thread exits. Without a wake pipe, request device attributes, which wakes up the input
+        // thread once the outer terminal replies.
+        if (m_wake_pipe) {
+            request_wake();
+        } else {
+            (void) m_outer_terminal.write_exactly(di::as_bytes("\033[c"_sv.span()));
+        }
     }
 }
 
@@ -81,11 +111,38 @@ void InputThread::set_input_mode(InputMode mode) {
 
 void InputThread::set_config(Config config) {
     auto palette_did_change = config.colors != m_config.colors;
+    auto max_bytes_per_frame_did_change =
+        config.render.max_pane_bytes_per_frame != m_config.render.max_pane_bytes_per_frame;
+    auto max_clipboard_bytes_did_change = config.clipboard.max_bytes != m_config.clipboard.max_bytes;
     m_config = di::move(config);
-    m_key_binds = make_key_binds(m_config.input, m_create_pane_args.replay_path.has_value());
+    m_key_binds = KeyBindTable(make_key_binds(m_config.input, m_create_pane_args.replay_path.has_value()));
     m_create_pane_args.command = m_config.shell.command.clone();
     m_create_pane_args.save_state_path = m_config.input.save_state_path.clone();
     m_create_pane_args.term = m_config.terminfo.term.clone();
+    m_create_pane_args.max_bytes_per_frame = m_config.render.max_pane_bytes_per_frame;
+    m_create_pane_args.max_clipboard_bytes = m_config.clipboard.max_bytes;
+
+    if (max_bytes_per_frame_did_change) {
+        m_layout_state.with_lock([&](LayoutState& state) {
+            state.for_each_pane([&](Pane& pane) {
+                pane.set_max_bytes_per_frame(m_config.render.max_pane_bytes_per_frame);
+            });
+            state.for_each_placeholder_args([&](CreatePaneArgs& args) {
+                args.max_bytes_per_frame = m_config.render.max_pane_bytes_per_frame;
+            });
+        });
+    }
+
+    if (max_clipboard_bytes_did_change) {
+        m_layout_state.with_lock([&](LayoutState& state) {
+            state.for_each_pane([&](Pane& pane) {
+                pane.set_max_clipboard_bytes(m_config.clipboard.max_bytes);
+            });
+            state.for_each_placeholder_args([&](CreatePaneArgs& args) {
+                args.max_clipboard_bytes = m_config.clipboard.max_bytes;
+            });
+        });
+    }
 
     if (palette_did_change) {
         auto global_palette = m_config.colors;
@@ -100,11 +157,79 @@ void InputThread::set_config(Config config) {
             state.for_each_pane([&](Pane& pane) {
                 pane.set_global_palette(global_palette);
             });
+            state.for_each_placeholder_args([&](CreatePaneArgs& args) {
+                args.global_palette = global_palette;
+            });
         });
         m_create_pane_args.global_palette = global_palette;
     }
 }
 
+void InputThread::request_reload_config() {
+    // A newer request replaces one which hasn't started yet. Since there's a single reload thread, an older
+    // reload never overwrites the result of a newer one, and the input thread never waits for a reload.
+    m_reload_request.with_lock([&](di::Optional<ReloadRequest>& request) {
+        request = ReloadRequest {
+            .theme_mode = m_create_pane_args.theme_mode,
+            .outer_terminal_palette = m_outer_terminal_palette,
+        };
+        m_reload_condition.notify_one();
+    });
+}
+
+void InputThread::reload_config_thread() {
+    for (;;) {
+        auto request = [&] {
+            auto lock = di::UniqueLock(m_reload_request.get_lock());
+            m_reload_condition.wait(lock, [&] {
+                // SAFETY: we acquired the lock manually above.
+                return m_done.load(di::MemoryOrder::Acquire) ||
+                       m_reload_request.get_assuming_no_concurrent_accesses().has_value();
+            });
+
+            // SAFETY: we acquired the lock manually above.
+            return di::exchange(m_reload_request.get_assuming_no_concurrent_accesses(), di::nullopt);
+        }();
+        if (m_done.load(di::MemoryOrder::Acquire) || !request) {
+            return;
+        }
+
+        reload_config(request.value().theme_mode, request.value().outer_terminal_palette);
+    }
+}
+
+void InputThread::reload_config(terminal::ThemeMode theme_mode, terminal::Palette const& outer_terminal_palette) {
+    // The profile, base config, and cache directory never change, so they can be read from the reload thread.
+    auto new_config = m_config_cache_directory
+                          ? config_json::v1::resolve_profile_cached(m_config_cache_directory.value(), m_profile,
+                                                                    theme_mode, outer_terminal_palette,
+                                                                    di::clone(m_base_config))
+                          : config_json::v1::resolve_profile(m_profile, theme_mode, outer_terminal_palette,
+                                                             di::clone(m_base_config));
+    if (!new_config) {
+        m_render_thread.status_message(di::format("Failed to load configuration: {}"_sv, new_config.error()));
+        return;
+    }
+
+    m_render_thread.set_config(di::clone(new_config.value()));
+    m_save_layout_thread.set_config(di::clone(new_config.value().session));
+    m_reloaded_config.with_lock([&](di::Optional<Config>& config) {
+        config = di::move(new_config).value();
+    });
+
+    // The config must be applied on the input thread, which may be blocked reading from the terminal.
+    request_wake();
+}
+
+void InputThread::apply_reloaded_config() {
+    auto config = m_reloaded_config.with_lock([](di::Optional<Config>& config) {
+        return di::exchange(config, di::nullopt);
+    });
+    if (config) {
+        set_config(di::move(config).value());
+    }
+}
+
 void InputThread::input_thread() {
     auto _ = di::ScopeExit([&] {
         m_render_thread.request_exit();
@@ -114,17 +239,40 @@ void InputThread::input_thread() {
     auto buffer = di::Vector<byte> {};
     buffer.resize(4096);
 
+    // When the features were loaded from the cache, query the terminal again in the background. The replies
+    // are collected until the primary device attributes reply arrives, which ends the query.
+    if (m_feature_cache_path) {
+        m_feature_replies.emplace();
+        m_render_thread.push_event(WriteString { feature_detection_query() });
+    }
+
     auto parser = TerminalInputParser {};
     auto utf8_decoder = Utf8StreamDecoder {};
     while (!m_done.load(di::MemoryOrder::Acquire)) {
-        auto nread = dius::std_in.read_some(buffer.span());
+        auto readable = wait_for_input();
+        if (!readable || m_done.load(di::MemoryOrder::Acquire)) {
+            return;
+        }
+        if (!readable.value()) {
+            // Woken up without any input, to apply a reloaded config or time out pending events.
+            apply_reloaded_config();
+            process_pending_events();
+            continue;
+        }
+
+        auto nread = m_outer_terminal.read_some(buffer.span());
         if (!nread.has_value() || m_done.load(di::MemoryOrder::Acquire)) {
             return;
         }
 
+        if (m_feature_replies) {
+            m_feature_replies.value().append_container(buffer | di::take(*nread));
+        }
+
         auto now = dius::SteadyClock::now();
         auto utf8_string = utf8_decoder.decode(buffer | di::take(*nread));
         auto events = parser.parse(utf8_string, m_features);
+        coalesce_mouse_motion(events);
         m_pending_events.with_lock([&](auto& pending_events) {
             for (auto& event : events) {
                 pending_events.push_back({
@@ -134,12 +282,13 @@ void InputThread::input_thread() {
             }
         });
 
+        apply_reloaded_config();
         process_pending_events();
     }
 }
 
 void InputThread::process_pending_events() {
-    constexpr auto timeout = di::Milliseconds(200);
+    auto _ = TraceSpan(m_trace, TraceEventType::ProcessPendingEvents);
 
     while (!m_done.load(di::MemoryOrder::Acquire)) {
         auto first = m_pending_events.lock()->pop_front();
@@ -148,7 +297,7 @@ void InputThread::process_pending_events() {
         }
 
         // Check for timeout.
-        if (first->pending && dius::SteadyClock::now() > first->receptionTime + timeout) {
+        if (first->pending && dius::SteadyClock::now() >= first->receptionTime + pending_event_timeout) {
             di::visit(
                 [&](auto& x) {
                     if constexpr (requires { this->handle_event(x, true); }) {
@@ -165,6 +314,8 @@ void InputThread::process_pending_events() {
             break;
         }
 
+        m_event_reception_time = first->receptionTime;
+
         auto was_processed = di::visit(
             [&](auto& x) {
                 if constexpr (requires { this->handle_event(x, false); }) {
@@ -176,19 +327,61 @@ void InputThread::process_pending_events() {
             },
             first->event);
         if (!was_processed) {
-            // Add the event back in but mark it as pending.
+            // Add the event back in but mark it as pending. Since the input thread may be blocked reading
+            // from the terminal, use a timer to wake it up once the event times out.
             first->pending = true;
+            auto deadline = first->receptionTime + pending_event_timeout;
             m_pending_events.lock()->push_back(di::move(first).value());
+            if (m_timers) {
+                m_timers->add(deadline, [this] {
+                    request_wake();
+                });
+            }
             break;
         }
     }
 }
 
+void InputThread::request_wake() {
+    if (m_wake_pipe && !m_wake_requested.exchange(true, di::MemoryOrder::Release)) {
+        auto data = di::Array<byte, 1> { byte(1) };
+        (void) di::get<1>(m_wake_pipe.value()).write_exactly(data.span());
+    }
+}
+
+auto InputThread::wait_for_input() -> di::Result<bool> {
+    if (!m_wake_pipe) {
+        return true;
+    }
+
+    auto& wake_reader = di::get<0>(m_wake_pipe.value());
+    auto fds = di::Array {
+        pollfd { .fd = m_outer_terminal.file_descriptor(), .events = POLLIN, .revents = 0 },
+        pollfd { .fd = wake_reader.file_descriptor(), .events = POLLIN, .revents = 0 },
+    };
+    while (::poll(fds.data(), fds.size(), -1) < 0) {
+        if (errno != EINTR) {
+            return di::Unexpected(dius::PosixError(errno));
+        }
+    }
+
+    if (fds[1].revents & POLLIN) {
+        // Writes are coalesced by m_wake_requested, so there's at most a single byte to read. The flag is cleared
+        // before processing anything, so a wake requested after this point writes another byte.
+        auto data = di::Array<byte, 1> {};
+        (void) wake_reader.read_some(data.span());
+        m_wake_requested.store(false, di::MemoryOrder::Release);
+    }
+    return fds[0].revents != 0;
+}
+
 void InputThread::handle_event(KeyEvent&& event) {
     // Popup panes swallow all key events.
+    auto lock_start = dius::SteadyClock::now();
     if (m_layout_state.with_lock([&](LayoutState& state) -> bool {
+            m_layout_lock_wait_ns.record(elapsed_ns(lock_start));
             for (auto& pane : state.active_popup()) {
-                pane.event(event);
+                pane.event(event, m_event_reception_time);
                 return true;
             }
             return false;
@@ -196,33 +389,25 @@ void InputThread::handle_event(KeyEvent&& event) {
         return;
     }
 
-    for (auto const& bind : m_key_binds) {
-        // Ignore key up events and modifier keys when not in insert mode.
-        if (m_mode != InputMode::Insert && (event.type() == KeyEventType::Release ||
-                                            (event.key() > Key::ModifiersBegin && event.key() < Key::ModifiersEnd))) {
-            continue;
-        }
-
-        auto modifiers = event.modifiers() & ~(Modifiers::LockModifiers);
-        auto key_matches = bind.key == Key::None || (event.type() != KeyEventType::Release && event.key() == bind.key &&
-                                                     modifiers == bind.modifiers);
-        if (m_mode == bind.mode && key_matches) {
-            bind.action.apply({
-                .key_event = event,
-                .layout_state = m_layout_state,
-                .render_thread = m_render_thread,
-                .save_layout_thread = m_save_layout_thread,
-                .input_thread = *this,
-                .create_pane_args = m_create_pane_args,
-                .config = m_config,
-                .base_config = m_base_config,
-                .profile = m_profile,
-                .done = m_done,
-            });
-            set_input_mode(bind.next_mode);
-            return;
-        }
+    auto const* bind = m_key_binds.lookup(m_mode, event);
+    if (!bind) {
+        return;
     }
+
+    bind->action.apply({
+        .key_event = event,
+        .key_event_time = m_event_reception_time,
+        .layout_state = m_layout_state,
+        .render_thread = m_render_thread,
+        .save_layout_thread = m_save_layout_thread,
+        .input_thread = *this,
+        .create_pane_args = m_create_pane_args,
+        .config = m_config,
+        .base_config = m_base_config,
+        .profile = m_profile,
+        .done = m_done,
+    });
+    set_input_mode(bind->next_mode);
 }
 
 void InputThread::handle_event(MouseEvent&& event) {
@@ -264,35 +449,16 @@ void InputThread::handle_event(MouseEvent&& event) {
         // Check if the user is dragging the pane edge.
         if (m_drag_origin) {
             // The intended amount the user wants to move is determined by the amount of motion between the drag
-            // origin and the current position. Each mouse event is consolidated into single ticks where the cursor
-            // only moves by 1 cell at a time.
-            auto current_position = m_drag_origin.value();
+            // origin and the current position. The motion is split into a vertical and a horizontal step, each of
+            // which resizes by the full distance. Since motion events are coalesced, a fast drag is applied as
+            // a single resize, and the layout is only recomputed once.
             auto end_position = ev.position().in_cells();
-
-            auto do_drag = [&](MouseCoordinate const& coordinate) {
-                if (handle_drag(state, coordinate)) {
-                    state.layout();
-                    state.layout_did_update();
-                }
-            };
-
-            while (current_position.y() < end_position.y()) {
-                current_position = { current_position.x(), current_position.y() + 1 };
-                do_drag(current_position);
-            }
-            while (current_position.y() > end_position.y()) {
-                current_position = { current_position.x(), current_position.y() - 1 };
-                do_drag(current_position);
-            }
-            while (current_position.x() < end_position.x()) {
-                current_position = { current_position.x() + 1, current_position.y() };
-                do_drag(current_position);
+            auto did_resize_vertically = handle_drag(state, { m_drag_origin.value().x(), end_position.y() });
+            auto did_resize_horizontally = handle_drag(state, end_position);
+            if (did_resize_vertically || did_resize_horizontally) {
+                state.layout();
+                state.layout_did_update();
             }
-            while (current_position.x() > end_position.x()) {
-                current_position = { current_position.x() - 1, current_position.y() };
-                do_drag(current_position);
-            }
-            ASSERT_EQ(current_position, end_position);
             return;
         }
 
@@ -322,6 +488,29 @@ void InputThread::handle_event(MouseEvent&& event) {
     });
 }
 
+void InputThread::handle_event(terminal::PrimaryDeviceAttributes&&) {
+    if (!m_feature_replies || !m_feature_cache_path) {
+        return;
+    }
+
+    auto replies = di::move(m_feature_replies).value();
+    m_feature_replies = {};
+    auto result = features_from_replies(replies.span());
+    if (!result) {
+        return;
+    }
+
+    if (result.value().restore_mode_2027) {
+        m_render_thread.push_event(WriteString { "\033[?2027l"_s });
+    }
+    (void) store_cached_features(m_feature_cache_path.value(), replies.span());
+    m_feature_cache_path = {};
+
+    // Even when the features didn't change, the query reset the graphics rendition, so always redraw.
+    m_features = result.value().features;
+    m_render_thread.push_event(UpdateFeatures { m_features });
+}
+
 void InputThread::handle_event(terminal::DarkLightModeDetectionReport&& report) {
     if (report.mode != m_create_pane_args.theme_mode) {
         m_create_pane_args.theme_mode = report.mode;
@@ -329,6 +518,9 @@ void InputThread::handle_event(terminal::DarkLightModeDetectionReport&& report)
             state.for_each_pane([&](Pane& pane) {
                 pane.set_theme_mode(report.mode);
             });
+            state.for_each_placeholder_args([&](CreatePaneArgs& args) {
+                args.theme_mode = report.mode;
+            });
         });
         m_force_reload_config_on_osc21 = true;
     }
@@ -362,6 +554,9 @@ void InputThread::handle_event(terminal::OSC21&& osc21) {
             state.for_each_pane([&](Pane& pane) {
                 pane.set_global_palette(global_palette);
             });
+            state.for_each_placeholder_args([&](CreatePaneArgs& args) {
+                args.global_palette = global_palette;
+            });
         });
         m_create_pane_args.global_palette = global_palette;
         m_render_thread.push_event(UpdateOuterTerminalPalette(m_outer_terminal_palette));
@@ -370,16 +565,7 @@ void InputThread::handle_event(terminal::OSC21&& osc21) {
 
         // Reload configuration, as the "auto" theme may resolve differently now, as will the "dark" and
         // "light" specific theme configuration.
-        auto new_config = config_json::v1::resolve_profile(m_profile, m_create_pane_args.theme_mode,
-                                                           m_outer_terminal_palette, di::clone(m_base_config));
-        if (!new_config) {
-            m_render_thread.status_message(di::format("Failed to load configuration: {}"_sv, new_config.error()));
-            return;
-        }
-
-        set_config(di::clone(new_config.value()));
-        m_render_thread.set_config(di::clone(new_config.value()));
-        m_save_layout_thread.set_config(di::clone(new_config.value().session));
+        request_reload_config();
     }
 }
 
@@ -394,7 +580,7 @@ void InputThread::handle_event(FocusEvent&& event) {
 void InputThread::handle_event(PasteEvent&& event) {
     m_layout_state.with_lock([&](LayoutState& state) {
         if (auto pane = state.active_pane()) {
-            pane->event(event);
+            pane->event(di::move(event));
         }
     });
 }
@@ -517,8 +703,13 @@ auto InputThread::handle_drag(LayoutState& state, MouseCoordinate const& coordin
     }
     ASSERT(x_amount == 0 || y_amount == 0);
 
+    // Hit test the cell next to the drag origin in the direction of motion, which is on the other side of the
+    // edge being dragged. The resize is then applied for the full amount of motion.
+    auto hit_row = u32(i32(m_drag_origin.value().y()) - di::clamp(y_amount, -1, 1));
+    auto hit_col = u32(i32(m_drag_origin.value().x()) - di::clamp(x_amount, -1, 1));
+
     auto& tab = state.active_tab().value();
-    auto direct_entry = tab.layout_tree()->hit_test(coordinate.y(), coordinate.x());
+    auto direct_entry = tab.layout_tree()->hit_test(hit_row, hit_col);
     for (auto const& entry : direct_entry) {
         if (di::abs(y_amount) > 0 &&
             (m_drag_origin.value().y() == entry.row - 1 || m_drag_origin.value().y() == entry.row + entry.size.rows)) {
@@ -3,6 +3,7 @@
 #include "config.h"
 #include "di/random/prelude.h"
 #include "di/reflect/prelude.h"
+#include "dius/condition_variable.h"
 #include "input_mode.h"
 #include "key_bind.h"
 #include "layout_state.h"
@@ -13,6 +14,7 @@
 #include "ttx/mouse.h"
 #include "ttx/pane.h"
 #include "ttx/paste_event.h"
+#include "ttx/stats.h"
 #include "ttx/terminal/escapes/device_attributes.h"
 #include "ttx/terminal/escapes/device_status.h"
 #include "ttx/terminal/escapes/mode.h"
@@ -22,33 +24,53 @@
 #include "ttx/terminal/navigation_direction.h"
 #include "ttx/terminal/palette.h"
 #include "ttx/terminal_input.h"
+#include "ttx/timer.h"
+#include "ttx/trace.h"
 
 namespace ttx {
 class RenderThread;
 
 class InputThread {
 public:
+    /// @brief Create the input thread, which reads events from \p outer_terminal
     static auto create(CreatePaneArgs create_pane_args, Config config, config_json::v1::Config base_config,
                        di::TransparentStringView profile, di::Synchronized<LayoutState>& layout_state,
-                       FeatureResult features, RenderThread& render_thread, SaveLayoutThread& save_layout_thread)
+                       dius::SyncFile& outer_terminal, FeatureResult features,
+                       di::Optional<di::Path> feature_cache_path, di::Optional<di::Path> config_cache_directory,
+                       RenderThread& render_thread, SaveLayoutThread& save_layout_thread, TimerThread* timers)
         -> di::Result<di::Box<InputThread>>;
     static auto create_mock(di::Synchronized<LayoutState>& layout_state, RenderThread& render_thread,
                             SaveLayoutThread& save_layout_thread) -> di::Box<InputThread>;
 
     explicit InputThread(CreatePaneArgs create_pane_args, Config config, config_json::v1::Config base_config,
                          di::TransparentStringView profile, di::Synchronized<LayoutState>& layout_state,
-                         FeatureResult features, RenderThread& render_thread, SaveLayoutThread& save_layout_thread);
+                         dius::SyncFile& outer_terminal, FeatureResult features,
+                         di::Optional<di::Path> feature_cache_path, di::Optional<di::Path> config_cache_directory,
+                         RenderThread& render_thread, SaveLayoutThread& save_layout_thread,
+                         TimerThread* timers = nullptr);
     ~InputThread();
 
     void request_exit();
     void request_navigate(terminal::NavigateDirection direction);
     void set_config(Config config);
+
+    /// @brief Reload the configuration files on a background thread
+    ///
+    /// The render and save layout threads are updated directly once the configuration is resolved, while the
+    /// input thread is woken up to apply it. Requests made while a reload is running are coalesced.
+    void request_reload_config();
     auto config() const -> Config const& { return m_config; };
     auto profile() const -> di::TransparentStringView { return m_profile; }
     auto base_config() const -> config_json::v1::Config const& { return m_base_config; }
     auto outer_terminal_palette() const -> terminal::Palette const& { return m_outer_terminal_palette; }
     auto create_pane_args() const -> CreatePaneArgs const& { return m_create_pane_args; }
 
+    /// @brief Time spent waiting for the layout state lock when handling key events.
+    auto layout_lock_wait_ns() const -> StatHistogram const& { return m_layout_lock_wait_ns; }
+
+    /// @brief The event tracer, which is only present when tracing was requested.
+    auto tracer() const -> Tracer* { return m_create_pane_args.tracer; }
+
     void notify_osc_8671(terminal::OSC8671&& osc_8671);
 
 private:
@@ -60,7 +82,7 @@ private:
     void handle_event(MouseEvent&& event);
     void handle_event(FocusEvent&& event);
     void handle_event(PasteEvent&& event);
-    void handle_event(terminal::PrimaryDeviceAttributes&&) {}
+    void handle_event(terminal::PrimaryDeviceAttributes&&);
     void handle_event(terminal::ModeQueryReply&&) {}
     void handle_event(terminal::CursorPositionReport&&) {}
     void handle_event(terminal::KittyKeyReport&&) {}
@@ -73,8 +95,32 @@ private:
 
     auto handle_drag(LayoutState& state, MouseCoordinate const& coordinate) -> bool;
 
+    /// @brief How long to wait for a pending event (like a seamless navigation request) to be resolved
+    constexpr static auto pending_event_timeout = di::Milliseconds(200);
+
     void process_pending_events();
 
+    /// @brief Wake the input thread, which is blocked waiting for input from the outer terminal
+    ///
+    /// This writes to a pipe which the input thread polls alongside the outer terminal, after which it processes
+    /// its pending events. Requests made before the input thread wakes up are coalesced.
+    void request_wake();
+
+    /// @brief Wait until the outer terminal is readable or request_wake() is called
+    ///
+    /// Returns whether the outer terminal is readable. Without a wake pipe, this returns true immediately.
+    auto wait_for_input() -> di::Result<bool>;
+
+    /// @brief A request to resolve the configuration again, using the input thread's state when it was made
+    struct ReloadRequest {
+        terminal::ThemeMode theme_mode { terminal::ThemeMode::Dark };
+        terminal::Palette outer_terminal_palette;
+    };
+
+    void reload_config_thread();
+    void reload_config(terminal::ThemeMode theme_mode, terminal::Palette const& outer_terminal_palette);
+    void apply_reloaded_config();
+
     struct PendingEvent {
         Event event;
         dius::SteadyClock::TimePoint receptionTime;
@@ -85,18 +131,32 @@ private:
     Config m_config;
     config_json::v1::Config m_base_config;
     di::TransparentStringView m_profile;
-    di::Vector<KeyBind> m_key_binds;
+    KeyBindTable m_key_binds;
     CreatePaneArgs m_create_pane_args;
     di::Atomic<bool> m_done { false };
+    di::Atomic<bool> m_wake_requested { false };
     bool m_force_reload_config_on_osc21 { false };
     di::Optional<MouseCoordinate> m_drag_origin;
+    dius::SteadyClock::TimePoint m_event_reception_time {}; ///< When the event being handled was read
     di::Synchronized<LayoutState>& m_layout_state;
+    dius::SyncFile& m_outer_terminal;
     di::Synchronized<di::Ring<PendingEvent>> m_pending_events;
     RenderThread& m_render_thread;
     SaveLayoutThread& m_save_layout_thread;
+    TimerThread* m_timers { nullptr }; ///< Used to wake up the input thread once pending events time out
     Feature m_features { Feature::None };
+    di::Optional<di::Path> m_feature_cache_path;      ///< When set, the cached features need revalidating
+    di::Optional<di::Path> m_config_cache_directory;  ///< When set, resolved profiles are cached here
+    di::Optional<di::Vector<byte>> m_feature_replies; ///< Bytes read while revalidating the cached features
     terminal::Palette m_outer_terminal_palette;
     di::MinstdRand m_rng;
+    StatHistogram m_layout_lock_wait_ns;
+    TraceBuffer* m_trace { nullptr };
+    di::Synchronized<di::Optional<ReloadRequest>> m_reload_request; ///< Only the latest request is kept
+    dius::ConditionVariable m_reload_condition;
+    di::Synchronized<di::Optional<Config>> m_reloaded_config;
+    dius::Thread m_reload_thread;
+    di::Optional<di::Tuple<dius::SyncFile, dius::SyncFile>> m_wake_pipe; ///< Read end, then write end
     dius::Thread m_thread;
 };
 }
@@ -114,6 +114,44 @@ static auto make_replay_key_binds() -> di::Vector<KeyBind> {
     return result;
 }
 
+KeyBindTable::KeyBindTable(di::Vector<KeyBind> binds) : m_binds(di::move(binds)) {
+    for (auto [i, bind] : di::enumerate(m_binds)) {
+        if (bind.is_default()) {
+            auto& default_index = m_default_bind_index[usize(bind.mode)];
+            if (!default_index) {
+                default_index = i;
+            }
+        } else {
+            // Only the first bind for a given key is reachable.
+            m_bind_index.try_emplace(di::make_tuple(bind.mode, bind.key, bind.modifiers), i);
+        }
+    }
+}
+
+auto KeyBindTable::lookup(InputMode mode, KeyEvent const& event) const -> KeyBind const* {
+    // Ignore key up events and modifier keys when not in insert mode.
+    if (mode != InputMode::Insert && (event.type() == KeyEventType::Release ||
+                                      (event.key() > Key::ModifiersBegin && event.key() < Key::ModifiersEnd))) {
+        return nullptr;
+    }
+
+    // Key up events only match default binds.
+    auto index = m_default_bind_index[usize(mode)];
+    if (event.type() != KeyEventType::Release) {
+        auto modifiers = event.modifiers() & ~(Modifiers::LockModifiers);
+        for (auto exact_index : m_bind_index.at(di::make_tuple(mode, event.key(), modifiers))) {
+            // The bind which comes first wins, just as if the binds were scanned in order.
+            if (!index || exact_index < index.value()) {
+                index = exact_index;
+            }
+        }
+    }
+    if (!index) {
+        return nullptr;
+    }
+    return &m_binds[index.value()];
+}
+
 auto make_key_binds(InputConfig const& config, bool replay_mode) -> di::Vector<KeyBind> {
     if (replay_mode) {
         return make_replay_key_binds();
@@ -210,6 +248,12 @@ auto make_key_binds(InputConfig const& config, bool replay_mode) -> di::Vector<K
             .mode = InputMode::Normal,
             .action = hard_reset(),
         });
+        result.push_back({
+            .key = Key::T,
+            .modifiers = Modifiers::Shift,
+            .mode = InputMode::Normal,
+            .action = save_trace(),
+        });
         result.push_back({
             .key = Key::T,
             .mode = InputMode::Normal,
@@ -221,6 +265,11 @@ auto make_key_binds(InputConfig const& config, bool replay_mode) -> di::Vector<K
             .mode = InputMode::Normal,
             .action = stop_capture(),
         });
+        result.push_back({
+            .key = Key::I,
+            .mode = InputMode::Normal,
+            .action = show_stats(),
+        });
         result.push_back({
             .key = Key::S,
             .modifiers = Modifiers::Shift,
@@ -232,6 +281,11 @@ auto make_key_binds(InputConfig const& config, bool replay_mode) -> di::Vector<K
             .mode = InputMode::Normal,
             .action = exit_pane(),
         });
+        result.push_back({
+            .key = Key::Escape,
+            .mode = InputMode::Normal,
+            .action = cancel_paste(),
+        });
         result.push_back({
             .key = Key::Z,
             .mode = InputMode::Normal,
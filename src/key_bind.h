@@ -2,9 +2,11 @@
 
 #include "action.h"
 #include "config.h"
+#include "di/container/tree/tree_map.h"
 #include "di/reflect/prelude.h"
 #include "input_mode.h"
 #include "ttx/key.h"
+#include "ttx/key_event.h"
 #include "ttx/modifiers.h"
 
 namespace ttx {
@@ -26,4 +28,26 @@ struct KeyBind {
 };
 
 auto make_key_binds(InputConfig const& config, bool replay_mode) -> di::Vector<KeyBind>;
+
+/// @brief Key binds indexed by mode, key, and modifiers.
+///
+/// Lookups behave exactly like scanning the list of binds in order and taking the first match, where
+/// a default bind (with key None) matches any key in its mode. Instead of scanning, the first bind for
+/// each exact (mode, key, modifiers) triple and the first default bind for each mode are computed up front.
+class KeyBindTable {
+public:
+    KeyBindTable() = default;
+    explicit KeyBindTable(di::Vector<KeyBind> binds);
+
+    auto lookup(InputMode mode, KeyEvent const& event) const -> KeyBind const*;
+
+    auto binds() const -> di::Span<KeyBind const> { return m_binds.span(); }
+
+private:
+    constexpr static auto mode_count = usize(InputMode::Resize) + 1;
+
+    di::Vector<KeyBind> m_binds;
+    di::TreeMap<di::Tuple<InputMode, Key, Modifiers>, usize> m_bind_index;
+    di::Array<di::Optional<usize>, mode_count> m_default_bind_index;
+};
 }
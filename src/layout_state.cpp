@@ -264,6 +264,14 @@ void LayoutState::for_each_pane(di::FunctionRef<void(Pane&)> action) {
     }
 }
 
+void LayoutState::for_each_placeholder_args(di::FunctionRef<void(CreatePaneArgs&)> action) {
+    for (auto const& session : m_sessions) {
+        for (auto const& tab : session->tabs()) {
+            tab->for_each_placeholder_args(action);
+        }
+    }
+}
+
 auto LayoutState::make_pane_with_default_hooks(CreatePaneArgs args, Size const& size, Clipboard::Identifier identifier,
                                                RenderThread& render_thread, InputThread& input_thread)
     -> di::Result<di::Box<Pane>> {
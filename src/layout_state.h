@@ -65,6 +65,9 @@ public:
 
     void for_each_pane(di::FunctionRef<void(Pane&)>);
 
+    /// @brief Update the arguments used to create the panes of tabs which haven't been restored yet.
+    void for_each_placeholder_args(di::FunctionRef<void(CreatePaneArgs&)>);
+
     auto available_size() const -> Size { return hide_status_bar() ? m_size : m_size.rows_shrinked(1); }
 
     auto make_pane_with_default_hooks(CreatePaneArgs args, Size const& size, Clipboard::Identifier identifier,
@@ -1,11 +1,13 @@
 #include "render.h"
 
+#include "di/container/tree/tree_set.h"
 #include "dius/print.h"
 #include "dius/system/process.h"
 #include "input_mode.h"
 #include "layout_state.h"
 #include "tab_name.h"
 #include "theme.h"
+#include "ttx/base64.h"
 #include "ttx/clipboard.h"
 #include "ttx/layout.h"
 #include "ttx/mouse.h"
@@ -15,11 +17,12 @@
 #include "ttx/terminal/graphics_rendition.h"
 
 namespace ttx {
-auto RenderThread::create(di::Synchronized<LayoutState>& layout_state, di::Function<void()> did_exit, Config config,
-                          Feature features, terminal::Palette const& outer_terminal_palette)
+auto RenderThread::create(di::Synchronized<LayoutState>& layout_state, dius::SyncFile& outer_terminal,
+                          di::Function<void()> did_exit, Config config, Feature features,
+                          terminal::Palette const& outer_terminal_palette, Tracer* tracer, TimerThread* timers)
     -> di::Result<di::Box<RenderThread>> {
-    auto result = di::make_box<RenderThread>(layout_state, di::move(did_exit), di::move(config), features,
-                                             outer_terminal_palette);
+    auto result = di::make_box<RenderThread>(layout_state, outer_terminal, di::move(did_exit), di::move(config),
+                                             features, outer_terminal_palette, tracer, timers);
     result->m_thread = TRY(dius::Thread::create([&self = *result.get()] {
         self.render_thread();
     }));
@@ -27,17 +30,22 @@ auto RenderThread::create(di::Synchronized<LayoutState>& layout_state, di::Funct
 }
 
 auto RenderThread::create_mock(di::Synchronized<LayoutState>& layout_state) -> RenderThread {
-    return RenderThread(layout_state, nullptr, {}, Feature::All, {});
+    return RenderThread(layout_state, dius::std_in, nullptr, {}, Feature::All, {});
 }
 
-RenderThread::RenderThread(di::Synchronized<LayoutState>& layout_state, di::Function<void()> did_exit, Config config,
-                           Feature features, terminal::Palette const& outer_terminal_palette)
+RenderThread::RenderThread(di::Synchronized<LayoutState>& layout_state, dius::SyncFile& outer_terminal,
+                           di::Function<void()> did_exit, Config config, Feature features,
+                           terminal::Palette const& outer_terminal_palette, Tracer* tracer, TimerThread* timers)
     : m_layout_state(layout_state)
+    , m_outer_terminal(outer_terminal)
     , m_did_exit(di::move(did_exit))
     , m_outer_terminal_palette(outer_terminal_palette)
-    , m_clipboard(config.clipboard.mode, features)
+    , m_clipboard(config.clipboard.mode, features, config.clipboard.max_bytes)
     , m_config(di::move(config))
-    , m_features(features) {}
+    , m_features(features)
+    , m_tracer(tracer)
+    , m_trace(tracer ? &tracer->create_buffer("render"_s) : nullptr)
+    , m_timers(timers) {}
 
 RenderThread::~RenderThread() {
     (void) m_thread.join();
@@ -50,6 +58,24 @@ void RenderThread::push_event(RenderEvent event) {
     });
 }
 
+// Forward a clipboard write to the outer terminal. The selection is encoded in fixed size chunks, instead of
+// serializing the whole sequence up front, so that large selections don't need a second copy in memory. The
+// sequence can't be interleaved with frame output, so it is always written completely.
+static auto write_clipboard(dius::SyncFile& output, terminal::OSC52 const& osc52, di::Span<byte const> data)
+    -> di::Result<> {
+    constexpr auto chunk_size = 48_usize * 1024; // Must be a multiple of 3 to avoid padding between chunks.
+
+    auto buffer = di::Vector<byte> {};
+    buffer.append_container(di::as_bytes(di::format("\033]52;{};"_sv, osc52.serialize_selections()).span()));
+    for (auto offset = 0_usize; offset < data.size(); offset += chunk_size) {
+        base64_encode(data.subspan(offset, di::min(chunk_size, data.size() - offset)).value(), buffer);
+        TRY(output.write_exactly(buffer.span()));
+        buffer.clear();
+    }
+    buffer.append_container(di::as_bytes("\033\\"_sv.span()));
+    return output.write_exactly(buffer.span());
+}
+
 // NOLINTNEXTLINE(readability-function-cognitive-complexity)
 void RenderThread::render_thread() {
     auto _ = di::ScopeExit([&] {
@@ -60,9 +86,11 @@ void RenderThread::render_thread() {
 
     auto renderer = Renderer();
     auto _ = di::ScopeExit([&] {
-        (void) renderer.cleanup(dius::std_in);
+        (void) renderer.cleanup(m_outer_terminal);
     });
 
+    update_draw_workers();
+
     auto deadline = dius::SteadyClock::now();
     auto do_setup = true;
     for (;;) {
@@ -95,6 +123,7 @@ void RenderThread::render_thread() {
                 new_size = ev.value();
             } else if (auto ev = di::get_if<PaneExited>(event)) {
                 // Exit pane.
+                m_tiles.erase(ev->pane);
                 auto [pane, should_exit] = m_layout_state.with_lock([&](LayoutState& state) {
                     auto pane = state.remove_pane(*ev->session, *ev->tab, ev->pane);
                     return di::Tuple { di::move(pane), state.empty() };
@@ -114,7 +143,7 @@ void RenderThread::render_thread() {
             } else if (auto ev = di::get_if<InputStatus>(event)) {
                 m_input_status = *ev;
             } else if (auto ev = di::get_if<WriteString>(event)) {
-                (void) dius::std_in.write_exactly(di::as_bytes(ev->string.span()));
+                (void) m_outer_terminal.write_exactly(di::as_bytes(ev->string.span()));
             } else if (auto ev = di::get_if<MouseEvent>(event)) {
                 if (ev->type() == MouseEventType::Press && ev->button() == MouseButton::Left) {
                     auto* it = di::find_if(m_status_bar_layout, [&](StatusBarEntry const& entry) {
@@ -149,13 +178,18 @@ void RenderThread::render_thread() {
                         auto string = ev->osc52.serialize();
                         if (m_clipboard.request_clipboard(selection_type, ev->identifier.value())) {
                             // Forward the query.
-                            (void) dius::std_in.write_exactly(di::as_bytes(string.span()));
+                            (void) m_outer_terminal.write_exactly(di::as_bytes(string.span()));
                         }
+                    } else if (auto size = di::max(ev->osc52.oversized, ev->osc52.data.container().size());
+                               ev->osc52.oversized != 0 || m_clipboard.exceeds_max_size(size)) {
+                        m_pending_status_message = {
+                            di::format("Ignored copying {} bytes, which exceeds clipboard.max_bytes"_sv, size),
+                            dius::SteadyClock::now() + di::chrono::Seconds(5),
+                        };
                     } else {
-                        auto string = ev->osc52.serialize();
                         if (m_clipboard.set_clipboard(selection_type, di::move(ev->osc52.data).container())) {
                             // Forward setting the clipboard.
-                            (void) dius::std_in.write_exactly(di::as_bytes(string.span()));
+                            (void) write_clipboard(m_outer_terminal, ev->osc52, m_clipboard.data(selection_type));
                         }
                         if (ev->manual) {
                             m_pending_status_message = {
@@ -176,7 +210,9 @@ void RenderThread::render_thread() {
                     }
                 });
                 m_clipboard.set_mode(ev->config.clipboard.mode);
+                m_clipboard.set_max_size(ev->config.clipboard.max_bytes);
                 m_config = di::move(ev->config);
+                update_draw_workers();
             } else if (auto ev = di::get_if<UpdateOuterTerminalPalette>(event)) {
                 m_layout_state.with_lock([&](LayoutState& state) {
                     for (auto& tab : state.active_tab()) {
@@ -201,8 +237,18 @@ void RenderThread::render_thread() {
                     osc21.requests.push_back(terminal::OSC21::Request { .query = true, .palette = index });
                 }
                 auto string = osc21.serialize(m_features);
-                (void) dius::std_in.write_exactly(di::as_bytes(string.span()));
+                (void) m_outer_terminal.write_exactly(di::as_bytes(string.span()));
                 renderer.flush_palette_color_state();
+            } else if (auto ev = di::get_if<UpdateFeatures>(event)) {
+                m_features = ev->features;
+                m_clipboard.set_features(ev->features);
+                renderer.invalidate();
+                m_layout_state.with_lock([&](LayoutState& state) {
+                    for (auto& tab : state.active_tab()) {
+                        tab.invalidate_all();
+                    }
+                });
+                do_setup = true;
             } else if (auto ev = di::get_if<DoRender>(event)) {
                 // Do nothing. This was just to wake us up.
             } else if (auto ev = di::get_if<Exit>(event)) {
@@ -236,20 +282,61 @@ void RenderThread::render_thread() {
 
         // Do terminal setup if requested.
         if (do_setup) {
-            (void) renderer.setup(dius::std_in, m_features);
+            (void) renderer.setup(m_outer_terminal, m_features);
             do_setup = false;
         }
 
         // Maybe expire pending status message.
-        if (m_pending_status_message && dius::SteadyClock::now() > m_pending_status_message.value().expiration) {
+        if (m_pending_status_message && dius::SteadyClock::now() >= m_pending_status_message.value().expiration) {
             m_pending_status_message.reset();
         }
+        schedule_wake();
 
         // Do render.
         do_render(renderer);
     }
 }
 
+void RenderThread::schedule_wake() {
+    // The render thread only wakes up for events, so use a timer to remove the status message and time out
+    // clipboard requests on time, even if nothing else happens.
+    auto deadline = m_clipboard.next_expiration();
+    if (m_pending_status_message) {
+        auto expiration = m_pending_status_message.value().expiration;
+        deadline = deadline ? di::min(deadline.value(), expiration) : expiration;
+    }
+    if (!m_timers || deadline == m_wake_deadline) {
+        return;
+    }
+
+    if (m_wake_deadline) {
+        m_timers->cancel(m_wake_timer);
+    }
+    m_wake_deadline = deadline;
+    if (deadline) {
+        m_wake_timer = m_timers->add(deadline.value(), [this] {
+            request_render();
+        });
+    }
+}
+
+void RenderThread::update_draw_workers() {
+    // The render thread participates in drawing, so we need 1 less worker thread than requested.
+    auto const thread_count = di::max(m_config.render.draw_threads, 1u) - 1;
+    if (thread_count == (m_draw_workers ? m_draw_workers->thread_count() : 0)) {
+        return;
+    }
+
+    m_draw_workers = {};
+    m_tiles.clear();
+    if (thread_count == 0) {
+        return;
+    }
+    if (auto workers = DrawWorkers::create(thread_count)) {
+        m_draw_workers = di::move(workers).value();
+    }
+}
+
 struct PositionAndSize {
     static auto operator()(di::Box<LayoutNode> const& node) -> di::Tuple<u32, u32, Size> {
         return { node->row, node->col, node->size };
@@ -268,6 +355,10 @@ struct Render {
     Tab& tab;
     LayoutState& state;
     bool have_top_status_bar { false };
+    bool force_draw { false };
+    di::Vector<LayoutEntry const*>* deferred { nullptr };
+    TraceBuffer* trace { nullptr };
+    di::Vector<u64>* awaiting_frame { nullptr };
 
     auto border_code_point(Direction direction, u32 pos, di::Span<u32 const>& interior_intersections,
                            di::Span<u32 const>& exterior_intersections) -> c32 {
@@ -319,12 +410,34 @@ struct Render {
     }
 
     void operator()(LayoutEntry const& entry) {
-        auto const is_active = entry.pane == state.active_pane().data();
-        auto _ = is_active ? renderer.set_dim_factor(0) : di::ScopeExit<di::Function<void()>>([] {});
+        // When requested, defer drawing updated panes so that they can be drawn concurrently.
+        if (deferred && entry.pane->dirty()) {
+            deferred->push_back(&entry);
+            return;
+        }
+        draw(entry);
+    }
+
+    auto is_active(LayoutEntry const& entry) const -> bool { return entry.pane == state.active_pane().data(); }
+
+    void draw(LayoutEntry const& entry) {
+        auto _ = is_active(entry) ? renderer.set_dim_factor(0) : di::ScopeExit<di::Function<void()>>([] {});
 
         renderer.set_bound(entry.row + have_top_status_bar, entry.col, entry.size.cols, entry.size.rows);
-        auto [pane_cursor, bg] = entry.pane->draw(renderer);
-        if (is_active) {
+        auto [pane_cursor, bg] = [&] {
+            auto _ = TraceSpan(trace, TraceEventType::PaneDraw, entry.pane->id());
+            return entry.pane->draw(renderer, force_draw);
+        }();
+        did_draw(entry, pane_cursor, bg);
+    }
+
+    void did_draw(LayoutEntry const& entry, RenderedCursor pane_cursor, terminal::Color bg) {
+        if (awaiting_frame && entry.pane->stats().input_latency.awaiting_frame()) {
+            awaiting_frame->push_back(entry.pane->id());
+        }
+
+        auto const active = is_active(entry);
+        if (active) {
             pane_cursor.cursor_row += have_top_status_bar;
             pane_cursor.cursor_row += entry.row;
             pane_cursor.cursor_col += entry.col;
@@ -332,12 +445,66 @@ struct Render {
         }
 
         // Propogate the background color if there is only 1 visible pane.
-        if (is_active && (tab.full_screen_pane() || tab.panes().size() == 1)) {
+        if (active && (tab.full_screen_pane() || tab.panes().size() == 1)) {
             bg_color = bg;
         }
     }
 };
 
+// Draw each pane into its own tile concurrently, and then compose the tiles into the renderer. Only the
+// drawing happens concurrently, as composing the tiles and computing the final diff can't be parallelized.
+//
+// When tracing, each job index gets its own trace buffer. Jobs only measure their draw, and the spans are recorded
+// by this thread once all jobs complete, so that each buffer still has a single writer.
+static void draw_concurrently(Render& render, DrawWorkers* workers, di::TreeMap<Pane*, Renderer>& tiles,
+                              di::Span<LayoutEntry const* const> entries, Tracer* tracer,
+                              di::Vector<TraceBuffer*>& job_traces) {
+    // Drawing a single pane concurrently has no benefit, and would add the overhead of composing its tile.
+    if (!workers || entries.size() < 2) {
+        for (auto const* entry : entries) {
+            render.draw(*entry);
+        }
+        return;
+    }
+
+    // Create the tiles up front on this thread, since the tile map can't be modified concurrently.
+    auto results = di::Vector<di::Tuple<RenderedCursor, terminal::Color>> {};
+    results.resize(entries.size());
+    auto timings = di::Vector<di::Tuple<dius::SteadyClock::TimePoint, dius::SteadyClock::TimePoint>> {};
+    timings.resize(entries.size());
+    auto jobs = di::Vector<di::Function<void()>> {};
+    for (auto [i, entry] : di::enumerate(entries)) {
+        auto& tile = tiles[entry->pane];
+        tile.start_tile(render.renderer, entry->size, render.is_active(*entry) ? 0 : render.renderer.dim_factor());
+        jobs.push_back([&tile, &result = results[i], &timing = timings[i], pane = entry->pane, tracer] {
+            if (tracer) {
+                di::get<0>(timing) = dius::SteadyClock::now();
+            }
+            result = pane->draw(tile);
+            if (tracer) {
+                di::get<1>(timing) = dius::SteadyClock::now();
+            }
+        });
+    }
+    workers->run(jobs.span());
+
+    if (tracer) {
+        while (job_traces.size() < entries.size()) {
+            job_traces.push_back(&tracer->create_buffer(di::format("render draw job {}"_sv, job_traces.size())));
+        }
+        for (auto [i, entry] : di::enumerate(entries)) {
+            auto [start, end] = timings[i];
+            job_traces[i]->record(TraceEventType::PaneDraw, start, end, entry->pane->id());
+        }
+    }
+
+    for (auto [entry, result] : di::zip(entries, results)) {
+        render.renderer.compose_tile(tiles[entry->pane], entry->row + render.have_top_status_bar, entry->col);
+        auto [pane_cursor, bg] = result;
+        render.did_draw(*entry, pane_cursor, bg);
+    }
+}
+
 void RenderThread::render_status_bar(LayoutState const& state, Renderer& renderer, StatusBarConfig const& config) {
     auto const& colors = config.colors;
     auto const dark_bg = colors.background_color;
@@ -477,9 +644,16 @@ void RenderThread::render_status_bar(LayoutState const& state, Renderer& rendere
 }
 
 void RenderThread::do_render(Renderer& renderer) {
+    auto _ = TraceSpan(m_trace, TraceEventType::DoRender);
+    auto awaiting_frame = di::Vector<u64> {};
+    auto lock_start = dius::SteadyClock::now();
+    auto frame_start = lock_start;
     auto [cursor, window_title, bg_color] = m_layout_state.with_lock(
         [&](LayoutState& state)
             -> di::Tuple<di::Optional<RenderedCursor>, di::Optional<di::String>, di::Optional<terminal::Color>> {
+            frame_start = dius::SteadyClock::now();
+            m_stats.layout_lock_wait_ns.record(elapsed_ns(lock_start, frame_start));
+
             // Ignore if there is no layout.
             auto active_tab = state.active_tab();
             if (!active_tab) {
@@ -513,9 +687,40 @@ void RenderThread::do_render(Renderer& renderer) {
 
             // First render all panes in the layout tree.
             auto bg_color = di::Optional<terminal::Color> {};
-            auto render_fn =
-                Render(renderer, m_config.render, cursor, bg_color, tab, state, state.status_bar_position() == 0_u32);
+            // Panes which haven't been updated since the last frame are skipped, since their contents are still
+            // present in the renderer's desired screen. When a popup is visible, every pane is drawn as the
+            // popup overlaps an arbitrary portion of the panes below it.
+            auto deferred = di::Vector<LayoutEntry const*> {};
+            auto render_fn = Render(renderer, m_config.render, cursor, bg_color, tab, state,
+                                    state.status_bar_position() == 0_u32, state.active_popup().has_value());
+            if (!render_fn.force_draw) {
+                render_fn.deferred = &deferred;
+            }
+            render_fn.trace = m_trace;
+            render_fn.awaiting_frame = &awaiting_frame;
             render_fn(*tree);
+            draw_concurrently(render_fn, m_draw_workers.get(), m_tiles, deferred.span(), m_tracer,
+                              m_draw_job_traces);
+            render_fn.deferred = nullptr;
+
+            // Drop the tiles of panes which aren't in the active tab. Panes leave the layout in many ways (closing
+            // a tab, restoring a layout, switching tabs), so this is simpler than handling each of them. Tiles are
+            // recreated on demand.
+            if (!m_tiles.empty()) {
+                auto visible = di::TreeSet<Pane*> {};
+                tab.for_each_pane([&](Pane& pane) {
+                    visible.insert(&pane);
+                });
+                auto stale = di::Vector<Pane*> {};
+                for (auto const& [pane, _] : m_tiles) {
+                    if (!visible.contains(pane)) {
+                        stale.push_back(pane);
+                    }
+                }
+                for (auto* pane : stale) {
+                    m_tiles.erase(pane);
+                }
+            }
 
             // If there is a popup, render it.
             for (auto popup_layout : state.popup_layout()) {
@@ -545,6 +750,31 @@ void RenderThread::do_render(Renderer& renderer) {
             return { cursor, di::move(window_title), bg_color };
         });
 
-    (void) renderer.finish(dius::std_in, cursor.value_or({ .hidden = true }), di::move(window_title), bg_color);
+    auto write_start = dius::SteadyClock::now();
+    m_stats.frame_build_ns.record(elapsed_ns(frame_start, write_start));
+
+    {
+        auto _ = TraceSpan(m_trace, TraceEventType::RendererFinish);
+        (void) renderer.finish(m_outer_terminal, cursor.value_or({ .hidden = true }), di::move(window_title), bg_color);
+    }
+    auto write_end = dius::SteadyClock::now();
+    m_stats.frame_write_ns.record(elapsed_ns(write_start, write_end));
+    m_stats.frame_bytes.record(renderer.last_frame_bytes());
+
+    // Complete the latency measurement for panes which drew the response to a key press. The panes must be looked
+    // up again, as they may have been removed since the layout state lock was released.
+    if (!awaiting_frame.empty()) {
+        m_layout_state.with_lock([&](LayoutState& state) {
+            auto present = [&](Pane& pane) {
+                if (di::contains(awaiting_frame, pane.id())) {
+                    pane.did_present_frame(write_end);
+                }
+            };
+            state.for_each_pane(present);
+            for (auto& pane : state.active_popup()) {
+                present(pane);
+            }
+        });
+    }
 }
 }
@@ -2,7 +2,9 @@
 
 #include "config.h"
 #include "di/container/queue/queue.h"
+#include "di/container/tree/tree_map.h"
 #include "dius/condition_variable.h"
+#include "draw_workers.h"
 #include "input_mode.h"
 #include "layout_state.h"
 #include "tab.h"
@@ -11,8 +13,11 @@
 #include "ttx/features.h"
 #include "ttx/pane.h"
 #include "ttx/renderer.h"
+#include "ttx/stats.h"
 #include "ttx/terminal/escapes/osc_52.h"
 #include "ttx/terminal/palette.h"
+#include "ttx/timer.h"
+#include "ttx/trace.h"
 
 namespace ttx {
 struct PaneExited {
@@ -57,19 +62,42 @@ struct UpdateOuterTerminalPalette {
 
 struct QueryPalette {};
 
+/// @brief Use the outer terminal's features detected in the background.
+///
+/// Feature detection writes to the screen, so the terminal is set up again and fully redrawn.
+struct UpdateFeatures {
+    Feature features { Feature::None };
+};
+
 using RenderEvent =
     di::Variant<Size, PaneExited, RemovePopup, InputStatus, WriteString, StatusMessage, DoRender, MouseEvent,
-                ClipboardRequest, UpdateConfig, UpdateOuterTerminalPalette, QueryPalette, Exit>;
+                ClipboardRequest, UpdateConfig, UpdateOuterTerminalPalette, QueryPalette, UpdateFeatures, Exit>;
+
+/// @brief Statistics for the render thread
+struct RenderStats {
+    StatHistogram layout_lock_wait_ns; ///< Time spent waiting to acquire the layout state lock
+    StatHistogram frame_build_ns;      ///< Time spent drawing a frame into the renderer
+    StatHistogram frame_write_ns;      ///< Time spent in Renderer::finish(), including writing to the terminal
+    StatHistogram frame_bytes;         ///< Bytes written to the outer terminal per frame
+};
 
 class RenderThread {
 public:
-    explicit RenderThread(di::Synchronized<LayoutState>& layout_state, di::Function<void()> did_exit, Config config,
-                          Feature features, terminal::Palette const& outer_terminal_palette);
+    explicit RenderThread(di::Synchronized<LayoutState>& layout_state, dius::SyncFile& outer_terminal,
+                          di::Function<void()> did_exit, Config config, Feature features,
+                          terminal::Palette const& outer_terminal_palette, Tracer* tracer = nullptr,
+                          TimerThread* timers = nullptr);
     ~RenderThread();
 
-    static auto create(di::Synchronized<LayoutState>& layout_state, di::Function<void()> did_exit, Config config,
-                       Feature features, terminal::Palette const& outer_terminal_palette)
-        -> di::Result<di::Box<RenderThread>>;
+    /// @brief Create the render thread, which draws frames to \p outer_terminal
+    ///
+    /// The outer terminal is normally the process's controlling terminal, but can be any
+    /// file which is connected to a terminal, like a connection to a remote client. When \p timers is
+    /// provided, the render thread uses it to wake up when a status message or clipboard request expires.
+    static auto create(di::Synchronized<LayoutState>& layout_state, dius::SyncFile& outer_terminal,
+                       di::Function<void()> did_exit, Config config, Feature features,
+                       terminal::Palette const& outer_terminal_palette, Tracer* tracer = nullptr,
+                       TimerThread* timers = nullptr) -> di::Result<di::Box<RenderThread>>;
     static auto create_mock(di::Synchronized<LayoutState>& layout_state) -> RenderThread;
 
     void push_event(RenderEvent event);
@@ -80,10 +108,14 @@ public:
     }
     void set_config(Config config) { push_event(UpdateConfig(di::move(config))); }
 
+    auto stats() const -> RenderStats const& { return m_stats; }
+
 private:
     void render_thread();
     void do_render(Renderer& renderer);
     void render_status_bar(LayoutState const& state, Renderer& renderer, StatusBarConfig const& config);
+    void update_draw_workers();
+    void schedule_wake();
 
     struct PendingStatusMessage {
         di::String message;
@@ -101,11 +133,21 @@ private:
     di::Synchronized<di::Queue<RenderEvent>> m_events;
     dius::ConditionVariable m_condition;
     di::Synchronized<LayoutState>& m_layout_state;
+    dius::SyncFile& m_outer_terminal;
     di::Function<void()> m_did_exit;
     terminal::Palette m_outer_terminal_palette;
     Clipboard m_clipboard;
     Config m_config;
     Feature m_features { Feature::None };
+    di::Box<DrawWorkers> m_draw_workers;
+    di::TreeMap<Pane*, Renderer> m_tiles;
+    RenderStats m_stats;
+    Tracer* m_tracer { nullptr };
+    TraceBuffer* m_trace { nullptr };
+    di::Vector<TraceBuffer*> m_draw_job_traces;
+    TimerThread* m_timers { nullptr };
+    di::Optional<dius::SteadyClock::TimePoint> m_wake_deadline; ///< The deadline of the scheduled wake up timer
+    u64 m_wake_timer { 0 };
     dius::Thread m_thread;
 };
 }
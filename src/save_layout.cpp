@@ -1,6 +1,7 @@
 #include "save_layout.h"
 
 #include "config.h"
+#include "di/container/tree/tree_set.h"
 #include "dius/filesystem/operations.h"
 #include "layout_state.h"
 
@@ -32,18 +33,98 @@ void SaveLayoutThread::push_event(SaveLayoutEvent event) {
     });
 }
 
+static auto write_file_atomically(di::PathView path, di::Span<byte const> contents) -> di::Result<> {
+    auto temp_path = path.to_owned();
+    temp_path += ".tmp"_tsv;
+    {
+        auto file = TRY(dius::open_sync(temp_path, dius::OpenMode::WriteClobber));
+        TRY(file.write_exactly(contents));
+
+        // Make sure the contents reach the disk before the rename. Otherwise a crash could leave an empty file behind.
+        TRY(file.sync());
+    }
+
+    // Renaming replaces the file atomically, so readers see either the old or the new contents but never a mix.
+    return dius::filesystem::rename(temp_path, path);
+}
+
 auto SaveLayoutThread::save_layout(di::TransparentStringView layout_name) -> di::Result<> {
+    // Building the JSON model is cheap, so only that is done while holding the lock.
     auto state = m_layout_state.with_lock([&](LayoutState const& state) {
         return state.as_json();
     });
+
+    // Most periodic saves happen when nothing about the layout changed, in which case there's nothing to write.
+    if (auto it = m_saved_layouts.find(layout_name); it != m_saved_layouts.end() && di::get<1>(*it) == state) {
+        return {};
+    }
+
     auto json_string = TRY(di::to_json_string(state, di::JsonSerializerConfig().pretty().indent_width(4)));
 
-    // TODO: we probably should backup the layout file before writing, in case something goes wrong.
     auto save_path = m_save_dir.clone();
     save_path /= layout_name;
     save_path += ".json"_tsv;
-    auto file = TRY(dius::open_sync(save_path, dius::OpenMode::WriteClobber));
-    return file.write_exactly(di::as_bytes(json_string.span()));
+    TRY(write_file_atomically(save_path, di::as_bytes(json_string.span())));
+
+    m_saved_layouts.insert_or_assign(layout_name.to_owned(), di::move(state));
+    return {};
+}
+
+auto SaveLayoutThread::pane_contents_directory(di::PathView save_dir, di::TransparentStringView layout_name)
+    -> di::Path {
+    auto result = save_dir.to_owned();
+    result /= layout_name;
+    result += ".panes"_tsv;
+    return result;
+}
+
+auto SaveLayoutThread::save_pane_contents() -> di::Result<> {
+    auto directory = pane_contents_directory(m_save_dir, m_config.layout_name);
+    (void) dius::filesystem::create_directories(directory);
+
+    auto pane_ids = m_layout_state.with_lock([&](LayoutState& state) {
+        auto result = di::TreeSet<u64> {};
+        state.for_each_pane([&](Pane& pane) {
+            result.insert(pane.id());
+        });
+        return result;
+    });
+
+    // The first update of a pane serializes its entire scroll back, which can take a long time. So each pane is
+    // serialized while holding only its own terminal lock, and the layout lock is held just long enough to find
+    // the pane and lock its terminal.
+    for (auto pane_id : pane_ids) {
+        auto layout_lock = di::UniqueLock(m_layout_state.get_lock());
+        Pane* pane = nullptr;
+        // SAFETY: we acquired the lock manually above.
+        m_layout_state.get_assuming_no_concurrent_accesses().for_each_pane([&](Pane& candidate) {
+            if (candidate.id() == pane_id) {
+                pane = &candidate;
+            }
+        });
+        if (!pane || pane->restoring_contents()) {
+            continue;
+        }
+
+        auto update = pane->update_snapshot(m_pane_snapshots[pane_id], [&] {
+            layout_lock.unlock();
+        });
+        if (update && !PaneSnapshot::write(directory, pane_id, update.value())) {
+            // Start over on the next save, as the files may now be missing some content.
+            m_pane_snapshots[pane_id].reset();
+        }
+    }
+
+    // Discard the snapshots of any panes which were closed.
+    auto closed_pane_ids = m_pane_snapshots | di::keys | di::filter([&](u64 pane_id) {
+                               return !pane_ids.contains(pane_id);
+                           }) |
+                           di::to<di::Vector>();
+    for (auto pane_id : closed_pane_ids) {
+        PaneSnapshot::clear(directory, pane_id);
+        m_pane_snapshots.erase(pane_id);
+    }
+    return {};
 }
 
 void SaveLayoutThread::save_layout_thread() {
@@ -77,12 +158,13 @@ void SaveLayoutThread::save_layout_thread() {
             return result;
         }();
 
-        // Process any pending events.
+        // Process any pending events. Requests to save the same layout multiple times are only handled once.
+        auto requested_layouts = di::TreeSet<di::TransparentString> {};
         for (auto& event : events) {
             // Pattern matching would be nice here...
             if (auto ev = di::get_if<SaveLayout>(event)) {
                 if (ev->layout_name) {
-                    (void) save_layout(ev->layout_name.value());
+                    requested_layouts.insert(di::move(ev->layout_name.value()));
                 }
                 continue;
             }
@@ -96,8 +178,15 @@ void SaveLayoutThread::save_layout_thread() {
             }
         }
 
+        for (auto const& layout_name : requested_layouts) {
+            (void) save_layout(layout_name);
+        }
+
         if (m_config.save_layout) {
             (void) save_layout(m_config.layout_name);
+            if (m_config.save_pane_contents) {
+                (void) save_pane_contents();
+            }
         }
     }
 }
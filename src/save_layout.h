@@ -2,8 +2,10 @@
 
 #include "config.h"
 #include "di/container/queue/queue.h"
+#include "di/container/tree/tree_map.h"
 #include "dius/condition_variable.h"
 #include "layout_state.h"
+#include "ttx/pane_snapshot.h"
 
 namespace ttx {
 struct SaveLayout {
@@ -34,15 +36,21 @@ public:
     void set_config(SessionConfig config) { push_event(SaveLayoutUpdateConfig { di::move(config) }); }
     void request_exit() { push_event(SaveLayoutExit {}); }
 
+    /// @brief Get the directory which holds the pane snapshots saved alongside a layout.
+    static auto pane_contents_directory(di::PathView save_dir, di::TransparentStringView layout_name) -> di::Path;
+
 private:
     void save_layout_thread();
     auto save_layout(di::TransparentStringView layout_name) -> di::Result<>;
+    auto save_pane_contents() -> di::Result<>;
 
     di::Synchronized<di::Queue<SaveLayoutEvent>> m_events;
     dius::ConditionVariable m_condition;
     di::Synchronized<LayoutState>& m_layout_state;
     di::Path m_save_dir;
     SessionConfig m_config;
+    di::TreeMap<di::TransparentString, json::Layout> m_saved_layouts; ///< The last layout written to each file.
+    di::TreeMap<u64, PaneSnapshot> m_pane_snapshots;
     dius::Thread m_thread;
 };
 }
@@ -17,6 +17,11 @@ namespace ttx {
 void Tab::layout(Size const& size) {
     m_size = size;
 
+    // Placeholders are laid out once their panes are created.
+    if (m_pending_restore) {
+        return;
+    }
+
     if (m_full_screen_pane) {
         // In full screen mode, circumvent ordinary layout.
         m_full_screen_pane->resize(m_size);
@@ -311,6 +316,11 @@ auto Tab::set_is_active(bool b) -> bool {
         return false;
     }
 
+    // Create the panes the first time the tab becomes active. The caller lays out the tab afterwards.
+    if (b) {
+        (void) restore_panes();
+    }
+
     // Send focus in/out events appropriately.
     if (m_active) {
         m_active->event(FocusEvent::focus_out());
@@ -348,6 +358,12 @@ void Tab::for_each_pane(di::FunctionRef<void(Pane&)> action) {
     }
 }
 
+void Tab::for_each_placeholder_args(di::FunctionRef<void(CreatePaneArgs&)> action) {
+    for (auto& pending : m_pending_restore) {
+        action(pending.args);
+    }
+}
+
 auto Tab::as_json_v1() const -> json::v1::Tab {
     auto json = json::v1::Tab {};
     json.name = m_name.clone();
@@ -374,54 +390,84 @@ auto Tab::from_json_v1(json::v1::Tab const& json, Session* session, Size size, C
 
     auto result = di::make_box<Tab>(session, json.id, json.name.clone());
     result->m_size = size;
+    result->m_layout_root = TRY(LayoutGroup::placeholder_from_json_v1(json.pane_layout));
+    result->m_pending_restore = PendingRestore {
+        .args = di::move(args),
+        .active_pane_id = json.active_pane_id,
+        .full_screen_pane_id = json.full_screen_pane_id,
+        .render_thread = &render_thread,
+        .input_thread = &input_thread,
+    };
+    return result;
+}
+
+auto Tab::restore_panes() -> di::Result<> {
+    if (!m_pending_restore) {
+        return {};
+    }
 
+    auto& pending = m_pending_restore.value();
     auto panes = di::Vector<Pane*> {};
-    result->m_layout_root = TRY(LayoutGroup::from_json_v1(
-        json.pane_layout, size,
-        [&](u64 pane_id, di::Optional<di::Path> cwd, Size const& pane_size) -> di::Result<di::Box<Pane>> {
-            auto cloned_args = args.clone();
+    auto failed = 0_usize;
+    auto result = m_layout_root.make_panes(
+        m_size, [&](u64 pane_id, di::Optional<di::Path> cwd, Size const& pane_size) -> di::Result<di::Box<Pane>> {
+            auto cloned_args = pending.args.clone();
             cloned_args.cwd = di::move(cwd);
-            auto pane = result->make_pane(pane_id, di::move(cloned_args), pane_size, render_thread, input_thread);
+            auto pane = make_pane(pane_id, di::move(cloned_args), pane_size, *pending.render_thread,
+                                  *pending.input_thread);
             if (pane) {
                 panes.push_back(pane.value().get());
+            } else {
+                failed++;
             }
             return pane;
-        }));
+        });
+
+    // When no panes could be created, keep the placeholders so that this is retried the next time the tab is
+    // activated. Otherwise, remove the placeholders whose panes failed to be created one at a time, so that
+    // their space is given to the remaining panes.
+    if (!result && panes.empty()) {
+        return result;
+    }
+    for (auto _ : di::range(failed)) {
+        m_layout_root.remove_placeholder();
+    }
+
+    auto restore = di::move(m_pending_restore).value();
+    m_pending_restore = {};
 
     // If there are any panes missing from the list, add them to the end.
-    auto counted_panes = result->m_panes_ordered_by_recency | di::to<di::TreeSet>();
+    auto counted_panes = m_panes_ordered_by_recency | di::to<di::TreeSet>();
     for (auto* pane : panes) {
         if (!counted_panes.contains(pane)) {
-            result->m_panes_ordered_by_recency.push_back(pane);
+            m_panes_ordered_by_recency.push_back(pane);
         }
     }
 
     // Full screen pane should always be active.
-    if (json.full_screen_pane_id) {
-        auto* it = di::find(panes, json.full_screen_pane_id.value(), &Pane::id);
+    if (restore.full_screen_pane_id) {
+        auto* it = di::find(panes, restore.full_screen_pane_id.value(), &Pane::id);
         if (it != panes.end()) {
-            result->set_full_screen_pane(*it);
+            set_full_screen_pane(*it);
         }
-    } else if (json.active_pane_id) {
-        auto* it = di::find(panes, json.active_pane_id.value(), &Pane::id);
+    } else if (restore.active_pane_id) {
+        auto* it = di::find(panes, restore.active_pane_id.value(), &Pane::id);
         if (it != panes.end()) {
-            result->set_active(*it);
+            set_active(*it);
         }
     }
 
-    if (result->m_panes_ordered_by_recency.empty()) {
-        return result;
-    }
-
     // Fallback case: set the first pane as active.
-    if (!result->m_active) {
-        result->set_active(result->m_panes_ordered_by_recency[0]);
+    if (!m_active && !m_panes_ordered_by_recency.empty()) {
+        set_active(m_panes_ordered_by_recency[0]);
     }
-
     return result;
 }
 
 auto Tab::max_pane_id() const -> u64 {
+    if (m_pending_restore) {
+        return di::max(m_layout_root.max_pane_id(), 1_u64);
+    }
     if (m_panes_ordered_by_recency.empty()) {
         return 1;
     }
@@ -20,6 +20,8 @@ public:
     explicit Tab(Session* session, u64 id, di::Optional<di::String> name = {})
         : m_session(session), m_id(id), m_name(di::move(name)) {}
 
+    // Restoring a tab doesn't create its panes: they are placeholders until the tab first becomes active. This
+    // means restoring a large layout only needs to spawn the processes of the active tab.
     static auto from_json_v1(json::v1::Tab const& json, Session* session, Size size, CreatePaneArgs args,
                              RenderThread& render_thread, InputThread& input_thread) -> di::Result<di::Box<Tab>>;
 
@@ -71,6 +73,9 @@ public:
     auto set_is_active(bool b) -> bool;
     auto is_active() const -> bool { return m_is_active; }
 
+    // Returns true if the tab's panes are still placeholders.
+    auto is_placeholder() const -> bool { return m_pending_restore.has_value(); }
+
     auto full_screen_pane() const -> di::Optional<Pane&> {
         if (!m_full_screen_pane) {
             return {};
@@ -80,6 +85,7 @@ public:
     auto set_full_screen_pane(Pane* pane) -> bool;
 
     void for_each_pane(di::FunctionRef<void(Pane&)> action);
+    void for_each_placeholder_args(di::FunctionRef<void(CreatePaneArgs&)> action);
 
     void layout_did_update();
     auto as_json_v1() const -> json::v1::Tab;
@@ -87,6 +93,16 @@ public:
     auto layout_state() const -> LayoutState&;
 
 private:
+    struct PendingRestore {
+        CreatePaneArgs args;
+        di::Optional<u64> active_pane_id;
+        di::Optional<u64> full_screen_pane_id;
+        RenderThread* render_thread { nullptr };
+        InputThread* input_thread { nullptr };
+    };
+
+    auto restore_panes() -> di::Result<>;
+
     auto make_pane(u64 pane_id, CreatePaneArgs args, Size const& size, RenderThread& render_thread,
                    InputThread& input_thread) -> di::Result<di::Box<Pane>>;
 
@@ -100,5 +116,6 @@ private:
     bool m_is_active { false };
     Pane* m_active { nullptr };
     Pane* m_full_screen_pane { nullptr };
+    di::Optional<PendingRestore> m_pending_restore;
 };
 }
@@ -15,8 +15,11 @@
 #include "render.h"
 #include "save_layout.h"
 #include "ttx/features.h"
+#include "ttx/replay.h"
 #include "ttx/terminal/capability.h"
 #include "ttx/terminal/escapes/osc_21.h"
+#include "ttx/timer.h"
+#include "ttx/trace.h"
 
 namespace ttx {
 struct NewBase {
@@ -25,6 +28,7 @@ struct NewBase {
     bool headless { false };
     di::Optional<di::PathView> save_state_path;
     di::Optional<di::PathView> capture_command_output_path;
+    di::Optional<di::PathView> trace_path;
 
     // New
     bool disable_layout_restore { false };
@@ -39,6 +43,8 @@ struct NewBase {
 
     // Replay
     di::Vector<di::PathView> replay_paths;
+    ReplayMode playback { ReplayMode::Instant };
+    u32 start_at { 0 };
 };
 
 struct New : NewBase {
@@ -62,6 +68,8 @@ struct New : NewBase {
                                                            "Capture command output to a file"_sv)
             .option<&NewBase::save_state_path>('S', "save-state-path"_tsv,
                                                "Save state path when triggering saving a pane's state"_sv)
+            .option<&NewBase::trace_path>({}, "trace-path"_tsv,
+                                          "Record render and input thread activity to a Chrome trace file"_sv)
             .option<&NewBase::headless>('h', "headless"_tsv, "Headless mode"_sv)
             .option<&NewBase::term>('t', "term"_tsv, "Override config TERM environment variable"_sv)
             .option<&NewBase::clipboard_mode>({}, "clipboard"_tsv, "Set the clipboard mode"_sv, false, "MODE"_sv)
@@ -84,7 +92,13 @@ struct Replay : NewBase {
                                                            "Capture command output to a file"_sv)
             .option<&NewBase::save_state_path>('S', "save-state-path"_tsv,
                                                "Save state path when triggering saving a pane's state"_sv)
+            .option<&NewBase::trace_path>({}, "trace-path"_tsv,
+                                          "Record render and input thread activity to a Chrome trace file"_sv)
             .option<&NewBase::headless>('h', "headless"_tsv, "Headless mode"_sv)
+            .option<&NewBase::playback>({}, "playback"_tsv, "How to play back the replay files"_sv, false, "MODE"_sv)
+            .option<&NewBase::start_at>({}, "start-at"_tsv,
+                                        "Start from the last keyframe before this many seconds into the replay"_sv,
+                                        false, "SECONDS"_sv)
             .argument<&NewBase::replay_paths>("REPLAY_FILES"_sv, "Files to replay (each file gets its own pane)"_sv,
                                               true)
             .help();
@@ -304,7 +318,7 @@ static auto get_session_save_dir() -> di::Result<di::Path> {
     return di::move(result);
 }
 
-static auto get_local_terminfo_dir() -> di::Result<di::Path> {
+static auto get_local_state_dir() -> di::Result<di::Path> {
     auto const& env = dius::system::get_environment();
     auto data_home = env.at("XDG_STATE_HOME"_tsv)
                          .transform([&](di::TransparentStringView path) {
@@ -321,10 +335,25 @@ static auto get_local_terminfo_dir() -> di::Result<di::Path> {
 
     auto& result = data_home.value();
     result /= "ttx"_tsv;
-    result /= "terminfo"_tsv;
     return di::move(result);
 }
 
+static auto get_local_terminfo_dir() -> di::Result<di::Path> {
+    return TRY(get_local_state_dir()) / "terminfo"_tsv;
+}
+
+static auto get_feature_cache_path() -> di::Result<di::Path> {
+    auto directory = TRY(get_local_state_dir()) / "features"_tsv;
+    TRY(dius::filesystem::create_directories(directory));
+    return feature_cache_path(directory);
+}
+
+static auto get_config_cache_directory() -> di::Result<di::Path> {
+    auto directory = TRY(get_local_state_dir()) / "config"_tsv;
+    TRY(dius::filesystem::create_directories(directory));
+    return directory;
+}
+
 static auto to_json_string_without_empty_objects(config_json::v1::Config const& config) -> di::String {
     auto initial_string = *di::to_json_string(config);
     auto json = *di::from_json_string<di::json::Object>(initial_string.view());
@@ -332,6 +361,56 @@ static auto to_json_string_without_empty_objects(config_json::v1::Config const&
     return *di::to_json_string(json, di::JsonSerializerConfig().pretty().indent_width(4));
 }
 
+// Entries are stored in a subdirectory named after the first character of the name. On case insensitive
+// file systems (like on MacOS), ncurses instead uses the character's hex value.
+static auto terminfo_entry_directories(di::PathView directory, di::TransparentStringView name)
+    -> di::Array<di::Path, 2> {
+    auto letter = ""_ts;
+    letter.push_back(name.span()[0]);
+    auto hex = di::to_transparent_string(di::format("{:02x}"_sv, u8(name.span()[0])));
+    return {
+        directory.to_owned() / letter,
+        directory.to_owned() / hex,
+    };
+}
+
+// Check for a compiled terminfo entry named \p name, in the same locations ncurses searches.
+static auto has_terminfo_entry(di::TransparentStringView name) -> bool {
+    auto const& env = dius::system::get_environment();
+    auto directories = di::Vector<di::Path> {};
+    for (auto terminfo : env.at("TERMINFO"_tsv).filter(di::not_fn(di::empty))) {
+        directories.push_back(di::PathView(terminfo).to_owned());
+    }
+    for (auto home : env.at("HOME"_tsv)) {
+        directories.push_back(di::PathView(home).to_owned() / ".terminfo"_tsv);
+    }
+
+    // An empty entry in $TERMINFO_DIRS means the system directories. These vary by distribution, so we check
+    // all of the common locations.
+    auto const system_directories = di::Array {
+        "/etc/terminfo"_tsv,     "/lib/terminfo"_tsv,      "/usr/share/terminfo"_tsv,
+        "/usr/lib/terminfo"_tsv, "/usr/share/misc/terminfo"_tsv,
+    };
+    for (auto directory : env.at("TERMINFO_DIRS"_tsv).value_or(""_tsv) | di::split(':')) {
+        if (di::empty(directory)) {
+            for (auto system_directory : system_directories) {
+                directories.push_back(di::PathView(system_directory).to_owned());
+            }
+        } else {
+            directories.push_back(di::PathView(directory).to_owned());
+        }
+    }
+
+    for (auto const& directory : directories) {
+        for (auto const& entry_directory : terminfo_entry_directories(directory, name)) {
+            if (dius::open_sync(entry_directory.clone() / name, dius::OpenMode::Readonly)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 static auto maybe_get_terminfo_dir(di::TransparentStringView term, bool force_local_terminfo)
     -> di::Result<di::Optional<di::Path>> {
     // If the user is overriding TERM, don't setup our terminfo.
@@ -339,25 +418,10 @@ static auto maybe_get_terminfo_dir(di::TransparentStringView term, bool force_lo
         return {};
     }
 
-    if (!force_local_terminfo) {
-        // First, start by searching for an existing terminfo for ttx. We could try and implement
-        // this check ourselves, but its probably better to rely on the actual curses implementation.
-        // This does slow down start-up time, but we can rework this logic later on. For now, this
-        // is very convenient.
-        auto null = TRY(dius::open_sync("/dev/null"_pv, dius::OpenMode::ReadWrite));
-        auto process_result = TRY(dius::system::Process(di::Array {
-                                                            "tput"_ts,
-                                                            "-T"_ts,
-                                                            "xterm-ttx"_ts,
-                                                            "colors"_ts,
-                                                        } |
-                                                        di::to<di::Vector>())
-                                      .with_file_dup(null.file_descriptor(), 1)
-                                      .with_file_dup(null.file_descriptor(), 2)
-                                      .spawn_and_wait());
-        if (process_result.exited() && process_result.exit_code() == 0) {
-            return {};
-        }
+    // First, start by searching for an existing terminfo for ttx. This is done without spawning any
+    // processes, since that noticeably slows down start-up.
+    if (!force_local_terminfo && has_terminfo_entry(term)) {
+        return {};
     }
 
     // In this case, we're going to compile our terminfo ourselves and then return the
@@ -365,8 +429,8 @@ static auto maybe_get_terminfo_dir(di::TransparentStringView term, bool force_lo
     auto terminfo_dir = TRY(get_local_terminfo_dir());
     TRY(dius::filesystem::create_directories(terminfo_dir));
 
-    // To avoid redundant recompilations, hash our serialized terminfo and see if we're already written
-    // it out.
+    // To avoid redundant writes, hash our serialized terminfo and see if we're already written
+    // it out. The hash file is written last, so that an interrupted write is retried.
     auto const& terminfo = terminal::get_ttx_terminfo();
     auto serialized_terminfo = terminfo.serialize();
     auto terminfo_hash = di::hash(serialized_terminfo);
@@ -376,25 +440,24 @@ static auto maybe_get_terminfo_dir(di::TransparentStringView term, bool force_lo
         }
     }
 
+    // Write the terminfo in the compiled format, for each of its names. The last name is a description
+    // and so doesn't get an entry.
+    auto compiled_terminfo = terminfo.compile();
+    for (auto [i, name] : di::enumerate(terminfo.names)) {
+        if (i > 0 && i + 1 == terminfo.names.size()) {
+            continue;
+        }
+        for (auto const& entry_directory : terminfo_entry_directories(terminfo_dir, name)) {
+            TRY(dius::filesystem::create_directories(entry_directory));
+            auto file = TRY(dius::open_sync(entry_directory.clone() / name, dius::OpenMode::WriteClobber));
+            TRY(file.write_exactly(compiled_terminfo.span()));
+        }
+    }
+
+    // Also write the source, which is useful for debugging.
     auto terminfo_file = TRY(dius::open_sync(terminfo_dir.clone() / "ttx.terminfo"_pv, dius::OpenMode::WriteClobber));
     di::writer_print<di::String::Encoding>(terminfo_file, "{}"_sv, serialized_terminfo);
 
-    auto null = TRY(dius::open_sync("/dev/null"_pv, dius::OpenMode::ReadWrite));
-    auto process_result = TRY(dius::system::Process(di::Array {
-                                                        "tic"_ts,
-                                                        "-x"_ts,
-                                                        "-o"_ts,
-                                                        terminfo_dir.data().to_owned(),
-                                                        (terminfo_dir.clone() / "ttx.terminfo"_pv).data().to_owned(),
-                                                    } |
-                                                    di::to<di::Vector>())
-                                  .with_file_dup(null.file_descriptor(), 1)
-                                  .with_file_dup(null.file_descriptor(), 2)
-                                  .spawn_and_wait());
-    if (!process_result.exited() || process_result.exit_code() != 0) {
-        return di::Unexpected(di::BasicError::InvalidArgument);
-    }
-
     auto terminfo_hash_file =
         TRY(dius::open_sync(terminfo_dir.clone() / "ttx.terminfo.hash"_pv, dius::OpenMode::WriteClobber));
     di::writer_print<di::String::Encoding>(terminfo_hash_file, "{}"_sv, di::to_string(terminfo_hash));
@@ -412,8 +475,24 @@ static auto do_new(Args&, NewBase& args) -> di::Result<> {
         return di::Unexpected(di::format_error("--profile cannot be a directory"_sv));
     }
     auto features = FeatureResult { .features = Feature::All };
+    auto feature_cache_path = di::Optional<di::Path> {};
     if (!args.headless) {
-        features = TRY(detect_features(dius::std_in));
+        // When the outer terminal's features are cached, start immediately and revalidate them in the
+        // background. The input thread takes care of this when given the cache path.
+        auto cache_path = get_feature_cache_path().optional_value();
+        auto cached = cache_path.and_then([](di::Path const& path) {
+            return load_cached_features(path);
+        });
+        if (cached) {
+            features = di::move(cached).value();
+            feature_cache_path = di::move(cache_path);
+        } else {
+            auto replies = di::Vector<byte> {};
+            features = TRY(detect_features(dius::std_in, &replies));
+            if (cache_path) {
+                (void) store_cached_features(cache_path.value(), replies.span());
+            }
+        }
     }
     auto config_from_args = config_json::v1::Config {
         .theme = {
@@ -442,11 +521,17 @@ static auto do_new(Args&, NewBase& args) -> di::Result<> {
             .force_local_terminfo = args.force_local_terminfo ? di::Optional(true) : di::nullopt,
         },
     };
-    auto config = TRY(config_json::v1::resolve_profile(args.profile, features.theme_mode, features.palette,
+    auto config_cache_directory = get_config_cache_directory().optional_value();
+    auto config = TRY(
+        (config_cache_directory
+             ? config_json::v1::resolve_profile_cached(config_cache_directory.value(), args.profile,
+                                                       features.theme_mode, features.palette,
                                                        di::clone(config_from_args))
-                          .transform_error([&](auto&& error) {
-                              return di::format_error("Failed to resolve profile '{}': {}"_sv, args.profile, error);
-                          }));
+             : config_json::v1::resolve_profile(args.profile, features.theme_mode, features.palette,
+                                                di::clone(config_from_args)))
+            .transform_error([&](auto&& error) {
+                return di::format_error("Failed to resolve profile '{}': {}"_sv, args.profile, error);
+            }));
 
     // Setup - log to file.
     [[maybe_unused]] auto& log = dius::std_err = TRY(dius::open_sync("/tmp/ttx.log"_pv, dius::OpenMode::WriteClobber));
@@ -463,6 +548,17 @@ static auto do_new(Args&, NewBase& args) -> di::Result<> {
             global_palette.set(index, features.palette.get(index));
         }
     }
+
+    // Setup - event tracing. The trace is written on exit, after all other threads have stopped.
+    auto tracer = args.trace_path.transform([](di::PathView path) {
+        return di::make_box<Tracer>(path.to_owned());
+    });
+    auto _ = di::ScopeExit([&] {
+        if (tracer) {
+            (void) tracer.value()->write();
+        }
+    });
+
     auto base_create_pane_args = CreatePaneArgs {
         .command = config.shell.command.clone(),
         .capture_command_output_path = args.capture_command_output_path.transform(di::to_owned),
@@ -471,9 +567,16 @@ static auto do_new(Args&, NewBase& args) -> di::Result<> {
         .term = config.terminfo.term.clone(),
         .global_palette = global_palette,
         .theme_mode = features.theme_mode,
+        .max_bytes_per_frame = config.render.max_pane_bytes_per_frame,
+        .max_clipboard_bytes = config.clipboard.max_bytes,
+        .tracer = tracer ? tracer.value().get() : nullptr,
     };
     if (replay_mode) {
         base_create_pane_args.replay_path = di::PathView(args.replay_paths[0]).to_owned();
+
+        // In headless mode ttx exits immediately, so the replay must be finished when the panes are created.
+        base_create_pane_args.replay_mode = args.headless ? ReplayMode::Instant : args.playback;
+        base_create_pane_args.replay_start = di::Seconds(args.start_at);
         if (!args.save_state_path) {
             base_create_pane_args.save_state_path = {};
         }
@@ -523,9 +626,14 @@ static auto do_new(Args&, NewBase& args) -> di::Result<> {
         });
     }
 
+    // Setup - timer thread. This is stopped explicitly once the threads which use it have been created, so that no
+    // timer callbacks run while they are being destroyed.
+    auto timer_thread = TRY(TimerThread::create());
+
     // Setup - render thread.
     auto render_thread =
-        TRY(RenderThread::create(layout_state, set_done, di::clone(config), features.features, features.palette));
+        TRY(RenderThread::create(layout_state, dius::std_in, set_done, di::clone(config), features.features,
+                                 features.palette, base_create_pane_args.tracer, timer_thread.get()));
     auto _ = di::ScopeExit([&] {
         render_thread->request_exit();
     });
@@ -536,13 +644,18 @@ static auto do_new(Args&, NewBase& args) -> di::Result<> {
             return InputThread::create_mock(layout_state, *render_thread, *layout_save_thread);
         }
         return InputThread::create(base_create_pane_args.clone(), di::clone(config), di::clone(config_from_args),
-                                   args.profile, layout_state, features, *render_thread, *layout_save_thread);
+                                   args.profile, layout_state, dius::std_in, features, di::move(feature_cache_path),
+                                   di::move(config_cache_directory), *render_thread, *layout_save_thread,
+                                   timer_thread.get());
     }());
     auto _ = di::ScopeExit([&] {
         if (input_thread) {
             input_thread->request_exit();
         }
     });
+    auto _ = di::ScopeExit([&] {
+        timer_thread->stop();
+    });
 
     // Setup - remove all panes and tabs on exit.
     auto _ = di::ScopeExit([&] {
@@ -611,7 +724,12 @@ static auto do_new(Args&, NewBase& args) -> di::Result<> {
                 if (file) {
                     auto string = TRY(di::read_to_string(file.value()));
                     auto json = TRY(di::from_json_string<json::Layout>(string));
-                    TRY(state.restore_json(json, make_pane_args(), *render_thread, *input_thread));
+                    auto restore_args = make_pane_args();
+                    if (config.session.save_pane_contents) {
+                        restore_args.restore_contents_directory =
+                            SaveLayoutThread::pane_contents_directory(session_save_dir, config.session.layout_name);
+                    }
+                    TRY(state.restore_json(json, di::move(restore_args), *render_thread, *input_thread));
                 } else if (file.error() != dius::PosixError::NoSuchFileOrDirectory) {
                     return di::Unexpected(di::move(file).error());
                 }
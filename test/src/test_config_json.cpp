@@ -1,6 +1,9 @@
 #include "config_json.h"
 #include "di/container/string/string.h"
 #include "di/test/prelude.h"
+#include "di/util/scope_exit.h"
+#include "dius/filesystem/directory_iterator.h"
+#include "dius/filesystem/operations.h"
 #include "dius/system/process.h"
 #include "ttx/terminal/color.h"
 #include "ttx/terminal/palette.h"
@@ -74,5 +77,77 @@ static void resolution() {
         di::reflect(config.value()));
 }
 
+static auto count_cache_entries(di::PathView cache_directory) -> usize {
+    auto iterator = dius::filesystem::DirectoryIterator::create(
+        cache_directory.to_owned(), dius::filesystem::DirectoryOptions::FollowDirectorySymlink);
+    ASSERT(iterator);
+    auto result = 0_usize;
+    for (auto&& entry : iterator.value()) {
+        ASSERT(entry);
+        result++;
+    }
+    return result;
+}
+
+static void write_profile(di::PathView path, di::StringView shell) {
+    auto file = dius::open_sync(path, dius::OpenMode::WriteClobber);
+    ASSERT(file);
+    auto contents = di::format(
+        R"~({{ "version": 1, "theme": {{ "name": "ansi" }}, "shell": {{ "command": ["{}"] }} }})~"_sv, shell);
+    ASSERT(file.value().write_exactly(di::as_bytes(contents.span())));
+}
+
+static void cached_resolution() {
+    auto& env = const_cast<di::TreeMap<di::TransparentString, di::TransparentString>&>(dius::system::get_environment());
+    env["XDG_CONFIG_HOME"_ts] = CONFIG_FILES ""_ts;
+
+    auto test_directory = "/tmp/ttx-test-config-cache"_p;
+    auto cache_directory = test_directory.clone() / "cache"_tsv;
+    (void) dius::filesystem::remove_all(test_directory);
+    ASSERT(dius::filesystem::create_directories(cache_directory));
+    auto _ = di::ScopeExit([&] {
+        (void) dius::filesystem::remove_all(test_directory);
+    });
+
+    auto expected = ttx::config_json::v1::resolve_profile("test-config"_tsv, {}, {});
+    ASSERT(expected);
+
+    // The first resolution populates the cache, and the second should then be served from it. Both must
+    // match resolving the profile without the cache.
+    for (auto _ : di::range(2)) {
+        auto config = ttx::config_json::v1::resolve_profile_cached(cache_directory, "test-config"_tsv, {}, {});
+        ASSERT(config);
+        ASSERT_EQ(count_cache_entries(cache_directory), 1_usize);
+        di::tuple_for_each(
+            [&](auto field) {
+                ASSERT_EQ(field.get(config.value()), field.get(expected.value()));
+            },
+            di::reflect(config.value()));
+    }
+
+    // Changing a source of the cached profile must invalidate the entry, which is replaced rather than added to.
+    auto config_home = test_directory.clone() / "config"_tsv;
+    ASSERT(dius::filesystem::create_directories(config_home.clone() / "ttx"_tsv));
+    env["XDG_CONFIG_HOME"_ts] = config_home.data().to_owned();
+
+    auto profile_path = config_home.clone() / "ttx/cached.json"_tsv;
+    auto shell_command = [&] {
+        auto config = ttx::config_json::v1::resolve_profile_cached(cache_directory, "cached"_tsv, {}, {});
+        ASSERT(config);
+        ASSERT_EQ(config.value().shell.command.size(), 1_usize);
+        return config.value().shell.command[0].clone();
+    };
+
+    write_profile(profile_path, "zsh"_sv);
+    ASSERT_EQ(shell_command(), "zsh"_ts);
+    ASSERT_EQ(shell_command(), "zsh"_ts);
+    ASSERT_EQ(count_cache_entries(cache_directory), 2_usize);
+
+    write_profile(profile_path, "bash"_sv);
+    ASSERT_EQ(shell_command(), "bash"_ts);
+    ASSERT_EQ(count_cache_entries(cache_directory), 2_usize);
+}
+
 TEST(config_json, resolution)
+TEST(config_json, cached_resolution)
 }
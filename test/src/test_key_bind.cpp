@@ -0,0 +1,74 @@
+#include "di/test/prelude.h"
+#include "key_bind.h"
+
+namespace key_bind {
+using namespace ttx;
+
+// The original dispatch: scan all binds in order, and take the first one which matches.
+static auto linear_lookup(di::Span<KeyBind const> binds, InputMode mode, KeyEvent const& event) -> KeyBind const* {
+    if (mode != InputMode::Insert && (event.type() == KeyEventType::Release ||
+                                      (event.key() > Key::ModifiersBegin && event.key() < Key::ModifiersEnd))) {
+        return nullptr;
+    }
+
+    auto modifiers = event.modifiers() & ~(Modifiers::LockModifiers);
+    for (auto const& bind : binds) {
+        auto key_matches = bind.key == Key::None || (event.type() != KeyEventType::Release && event.key() == bind.key &&
+                                                     modifiers == bind.modifiers);
+        if (mode == bind.mode && key_matches) {
+            return &bind;
+        }
+    }
+    return nullptr;
+}
+
+static void validate_matches_linear_lookup(KeyBindTable const& table) {
+    auto modes = di::Array { InputMode::Insert, InputMode::Normal, InputMode::Switch, InputMode::Resize };
+    auto modifiers = di::Array { Modifiers::None, Modifiers::Control, Modifiers::Shift,
+                                 Modifiers::Control | Modifiers::NumLock, Modifiers::Alt | Modifiers::Shift };
+    auto types = di::Array { KeyEventType::Press, KeyEventType::Repeat, KeyEventType::Release };
+    for (auto mode : modes) {
+        for (auto key_number : di::range(u32(Key::KeyMax))) {
+            for (auto modifier : modifiers) {
+                for (auto type : types) {
+                    auto event = KeyEvent(type, Key(key_number), {}, modifier);
+                    ASSERT_EQ(table.lookup(mode, event), linear_lookup(table.binds(), mode, event));
+                }
+            }
+        }
+    }
+}
+
+static void default_binds() {
+    validate_matches_linear_lookup(KeyBindTable(make_key_binds(InputConfig {}, false)));
+    validate_matches_linear_lookup(KeyBindTable(make_key_binds(InputConfig { .prefix = Key::A }, false)));
+    validate_matches_linear_lookup(KeyBindTable(make_key_binds(InputConfig {}, true)));
+}
+
+static void priority() {
+    auto binds = di::Vector<KeyBind> {};
+    binds.push_back({ .key = Key::A, .mode = InputMode::Normal, .next_mode = InputMode::Normal });
+    binds.push_back({ .key = Key::A, .mode = InputMode::Normal, .next_mode = InputMode::Switch });
+    binds.push_back({ .mode = InputMode::Normal, .next_mode = InputMode::Resize });
+    binds.push_back({ .key = Key::B, .mode = InputMode::Normal, .next_mode = InputMode::Switch });
+    auto table = KeyBindTable(di::move(binds));
+
+    // The first exact bind wins over a later one.
+    auto const* bind = table.lookup(InputMode::Normal, KeyEvent::key_down(Key::A));
+    ASSERT(bind);
+    ASSERT_EQ(bind->next_mode, InputMode::Normal);
+
+    // A default bind shadows any exact binds after it.
+    bind = table.lookup(InputMode::Normal, KeyEvent::key_down(Key::B));
+    ASSERT(bind);
+    ASSERT_EQ(bind->next_mode, InputMode::Resize);
+
+    // Nothing matches in other modes.
+    ASSERT(!table.lookup(InputMode::Insert, KeyEvent::key_down(Key::A)));
+
+    validate_matches_linear_lookup(table);
+}
+
+TEST(key_bind, default_binds)
+TEST(key_bind, priority)
+}